@@ -0,0 +1,44 @@
+#include "MinecraftAI.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+#ifdef MINECRAFTAI_COUNT_ALLOCATIONS
+// Replaces the allocation functions of the whole program. The array, sized and
+// nothrow forms all forward to these two by default.
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+#endif
+
+bool AllocationCounter::IsAvailable() {
+#ifdef MINECRAFTAI_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationCounter::Start() {
+    allocations = 0;
+    counting = true;
+}
+
+uint64_t AllocationCounter::Stop() {
+    counting = false;
+    return allocations;
+}
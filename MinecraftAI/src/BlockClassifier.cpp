@@ -0,0 +1,412 @@
+#include "MinecraftAI.h"
+#include <filesystem>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char LUT_MAGIC[8] = { 'M', 'C', 'B', 'L', 'U', 'T', '1', '\0' };
+const int TABLE_PADDING = 4;        // The AVX2 gather reads 4 bytes at the last index
+const int FILL_PASSES = 2;          // Empty bins take the class of a neighbour this far away
+const float MIN_EXPECTED_SHARE = 0.05f;
+const int HISTOGRAM_LANES = 4;      // Interleaved counters hide store-to-load stalls
+
+// Counts the classes of a row of BGRA pixels into lane histograms
+void HistogramRowBGRA(const uint8_t* row, int count, const uint8_t* table,
+                      uint32_t (*lanes)[BlockClassifier::MAX_CLASSES]) {
+    int x = 0;
+
+#if defined(__AVX2__)
+    const __m256i channelMask = _mm256_set1_epi32(0x1F);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    alignas(32) uint32_t classes[8];
+    
+    for (; x + 8 <= count; x += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x * 4));
+        __m256i b = _mm256_and_si256(_mm256_srli_epi32(pixels, 3), channelMask);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi32(pixels, 11), channelMask);
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(pixels, 19), channelMask);
+        __m256i index = _mm256_or_si256(_mm256_slli_epi32(b, 10),
+                                         _mm256_or_si256(_mm256_slli_epi32(g, 5), r));
+        
+        __m256i gathered = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(classes), _mm256_and_si256(gathered, byteMask));
+        
+        for (int i = 0; i < 8; i++) {
+            lanes[i & (HISTOGRAM_LANES - 1)][classes[i]]++;
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i channelMask = _mm_set1_epi32(0x1F);
+    alignas(16) uint32_t indices[4];
+    
+    for (; x + 4 <= count; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+        __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 3), channelMask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 11), channelMask);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 19), channelMask);
+        __m128i index = _mm_or_si128(_mm_slli_epi32(b, 10), _mm_or_si128(_mm_slli_epi32(g, 5), r));
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+        
+        lanes[0][table[indices[0]]]++;
+        lanes[1][table[indices[1]]]++;
+        lanes[2][table[indices[2]]]++;
+        lanes[3][table[indices[3]]]++;
+    }
+#endif
+    
+    for (; x < count; x++) {
+        const uint8_t* pixel = row + x * 4;
+        lanes[x & (HISTOGRAM_LANES - 1)][table[BlockClassifier::TableIndex(pixel[0], pixel[1], pixel[2])]]++;
+    }
+}
+
+void HistogramRowBGR(const uint8_t* row, int count, const uint8_t* table,
+                     uint32_t (*lanes)[BlockClassifier::MAX_CLASSES]) {
+    for (int x = 0; x < count; x++) {
+        const uint8_t* pixel = row + x * 3;
+        lanes[x & (HISTOGRAM_LANES - 1)][table[BlockClassifier::TableIndex(pixel[0], pixel[1], pixel[2])]]++;
+    }
+}
+
+} // namespace
+
+// BlockClassifier Implementation
+BlockClassifier::BlockClassifier() {
+    UseDefaultRules();
+}
+
+void BlockClassifier::UseDefaultRules() {
+    classNames = { "unknown", "bedrock", "redstone_ore", "stone", "emerald_ore", "gold_ore" };
+    expectedShare.assign(classNames.size(), 1.0f);
+    table.clear();
+}
+
+int BlockClassifier::ClassifyMeanColor(const double* meanBGR) {
+    // Simple color-based block identification, class indices of UseDefaultRules
+    if (meanBGR[0] < 50 && meanBGR[1] < 50 && meanBGR[2] < 50) {
+        return 1;
+    } else if (meanBGR[2] > 200 && meanBGR[0] < 100 && meanBGR[1] < 100) {
+        return 2;
+    } else if (meanBGR[0] > 150 && meanBGR[1] > 150 && meanBGR[2] > 150) {
+        return 3;
+    } else if (meanBGR[1] > 180 && meanBGR[0] < 100 && meanBGR[2] < 100) {
+        return 4;
+    } else if (meanBGR[0] > 200 && meanBGR[1] > 200 && meanBGR[2] < 100) {
+        return 5;
+    }
+    
+    return UNKNOWN;
+}
+
+bool BlockClassifier::Train(const std::string& directory) {
+    std::error_code error;
+    std::vector<std::filesystem::path> classDirectories;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_directory()) classDirectories.push_back(entry.path());
+    }
+    if (error || classDirectories.empty()) {
+        std::cerr << "No block sample directories in " << directory << std::endl;
+        return false;
+    }
+    
+    std::sort(classDirectories.begin(), classDirectories.end());
+    if (classDirectories.size() >= MAX_CLASSES) {
+        std::cerr << "Too many block classes (" << classDirectories.size() << "), at most "
+                 << MAX_CLASSES - 1 << " are supported" << std::endl;
+        return false;
+    }
+    
+    // Color histogram of every class's samples
+    std::vector<std::string> names = { "unknown" };
+    std::vector<std::vector<uint32_t>> counts;
+    std::vector<uint64_t> totals;
+    
+    for (const auto& classDirectory : classDirectories) {
+        std::vector<uint32_t> classCounts(TABLE_SIZE, 0);
+        uint64_t total = 0;
+        
+        for (const auto& entry : std::filesystem::directory_iterator(classDirectory, error)) {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext != ".png" && ext != ".jpg" && ext != ".jpeg" && ext != ".bmp") continue;
+            
+            cv::Mat sample = cv::imread(entry.path().string(), cv::IMREAD_COLOR);
+            if (sample.empty()) continue;
+            
+            for (int y = 0; y < sample.rows; y++) {
+                const uint8_t* row = sample.ptr<uint8_t>(y);
+                for (int x = 0; x < sample.cols; x++) {
+                    classCounts[TableIndex(row[x * 3], row[x * 3 + 1], row[x * 3 + 2])]++;
+                }
+            }
+            total += static_cast<uint64_t>(sample.rows) * sample.cols;
+        }
+        
+        if (total == 0) {
+            std::cerr << "Skipping " << classDirectory.filename().string() << ": no readable samples" << std::endl;
+            continue;
+        }
+        
+        names.push_back(classDirectory.filename().string());
+        counts.push_back(std::move(classCounts));
+        totals.push_back(total);
+    }
+    
+    if (counts.empty()) return false;
+    
+    // Each bin goes to the class it is most typical for; frequencies are
+    // normalized per class so large sample sets do not swallow small ones
+    std::vector<uint8_t> trained(TABLE_SIZE + TABLE_PADDING, UNKNOWN);
+    for (int index = 0; index < TABLE_SIZE; index++) {
+        double best = 0.0;
+        for (size_t c = 0; c < counts.size(); c++) {
+            double frequency = static_cast<double>(counts[c][index]) / totals[c];
+            if (frequency > best) {
+                best = frequency;
+                trained[index] = static_cast<uint8_t>(c + 1);
+            }
+        }
+    }
+    
+    // Grow classes into empty neighbouring bins so slightly different lighting
+    // than in the samples still maps to the nearest class
+    for (int pass = 0; pass < FILL_PASSES; pass++) {
+        std::vector<uint8_t> grown = trained;
+        for (int index = 0; index < TABLE_SIZE; index++) {
+            if (trained[index] != UNKNOWN) continue;
+            
+            int b = (index >> 10) & 0x1F, g = (index >> 5) & 0x1F, r = index & 0x1F;
+            const int neighbours[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+            for (const auto& n : neighbours) {
+                int nb = b + n[0], ng = g + n[1], nr = r + n[2];
+                if (nb < 0 || ng < 0 || nr < 0 || nb > 0x1F || ng > 0x1F || nr > 0x1F) continue;
+                
+                uint8_t neighbour = trained[(nb << 10) | (ng << 5) | nr];
+                if (neighbour != UNKNOWN) {
+                    grown[index] = neighbour;
+                    break;
+                }
+            }
+        }
+        trained.swap(grown);
+    }
+    
+    // Textured blocks share colors with plain ones (ore in stone), so each
+    // class is judged against the share of its own samples it claims
+    std::vector<float> shares(names.size(), 1.0f);
+    for (size_t c = 0; c < counts.size(); c++) {
+        uint64_t claimed = 0;
+        for (int index = 0; index < TABLE_SIZE; index++) {
+            if (trained[index] == static_cast<uint8_t>(c + 1)) claimed += counts[c][index];
+        }
+        shares[c + 1] = std::max(MIN_EXPECTED_SHARE, static_cast<float>(claimed) / totals[c]);
+    }
+    
+    table.swap(trained);
+    classNames.swap(names);
+    expectedShare.swap(shares);
+    return true;
+}
+
+bool BlockClassifier::Save(const std::string& path) const {
+    if (!HasTable()) return false;
+    
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    
+    uint32_t classCount = static_cast<uint32_t>(classNames.size());
+    file.write(LUT_MAGIC, sizeof(LUT_MAGIC));
+    file.write(reinterpret_cast<const char*>(&classCount), sizeof(classCount));
+    for (size_t c = 0; c < classNames.size(); c++) {
+        uint8_t length = static_cast<uint8_t>(std::min<size_t>(classNames[c].size(), 255));
+        file.write(reinterpret_cast<const char*>(&length), 1);
+        file.write(classNames[c].data(), length);
+        file.write(reinterpret_cast<const char*>(&expectedShare[c]), sizeof(float));
+    }
+    file.write(reinterpret_cast<const char*>(table.data()), TABLE_SIZE);
+    
+    return static_cast<bool>(file);
+}
+
+bool BlockClassifier::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    
+    char magic[sizeof(LUT_MAGIC)];
+    uint32_t classCount = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&classCount), sizeof(classCount));
+    if (!file || std::memcmp(magic, LUT_MAGIC, sizeof(magic)) != 0 ||
+        classCount == 0 || classCount > MAX_CLASSES) {
+        std::cerr << "Invalid block color table: " << path << std::endl;
+        return false;
+    }
+    
+    std::vector<std::string> names(classCount);
+    std::vector<float> shares(classCount);
+    for (uint32_t c = 0; c < classCount; c++) {
+        uint8_t length = 0;
+        file.read(reinterpret_cast<char*>(&length), 1);
+        names[c].resize(length);
+        file.read(&names[c][0], length);
+        file.read(reinterpret_cast<char*>(&shares[c]), sizeof(float));
+    }
+    
+    std::vector<uint8_t> loaded(TABLE_SIZE + TABLE_PADDING, UNKNOWN);
+    file.read(reinterpret_cast<char*>(loaded.data()), TABLE_SIZE);
+    if (!file) {
+        std::cerr << "Truncated block color table: " << path << std::endl;
+        return false;
+    }
+    
+    for (int index = 0; index < TABLE_SIZE; index++) {
+        if (loaded[index] >= classCount) loaded[index] = UNKNOWN;
+    }
+    
+    table.swap(loaded);
+    classNames.swap(names);
+    expectedShare.swap(shares);
+    return true;
+}
+
+void BlockClassifier::ComputeHistogram(const cv::Mat& image, const cv::Rect& region, uint32_t* histogram) const {
+    std::fill(histogram, histogram + MAX_CLASSES, 0u);
+    
+    cv::Rect clipped = region & cv::Rect(0, 0, image.cols, image.rows);
+    if (!HasTable() || clipped.empty() || image.depth() != CV_8U || (image.channels() != 3 && image.channels() != 4)) return;
+    
+    uint32_t lanes[HISTOGRAM_LANES][MAX_CLASSES] = {};
+    const uint8_t* lut = table.data();
+    
+    for (int y = clipped.y; y < clipped.y + clipped.height; y++) {
+        const uint8_t* row = image.ptr<uint8_t>(y) + clipped.x * image.channels();
+        if (image.channels() == 4) {
+            HistogramRowBGRA(row, clipped.width, lut, lanes);
+        } else {
+            HistogramRowBGR(row, clipped.width, lut, lanes);
+        }
+    }
+    
+    for (int lane = 0; lane < HISTOGRAM_LANES; lane++) {
+        for (int c = 0; c < MAX_CLASSES; c++) {
+            histogram[c] += lanes[lane][c];
+        }
+    }
+}
+
+int BlockClassifier::Classify(const cv::Mat& image, const cv::Rect& region) const {
+    if (HasTable()) return ClassifyTable(image, region);
+    
+    cv::Rect clipped = region & cv::Rect(0, 0, image.cols, image.rows);
+    if (clipped.empty()) return UNKNOWN;
+    
+    cv::Scalar meanColor = cv::mean(image(clipped));
+    return ClassifyMeanColor(meanColor.val);
+}
+
+int BlockClassifier::ClassifyTable(const cv::Mat& image, const cv::Rect& region) const {
+    uint32_t histogram[MAX_CLASSES];
+    ComputeHistogram(image, region, histogram);
+    
+    uint32_t total = 0;
+    for (int c = 0; c < MAX_CLASSES; c++) total += histogram[c];
+    if (total == 0) return UNKNOWN;
+    
+    int best = UNKNOWN;
+    float bestScore = minScore;
+    for (size_t c = 1; c < classNames.size(); c++) {
+        float score = static_cast<float>(histogram[c]) / total / expectedShare[c];
+        if (score > bestScore) {
+            bestScore = score;
+            best = static_cast<int>(c);
+        }
+    }
+    
+    return best;
+}
+
+void BlockClassifier::ClassifyRegions(const cv::Mat& image, const std::vector<cv::Rect>& regions,
+                                      std::vector<int>& classes, RegionStatsEngine& stats) const {
+    classes.resize(regions.size());
+    
+    // Class histograms do not add up from color sums, every region is counted.
+    // Counting also beats building sums over the union when candidates are
+    // spread out, see the timing BuildBlockColorTable prints.
+    if (HasTable()) {
+        for (size_t i = 0; i < regions.size(); i++) {
+            classes[i] = ClassifyTable(image, regions[i]);
+        }
+        return;
+    }
+    
+    // Mean colors of the whole batch from one pass over the union
+    stats.Build(image, regions);
+    for (size_t i = 0; i < regions.size(); i++) {
+        classes[i] = ClassifyStats(stats.GetStats(regions[i]));
+    }
+}
+
+int BlockClassifier::ClassifyStats(const RegionStatsEngine::RegionStats& stats) const {
+    return stats.count > 0 ? ClassifyMeanColor(stats.mean) : UNKNOWN;
+}
+
+const std::string& BlockClassifier::GetClassName(int classIndex) const {
+    if (classIndex < 0 || classIndex >= static_cast<int>(classNames.size())) return classNames[UNKNOWN];
+    return classNames[classIndex];
+}
+
+int BuildBlockColorTable(const std::string& sampleDirectory, const std::string& outputPath) {
+    BlockClassifier classifier;
+    if (!classifier.Train(sampleDirectory)) {
+        std::cout << "Could not build a block color table from " << sampleDirectory << std::endl;
+        return 1;
+    }
+    
+    if (!classifier.Save(outputPath)) {
+        std::cout << "Failed to write " << outputPath << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Block color table with " << classifier.GetClassCount() - 1 << " block types written to "
+             << outputPath << std::endl;
+    for (size_t c = 1; c < classifier.GetClassCount(); c++) {
+        std::cout << "  " << classifier.GetClassName(static_cast<int>(c)) << std::endl;
+    }
+    
+    // Self check: how fast a typical per-frame batch of candidates classifies
+    cv::Mat frame(1080, 1920, CV_8UC4);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<cv::Rect> candidates;
+    for (int i = 0; i < 48; i++) {
+        candidates.emplace_back(200 + (i % 12) * 120, 300 + (i / 12) * 120, 40, 40);
+    }
+    
+    std::vector<int> classes;
+    RegionStatsEngine stats;
+    const int rounds = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        classifier.ClassifyRegions(frame, candidates, classes, stats);
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Classifying " << candidates.size() << " 40x40 regions takes "
+             << micros / rounds << " us per frame" << std::endl;
+    
+    // What the mean color rules pay for the same batch: sums over the union
+    // of the regions, many times their own area
+    std::vector<RegionStatsEngine::RegionStats> regionStats;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        stats.Build(frame, candidates);
+        stats.GetStats(candidates, regionStats);
+    }
+    micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Region sums over their " << stats.GetArea().width << "x" << stats.GetArea().height
+             << " union take " << micros / rounds << " us per frame" << std::endl;
+    
+    return 0;
+}
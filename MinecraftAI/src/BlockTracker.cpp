@@ -0,0 +1,259 @@
+#include "MinecraftAI.h"
+
+namespace {
+
+const float MIN_IOU = 0.3f;               // Against the predicted box
+const float POSITION_GAIN = 0.6f;         // Alpha, share of the residual taken into the position
+const float VELOCITY_GAIN = 0.3f;         // Beta, share of the residual taken into the velocity
+const float SIZE_GAIN = 0.3f;
+const float MAX_SPEED = 2000.0f;          // Pixels per second, guards against jumps between blocks
+const float MIN_VELOCITY_DT = 0.02f;      // Seconds between passes needed to update the velocity
+const float NEW_TRACK_CONFIDENCE = 0.6f;
+const float HIT_GAIN = 0.4f;              // Share of the missing confidence a match restores
+const float MISS_FACTOR = 0.5f;
+const int MAX_MISSES = 3;
+const float DECAY_SECONDS = 1.5f;         // Confidence time constant of a static track
+const float DECAY_SPEED = 100.0f;         // Each 100 px/s shortens it by another factor of one
+const float REPORT_CONFIDENCE = 0.25f;    // Tracks below are kept for matching only
+const float REDETECT_CONFIDENCE = 0.5f;
+const float DROP_CONFIDENCE = 0.1f;
+const float MAX_VIEW_SHIFT = 16.0f;       // Pixels of new content at the border before a new pass
+
+float Seconds(BlockTracker::Clock::duration duration) {
+    return std::max(0.0f, std::chrono::duration<float>(duration).count());
+}
+
+cv::Point2f Center(const cv::Rect2f& box) {
+    return cv::Point2f(box.x + box.width * 0.5f, box.y + box.height * 0.5f);
+}
+
+cv::Rect2f BoxAt(cv::Point2f center, float width, float height) {
+    return cv::Rect2f(center.x - width * 0.5f, center.y - height * 0.5f, width, height);
+}
+
+cv::Rect2f PredictBox(const BlockTracker::Track& track, BlockTracker::Clock::time_point time) {
+    float dt = Seconds(time - track.lastUpdate);
+    return BoxAt(Center(track.box) + track.velocity * dt, track.box.width, track.box.height);
+}
+
+bool Inside(const cv::Rect2f& box, const cv::Rect2f& area) {
+    return box.x >= area.x && box.y >= area.y &&
+           box.x + box.width <= area.x + area.width && box.y + box.height <= area.y + area.height;
+}
+
+float ConfidenceAt(const BlockTracker::Track& track, BlockTracker::Clock::time_point time) {
+    float age = Seconds(time - track.lastUpdate);
+    float speed = static_cast<float>(cv::norm(track.velocity));
+    return track.confidence * std::exp(-age * (1.0f + speed / DECAY_SPEED) / DECAY_SECONDS);
+}
+
+} // namespace
+
+float BlockTracker::IoU(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float intersection = (a & b).area();
+    if (intersection <= 0.0f) return 0.0f;
+    return intersection / (a.area() + b.area() - intersection);
+}
+
+void BlockTracker::Update(const std::vector<cv::Rect>& detections, Clock::time_point now,
+                          const cv::Rect& region) {
+    trackSearched.resize(tracks.size());
+    for (size_t t = 0; t < tracks.size(); t++) {
+        trackSearched[t] = region.empty() || Inside(PredictBox(tracks[t], now), cv::Rect2f(region));
+    }
+    
+    // Every track/detection pair that overlaps enough, best overlap first
+    candidates.clear();
+    for (size_t t = 0; t < tracks.size(); t++) {
+        if (!trackSearched[t]) continue;
+        cv::Rect2f predicted = PredictBox(tracks[t], now);
+        for (size_t d = 0; d < detections.size(); d++) {
+            float overlap = IoU(predicted, cv::Rect2f(detections[d]));
+            if (overlap >= MIN_IOU) {
+                candidates.push_back({ overlap, { static_cast<int>(t), static_cast<int>(d) } });
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    
+    trackMatch.assign(tracks.size(), -1);
+    detectionMatched.assign(detections.size(), false);
+    for (const auto& candidate : candidates) {
+        int t = candidate.second.first;
+        int d = candidate.second.second;
+        if (trackMatch[t] >= 0 || detectionMatched[d]) continue;
+        trackMatch[t] = d;
+        detectionMatched[d] = true;
+    }
+    
+    // A detection on a track that reaches out of the region is that block,
+    // seen again from inside, not a new one
+    for (size_t t = 0; t < tracks.size(); t++) {
+        if (trackSearched[t]) continue;
+        cv::Rect2f predicted = PredictBox(tracks[t], now);
+        for (size_t d = 0; d < detections.size(); d++) {
+            if (IoU(predicted, cv::Rect2f(detections[d])) >= MIN_IOU) detectionMatched[d] = true;
+        }
+    }
+    
+    for (size_t t = 0; t < tracks.size(); t++) {
+        if (!trackSearched[t]) continue;
+        Track& track = tracks[t];
+        float dt = Seconds(now - track.lastUpdate);
+        cv::Point2f predictedCenter = Center(track.box) + track.velocity * dt;
+        float confidence = ConfidenceAt(track, now);
+        
+        if (trackMatch[t] < 0) {
+            // Coast on the prediction, a few misses in a row end the track
+            track.box = BoxAt(predictedCenter, track.box.width, track.box.height);
+            track.confidence = confidence * MISS_FACTOR;
+            track.misses++;
+        } else {
+            // Alpha-beta filter on the center, plain smoothing on the size
+            cv::Rect2f measured(detections[trackMatch[t]]);
+            cv::Point2f residual = Center(measured) - predictedCenter;
+            
+            if (dt >= MIN_VELOCITY_DT) {
+                // The second sighting is the first velocity measurement, take it whole
+                track.velocity += residual * ((track.hits == 1 ? 1.0f : VELOCITY_GAIN) / dt);
+                float speed = static_cast<float>(cv::norm(track.velocity));
+                if (speed > MAX_SPEED) track.velocity *= MAX_SPEED / speed;
+            }
+            
+            float width = track.box.width + SIZE_GAIN * (measured.width - track.box.width);
+            float height = track.box.height + SIZE_GAIN * (measured.height - track.box.height);
+            track.box = BoxAt(predictedCenter + residual * POSITION_GAIN, width, height);
+            track.confidence = confidence + (1.0f - confidence) * HIT_GAIN;
+            track.hits++;
+            track.misses = 0;
+        }
+        
+        track.lastUpdate = now;
+        track.predicted = track.box;
+    }
+    
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [](const Track& track) {
+        return track.misses > MAX_MISSES || track.confidence < DROP_CONFIDENCE;
+    }), tracks.end());
+    
+    for (size_t d = 0; d < detections.size() && tracks.size() < MAX_TRACKS; d++) {
+        if (detectionMatched[d]) continue;
+        
+        Track track;
+        track.id = nextId++;
+        if (nextId == 0) nextId = 1; // 0 stays reserved for untracked blocks
+        track.box = cv::Rect2f(detections[d]);
+        track.predicted = track.box;
+        track.confidence = NEW_TRACK_CONFIDENCE;
+        track.hits = 1;
+        track.lastUpdate = now;
+        tracks.push_back(track);
+    }
+    
+    predictTime = now;
+}
+
+void BlockTracker::Predict(Clock::time_point now, const cv::Rect& roi) {
+    for (auto& track : tracks) {
+        track.predicted = PredictBox(track, now);
+    }
+    predictTime = now;
+    motionCompensated = false;
+    DropOutside(roi, now);
+}
+
+void BlockTracker::Shift(cv::Point2f shift, Clock::time_point now, const cv::Rect& roi) {
+    for (auto& track : tracks) {
+        // The measured motion replaces the prediction, so the track ages like
+        // a static one; the velocity is kept for frames without a measurement
+        float dt = Seconds(now - track.lastUpdate);
+        track.confidence *= std::exp(-dt / DECAY_SECONDS);
+        if (dt >= MIN_VELOCITY_DT) track.velocity = shift * (1.0f / dt);
+        
+        track.box.x += shift.x;
+        track.box.y += shift.y;
+        track.predicted = track.box;
+        track.lastUpdate = now;
+    }
+    predictTime = now;
+    motionCompensated = true;
+    DropOutside(roi, now);
+}
+
+void BlockTracker::DropOutside(const cv::Rect& roi, Clock::time_point now) {
+    cv::Rect2f area(roi);
+    
+    // Tracks that moved mostly out of the roi are gone
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [&](const Track& track) {
+        return (track.predicted & area).area() < 0.5f * track.predicted.area() ||
+               ConfidenceAt(track, now) < DROP_CONFIDENCE;
+    }), tracks.end());
+}
+
+void BlockTracker::Hold(Clock::time_point now) {
+    for (auto& track : tracks) {
+        track.velocity = cv::Point2f();
+        track.predicted = track.box;
+        track.lastUpdate = now;
+    }
+    predictTime = now;
+}
+
+void BlockTracker::Reset() {
+    tracks.clear();
+    motionCompensated = false;
+}
+
+bool BlockTracker::NeedsDetection() const {
+    if (tracks.empty()) return true;
+    
+    // The view moved far enough for new blocks to have entered at the border
+    cv::Point2f shift;
+    for (const auto& track : tracks) {
+        shift += track.velocity * Seconds(predictTime - track.lastUpdate);
+    }
+    shift *= 1.0f / tracks.size();
+    if (cv::norm(shift) > MAX_VIEW_SHIFT) return true;
+    
+    // New tracks have no velocity yet and need a second pass to follow
+    // motion, unless the measured camera motion carries them
+    for (const auto& track : tracks) {
+        if ((track.hits < 2 && !motionCompensated) || GetConfidence(track) < REDETECT_CONFIDENCE) return true;
+    }
+    return false;
+}
+
+float BlockTracker::GetConfidence(const Track& track) const {
+    return ConfidenceAt(track, predictTime);
+}
+
+void BlockTracker::GetBlocks(cv::Point2f center, std::vector<cv::Rect>& blocks,
+                             std::vector<uint32_t>& ids, std::vector<std::string>& types) const {
+    std::vector<std::pair<float, const Track*>> reported;
+    for (const auto& track : tracks) {
+        if (GetConfidence(track) < REPORT_CONFIDENCE) continue;
+        reported.push_back({ static_cast<float>(cv::norm(Center(track.predicted) - center)), &track });
+    }
+    std::sort(reported.begin(), reported.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    blocks.clear();
+    ids.clear();
+    types.clear();
+    for (const auto& entry : reported) {
+        const cv::Rect2f& box = entry.second->predicted;
+        blocks.push_back(cv::Rect(cvRound(box.x), cvRound(box.y), cvRound(box.width), cvRound(box.height)));
+        ids.push_back(entry.second->id);
+        types.push_back(entry.second->type);
+    }
+}
+
+void BlockTracker::SetType(uint32_t id, const std::string& type) {
+    for (auto& track : tracks) {
+        if (track.id == id) {
+            track.type = type;
+            return;
+        }
+    }
+}
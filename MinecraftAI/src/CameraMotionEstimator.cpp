@@ -0,0 +1,59 @@
+#include "MinecraftAI.h"
+
+namespace {
+
+// Largest even size up to limit that the DFT takes without padding. An odd
+// transform size puts a zero shift between two bins and reports half a pixel.
+int EvenDFTSize(int limit) {
+    for (int size = limit & ~1; size > 0; size -= 2) {
+        if (cv::getOptimalDFTSize(size) == size) return size;
+    }
+    return 0;
+}
+
+} // namespace
+
+CameraMotionEstimator::Motion CameraMotionEstimator::Update(const FrameContext& context, const cv::Rect& region) {
+    lastMotion = Motion();
+    
+    const int scale = 1 << PYRAMID_LEVEL;
+    const cv::Mat& gray = context.GetGray(PYRAMID_LEVEL);
+    cv::Rect scaled(region.x / scale, region.y / scale, region.width / scale, region.height / scale);
+    scaled &= cv::Rect(0, 0, gray.cols, gray.rows);
+    
+    cv::Size size(EvenDFTSize(scaled.width), EvenDFTSize(scaled.height));
+    scaled = cv::Rect(scaled.x + (scaled.width - size.width) / 2, scaled.y + (scaled.height - size.height) / 2,
+                      size.width, size.height);
+    if (scaled.width < MIN_SIZE || scaled.height < MIN_SIZE) {
+        Reset();
+        return lastMotion;
+    }
+    
+    gray(scaled).convertTo(current, CV_32F);
+    
+    if (region == area && current.size() == reference.size()) {
+        if (window.size() != current.size()) {
+            cv::createHanningWindow(window, current.size(), CV_32F);
+        }
+        
+        // Shift of the current picture against the previous one; the peak
+        // height tells how much of the view agrees with it
+        double response = 0.0;
+        cv::Point2d shift = cv::phaseCorrelate(reference, current, window, &response);
+        lastMotion.response = static_cast<float>(response);
+        lastMotion.shift = cv::Point2f(static_cast<float>(shift.x * scale), static_cast<float>(shift.y * scale));
+        lastMotion.valid = response >= minResponse &&
+                           std::fabs(shift.x) <= maxShift * current.cols &&
+                           std::fabs(shift.y) <= maxShift * current.rows;
+    }
+    
+    std::swap(reference, current);
+    area = region;
+    return lastMotion;
+}
+
+void CameraMotionEstimator::Reset() {
+    area = cv::Rect();
+    reference.release();
+    lastMotion = Motion();
+}
@@ -4,6 +4,9 @@ ChatHandler::ChatHandler(const std::string& botPlayerName) : botName(botPlayerNa
     // Initialize chat region (typical Minecraft chat area)
     chatRegion = cv::Rect(2, 2, 400, 200); // Top-left area where chat appears
     
+    // Minecraft's font atlas, a resource pack's textures/font/ascii.png
+    ocr.LoadFont("font/ascii.png");
+    
     // Initialize response templates
     responseTemplates = {
         "Hello {player}!",
@@ -27,76 +30,31 @@ void ChatHandler::ProcessChatRegion(const cv::Mat& gameFrame) {
                              std::min(200, gameFrame.rows - 4));
     }
     
-    cv::Mat chatArea = gameFrame(chatRegion);
-    std::string chatText = ExtractChatText(chatArea);
-    
-    if (!chatText.empty()) {
-        ParseChatMessage(chatText);
-    }
-}
-
-std::string ChatHandler::ExtractChatText(const cv::Mat& chatRegion) {
-    if (chatRegion.empty()) return "";
-    
-    // Convert to grayscale for OCR processing
-    cv::Mat gray;
-    cv::cvtColor(chatRegion, gray, cv::COLOR_BGR2GRAY);
-    
-    // Apply threshold to make text more readable
-    cv::Mat thresh;
-    cv::threshold(gray, thresh, 0, 255, cv::THRESH_BINARY + cv::THRESH_OTSU);
-    
-    // Simple character recognition for common chat patterns
-    // In a full implementation, you'd use a proper OCR library like Tesseract
-    
-    // For now, we'll do pattern matching on known chat formats
-    std::string extractedText = "";
-    
-    // Look for white/bright text areas (typical chat text)
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(thresh, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-    
-    for (const auto& contour : contours) {
-        cv::Rect boundingRect = cv::boundingRect(contour);
-        
-        // Filter for text-like shapes
-        if (boundingRect.width > 5 && boundingRect.height > 8 && 
-            boundingRect.height < 30 && boundingRect.width < 200) {
-            
-            cv::Mat charRegion = thresh(boundingRect);
-            char recognizedChar = RecognizeCharacter(charRegion);
-            
-            if (recognizedChar != '\0') {
-                extractedText += recognizedChar;
-            }
+    // A message stays on screen for several seconds; only lines that were
+    // not there on the previous read are new
+    std::vector<std::string> lines = ExtractChatLines(gameFrame);
+    for (const auto& line : lines) {
+        if (std::find(visibleLines.begin(), visibleLines.end(), line) == visibleLines.end()) {
+            ParseChatMessage(line);
         }
     }
-    
-    return extractedText;
+    visibleLines.swap(lines);
 }
 
-char ChatHandler::RecognizeCharacter(const cv::Mat& charRegion) {
-    // Very simplified character recognition
-    // In practice, you'd use machine learning or a proper OCR library
-    
-    if (charRegion.empty()) return '\0';
-    
-    cv::Scalar meanValue = cv::mean(charRegion);
-    double whitePixelRatio = meanValue[0] / 255.0;
-    
-    // Basic pattern matching based on aspect ratio and pixel density
-    double aspectRatio = static_cast<double>(charRegion.rows) / charRegion.cols;
-    
-    // This is extremely simplified - in reality you'd need much more sophisticated recognition
-    if (whitePixelRatio > 0.3 && aspectRatio > 1.0) {
-        return 'I'; // Tall, narrow character
-    } else if (whitePixelRatio > 0.2 && aspectRatio < 0.8) {
-        return '_'; // Wide, short character  
-    } else if (whitePixelRatio > 0.25) {
-        return 'O'; // Medium character
+std::vector<std::string> ChatHandler::ExtractChatLines(const cv::Mat& gameFrame) {
+    std::vector<std::string> text;
+    
+    // The font is only read at the GUI scale it was drawn at, which is
+    // unknown until the hotbar has been located
+    int scale = guiScale;
+    if (!ocr.HasFont() || scale <= 0) return text;
+    
+    // Takes the color image: dark red or blue text is near black in luma
+    // but bright in its strongest channel
+    for (const auto& line : ocr.ReadLines(gameFrame, chatRegion, scale)) {
+        text.push_back(line.text);
     }
-    
-    return '\0'; // Unrecognized
+    return text;
 }
 
 void ChatHandler::ParseChatMessage(const std::string& rawText) {
@@ -236,7 +194,8 @@ std::string ChatHandler::GenerateResponse(const ChatMessage& message) {
 
 void ChatHandler::SendChatMessage(const std::string& message) {
     if (message.empty()) return;
-    
+
+#ifdef _WIN32
     // Simulate pressing T to open chat
     INPUT input = {0};
     input.type = INPUT_KEYBOARD;
@@ -283,6 +242,9 @@ void ChatHandler::SendChatMessage(const std::string& message) {
     
     input.ki.dwFlags = KEYEVENTF_KEYUP;
     SendInput(1, &input, sizeof(INPUT));
+#else
+    std::cout << "[chat] " << message << std::endl;
+#endif
 }
 
 void ChatHandler::SendWhisper(const std::string& playerName, const std::string& message) {
@@ -0,0 +1,547 @@
+#include "MinecraftAI.h"
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+namespace {
+
+const int TG22 = 13573;           // tan(22.5 deg) in Q15, as in cv::Canny
+const int CANNY_SHIFT = 15;
+const double MIN_ASPECT = 0.7;
+const double MAX_ASPECT = 1.4;
+const double MIN_FILL_RATIO = 0.4;
+const int WARMUP_FRAMES = 2;          // Allocation check: frames that may size the buffers
+
+// Neighbour directions counterclockwise on screen, starting to the right
+const int DIRECTION_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+const int DIRECTION_Y[8] = { 0, -1, -1, -1, 0, 1, 1, 1 };
+
+// Contour labels in the binary image, besides 0 and 1
+const uint8_t BORDER = 2;        // Traced border pixel
+const uint8_t RIGHT_BORDER = 3;  // Traced border pixel whose right neighbour is background
+
+// Buffers come from Mat::create and are continuous; cv::Mat::setTo is not
+// used so no call here can reach an OpenCV scratch allocation
+void FillBytes(cv::Mat& mat, int value) {
+    std::memset(mat.data, value, mat.total() * mat.elemSize());
+}
+
+int Reflect101(int index, int size) {
+    if (size == 1) return 0;
+    if (index < 0) return -index;
+    if (index >= size) return 2 * size - index - 2;
+    return index;
+}
+
+} // namespace
+
+ContourBlockDetector::ContourBlockDetector() {
+    blocks.reserve(MAX_BLOCKS);
+}
+
+const std::vector<cv::Rect>& ContourBlockDetector::Detect(const FrameContext& context, const cv::Rect& roi,
+                                                          cv::Point2f center, size_t maxBlocks) {
+    candidates.clear();
+    blocks.clear();
+    
+    // Gray frame is shared with the other stages through the frame context
+    const cv::Mat& gray = context.GetGray();
+    if (gray.empty()) return blocks;
+    cv::Rect area = roi & cv::Rect(0, 0, gray.cols, gray.rows);
+    if (area.empty()) return blocks;
+    
+    // Worst case capacities, so no frame of this size can grow them: every
+    // pixel enters the edge stack at most once, and every candidate contour
+    // spans at least MIN_BLOCK_SIZE columns of pixels no other one has
+    size_t pixels = static_cast<size_t>(area.width) * area.height;
+    if (edgeStack.capacity() < pixels) edgeStack.reserve(pixels);
+    if (candidates.capacity() < pixels / MIN_BLOCK_SIZE) candidates.reserve(pixels / MIN_BLOCK_SIZE);
+    
+    Blur(gray, area);
+    FindEdges();
+    CloseEdges();
+    TraceContours(area.tl(), center);
+    
+    // Distances were taken once per candidate, only the closest are ordered
+    size_t count = std::min(candidates.size(), maxBlocks);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+    for (size_t i = 0; i < count; i++) {
+        blocks.push_back(candidates[i].rect);
+    }
+    
+    return blocks;
+}
+
+void ContourBlockDetector::GetEdges(cv::Mat& edges) const {
+    if (edgeMap.empty()) {
+        edges.release();
+        return;
+    }
+    const int width = edgeMap.cols - 2;
+    const int height = edgeMap.rows - 2;
+    edges.create(height, width, CV_8U);
+    for (int y = 0; y < height; y++) {
+        const uchar* map = edgeMap.ptr<uchar>(y + 1) + 1;
+        uchar* dst = edges.ptr<uchar>(y);
+        for (int x = 0; x < width; x++) {
+            dst[x] = map[x] == 2 ? 255 : 0;
+        }
+    }
+}
+
+void ContourBlockDetector::Blur(const cv::Mat& gray, const cv::Rect& roi) {
+    const int width = roi.width;
+    const int height = roi.height;
+    blurRows.create(height + 2, width, CV_16U);
+    blurred.create(height + 2, width + 2, CV_8U);
+    
+    // Pixels around the roi come from the frame, reflected only at the frame
+    // edge, like cv::GaussianBlur on a submatrix
+    const int left = Reflect101(roi.x - 1, gray.cols);
+    const int right = Reflect101(roi.x + width, gray.cols);
+    for (int y = 0; y < height + 2; y++) {
+        const uchar* src = gray.ptr<uchar>(Reflect101(roi.y + y - 1, gray.rows));
+        const uchar* row = src + roi.x;
+        uint16_t* dst = blurRows.ptr<uint16_t>(y);
+        
+        dst[0] = static_cast<uint16_t>(src[left] + 2 * row[0] + (width > 1 ? row[1] : src[right]));
+        for (int x = 1; x < width - 1; x++) {
+            dst[x] = static_cast<uint16_t>(row[x - 1] + 2 * row[x] + row[x + 1]);
+        }
+        if (width > 1) {
+            dst[width - 1] = static_cast<uint16_t>(row[width - 2] + 2 * row[width - 1] + src[right]);
+        }
+    }
+    
+    for (int y = 0; y < height; y++) {
+        const uint16_t* above = blurRows.ptr<uint16_t>(y);
+        const uint16_t* current = blurRows.ptr<uint16_t>(y + 1);
+        const uint16_t* below = blurRows.ptr<uint16_t>(y + 2);
+        uchar* dst = blurred.ptr<uchar>(y + 1) + 1;
+        for (int x = 0; x < width; x++) {
+            dst[x] = static_cast<uchar>((above[x] + 2 * current[x] + below[x] + 8) >> 4);
+        }
+        // Canny differentiates the blurred roi on its own, with replicated edges
+        dst[-1] = dst[0];
+        dst[width] = dst[width - 1];
+    }
+    std::memcpy(blurred.ptr<uchar>(0), blurred.ptr<uchar>(1), width + 2);
+    std::memcpy(blurred.ptr<uchar>(height + 1), blurred.ptr<uchar>(height), width + 2);
+}
+
+void ContourBlockDetector::FindEdges() {
+    const int width = blurred.cols - 2;
+    const int height = blurred.rows - 2;
+    gradX.create(height, width, CV_16S);
+    gradY.create(height, width, CV_16S);
+    magnitude.create(height + 2, width + 2, CV_32S);
+    edgeMap.create(height + 2, width + 2, CV_8U);
+    FillBytes(magnitude, 0);
+    
+    // 3x3 Sobel and L1 magnitude
+    for (int y = 0; y < height; y++) {
+        const uchar* above = blurred.ptr<uchar>(y) + 1;
+        const uchar* current = blurred.ptr<uchar>(y + 1) + 1;
+        const uchar* below = blurred.ptr<uchar>(y + 2) + 1;
+        int16_t* dx = gradX.ptr<int16_t>(y);
+        int16_t* dy = gradY.ptr<int16_t>(y);
+        int* mag = magnitude.ptr<int>(y + 1) + 1;
+        for (int x = 0; x < width; x++) {
+            int gx = (above[x + 1] + 2 * current[x + 1] + below[x + 1]) - (above[x - 1] + 2 * current[x - 1] + below[x - 1]);
+            int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+            dx[x] = static_cast<int16_t>(gx);
+            dy[x] = static_cast<int16_t>(gy);
+            mag[x] = std::abs(gx) + std::abs(gy);
+        }
+    }
+    
+    // Non-maximum suppression along the quantized gradient direction
+    FillBytes(edgeMap, 1);
+    edgeStack.clear();
+    const int mapStep = static_cast<int>(edgeMap.step);
+    for (int y = 0; y < height; y++) {
+        const int16_t* dx = gradX.ptr<int16_t>(y);
+        const int16_t* dy = gradY.ptr<int16_t>(y);
+        const int* magAbove = magnitude.ptr<int>(y) + 1;
+        const int* mag = magnitude.ptr<int>(y + 1) + 1;
+        const int* magBelow = magnitude.ptr<int>(y + 2) + 1;
+        uchar* map = edgeMap.ptr<uchar>(y + 1) + 1;
+        
+        for (int x = 0; x < width; x++) {
+            int m = mag[x];
+            if (m <= LOW_THRESHOLD) continue;
+            
+            int xs = dx[x];
+            int ys = dy[x];
+            int ax = std::abs(xs);
+            int ay = std::abs(ys) << CANNY_SHIFT;
+            int tg22x = ax * TG22;
+            
+            bool maximum;
+            if (ay < tg22x) {
+                maximum = m > mag[x - 1] && m >= mag[x + 1];
+            } else if (ay > tg22x + (ax << (CANNY_SHIFT + 1))) {
+                maximum = m > magAbove[x] && m >= magBelow[x];
+            } else {
+                int s = (xs ^ ys) < 0 ? -1 : 1;
+                maximum = m > magAbove[x - s] && m > magBelow[x + s];
+            }
+            if (!maximum) continue;
+            
+            if (m > HIGH_THRESHOLD) {
+                map[x] = 2;
+                edgeStack.push_back(static_cast<int>(&map[x] - edgeMap.data));
+            } else {
+                map[x] = 0;
+            }
+        }
+    }
+    
+    // Hysteresis: weak maxima connected to a strong one become edges
+    const int neighbours[8] = { -mapStep - 1, -mapStep, -mapStep + 1, -1, 1, mapStep - 1, mapStep, mapStep + 1 };
+    uchar* map = edgeMap.data;
+    while (!edgeStack.empty()) {
+        int offset = edgeStack.back();
+        edgeStack.pop_back();
+        for (int n = 0; n < 8; n++) {
+            int next = offset + neighbours[n];
+            if (map[next] == 0) {
+                map[next] = 2;
+                edgeStack.push_back(next);
+            }
+        }
+    }
+}
+
+void ContourBlockDetector::CloseEdges() {
+    const int width = edgeMap.cols - 2;
+    const int height = edgeMap.rows - 2;
+    rowPass.create(height + 2, width, CV_8U);
+    dilated.create(height + 2, width + 2, CV_8U);
+    binary.create(height + 2, width + 2, CV_8U);
+    
+    // Dilate; the edge map border is never an edge, so it adds nothing
+    for (int y = 0; y < height + 2; y++) {
+        const uchar* map = edgeMap.ptr<uchar>(y) + 1;
+        uchar* dst = rowPass.ptr<uchar>(y);
+        for (int x = 0; x < width; x++) {
+            dst[x] = (map[x - 1] == 2) | (map[x] == 2) | (map[x + 1] == 2);
+        }
+    }
+    FillBytes(dilated, 1); // Erosion ignores pixels outside the roi
+    for (int y = 0; y < height; y++) {
+        const uchar* above = rowPass.ptr<uchar>(y);
+        const uchar* current = rowPass.ptr<uchar>(y + 1);
+        const uchar* below = rowPass.ptr<uchar>(y + 2);
+        uchar* dst = dilated.ptr<uchar>(y + 1) + 1;
+        for (int x = 0; x < width; x++) {
+            dst[x] = above[x] | current[x] | below[x];
+        }
+    }
+    
+    // Erode into the 0/1 image the contours are traced in
+    for (int y = 0; y < height + 2; y++) {
+        const uchar* src = dilated.ptr<uchar>(y) + 1;
+        uchar* dst = rowPass.ptr<uchar>(y);
+        for (int x = 0; x < width; x++) {
+            dst[x] = src[x - 1] & src[x] & src[x + 1];
+        }
+    }
+    FillBytes(binary, 0);
+    for (int y = 0; y < height; y++) {
+        const uchar* above = rowPass.ptr<uchar>(y);
+        const uchar* current = rowPass.ptr<uchar>(y + 1);
+        const uchar* below = rowPass.ptr<uchar>(y + 2);
+        uchar* dst = binary.ptr<uchar>(y + 1) + 1;
+        for (int x = 0; x < width; x++) {
+            dst[x] = above[x] & current[x] & below[x];
+        }
+    }
+}
+
+void ContourBlockDetector::TraceContours(cv::Point offset, cv::Point2f center) {
+    const int width = binary.cols - 2;
+    const int height = binary.rows - 2;
+    const int step = static_cast<int>(binary.step);
+    int deltas[16];
+    for (int d = 0; d < 8; d++) {
+        deltas[d] = deltas[d + 8] = DIRECTION_X[d] + DIRECTION_Y[d] * step;
+    }
+    
+    // Outer border following of Suzuki and Abe, as cv::findContours does for
+    // RETR_EXTERNAL. Bounding box and shoelace area are accumulated while
+    // tracing, so no contour points are stored.
+    uchar* image = binary.data;
+    for (int y = 1; y <= height; y++) {
+        uchar lastBorder = 0; // Label of the last traced border passed in this row
+        for (int x = 1; x <= width; x++) {
+            uchar* start = image + y * step + x;
+            uchar value = *start;
+            if (value >= BORDER) lastBorder = value;
+            if (value != 1 || start[-1] != 0) continue;
+            
+            // Inside an external contour that was already traced
+            if (lastBorder == BORDER) continue;
+            
+            int s = 4;
+            uchar* first = nullptr;
+            do {
+                s = (s - 1) & 7;
+                first = start + deltas[s];
+            } while (*first == 0 && s != 4);
+            
+            int minX = x, maxX = x, minY = y, maxY = y;
+            int64_t doubleArea = 0;
+            
+            if (s == 4) {
+                *start = RIGHT_BORDER; // Isolated pixel
+            } else {
+                uchar* current = start;
+                int cx = x, cy = y;
+                for (;;) {
+                    uchar* next = nullptr;
+                    while (s < 15) {
+                        next = current + deltas[++s];
+                        if (*next != 0) break;
+                    }
+                    // Passing direction 8 means the right neighbour was examined and empty
+                    bool rightEmpty = s > 8;
+                    s &= 7;
+                    
+                    if (rightEmpty) {
+                        *current = RIGHT_BORDER;
+                    } else if (*current == 1) {
+                        *current = BORDER;
+                    }
+                    
+                    int nx = cx + DIRECTION_X[s];
+                    int ny = cy + DIRECTION_Y[s];
+                    doubleArea += static_cast<int64_t>(cx) * ny - static_cast<int64_t>(nx) * cy;
+                    minX = std::min(minX, cx);
+                    maxX = std::max(maxX, cx);
+                    minY = std::min(minY, cy);
+                    maxY = std::max(maxY, cy);
+                    
+                    if (next == start && current == first) break;
+                    current = next;
+                    cx = nx;
+                    cy = ny;
+                    s = (s + 4) & 7;
+                }
+            }
+            lastBorder = *start;
+            
+            // Box shape filter; pixel coordinates carry the 1 pixel border
+            cv::Rect rect(minX - 1 + offset.x, minY - 1 + offset.y, maxX - minX + 1, maxY - minY + 1);
+            if (rect.width < MIN_BLOCK_SIZE || rect.width > MAX_BLOCK_SIZE ||
+                rect.height < MIN_BLOCK_SIZE || rect.height > MAX_BLOCK_SIZE) {
+                continue;
+            }
+            
+            double aspectRatio = static_cast<double>(rect.height) / rect.width;
+            // The enclosed area, which region sums of the edge map cannot give
+            double fillRatio = std::abs(doubleArea) * 0.5 / rect.area();
+            if (aspectRatio > MIN_ASPECT && aspectRatio < MAX_ASPECT && fillRatio > MIN_FILL_RATIO) {
+                cv::Point2f rectCenter(rect.x + rect.width / 2.0f, rect.y + rect.height / 2.0f);
+                cv::Point2f delta = rectCenter - center;
+                candidates.push_back({ rect, delta.dot(delta) });
+            }
+        }
+    }
+}
+
+namespace {
+
+// Counts cv::Mat buffer allocations, everything else goes to the wrapped allocator
+class CountingMatAllocator : public cv::MatAllocator {
+private:
+    const cv::MatAllocator* base;
+    
+public:
+    mutable std::atomic<uint64_t> count{0};
+    
+    explicit CountingMatAllocator(const cv::MatAllocator* allocator) : base(allocator) {}
+    
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        if (!data) count++;
+        return base->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+    
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return base->allocate(data, accessFlags, usageFlags);
+    }
+    
+    void deallocate(cv::UMatData* data) const override {
+        base->deallocate(data);
+    }
+};
+
+// The pipeline ContourBlockDetector replaces, written with the OpenCV calls.
+// Blocks are unordered and uncapped.
+void DetectReference(const cv::Mat& gray, const cv::Rect& roi, std::vector<cv::Rect>& blocks, cv::Mat& edges) {
+    blocks.clear();
+    
+    cv::Mat blurred;
+    cv::GaussianBlur(gray(roi), blurred, cv::Size(3, 3), 0);
+    cv::Canny(blurred, edges, ContourBlockDetector::LOW_THRESHOLD, ContourBlockDetector::HIGH_THRESHOLD);
+    
+    cv::Mat closed;
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    cv::morphologyEx(edges, closed, cv::MORPH_CLOSE, kernel);
+    
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(closed, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    
+    for (const auto& contour : contours) {
+        cv::Rect rect = cv::boundingRect(contour) + roi.tl();
+        if (rect.width < ContourBlockDetector::MIN_BLOCK_SIZE || rect.width > ContourBlockDetector::MAX_BLOCK_SIZE ||
+            rect.height < ContourBlockDetector::MIN_BLOCK_SIZE || rect.height > ContourBlockDetector::MAX_BLOCK_SIZE) {
+            continue;
+        }
+        
+        double aspectRatio = static_cast<double>(rect.height) / rect.width;
+        double fillRatio = cv::contourArea(contour) / rect.area();
+        if (aspectRatio > MIN_ASPECT && aspectRatio < MAX_ASPECT && fillRatio > MIN_FILL_RATIO) {
+            blocks.push_back(rect);
+        }
+    }
+}
+
+bool RectLess(const cv::Rect& a, const cv::Rect& b) {
+    return std::tie(a.y, a.x, a.width, a.height) < std::tie(b.y, b.x, b.width, b.height);
+}
+
+} // namespace
+
+int RunDetectorAllocationCheck(const std::string& path, int maxFrames) {
+    FileFrameSource source(path, 0.0);
+    if (!source.Open()) {
+        std::cerr << "Could not open frames from " << path << std::endl;
+        return 1;
+    }
+    
+    ContourBlockDetector detector;
+    ContourBlockDetector uncapped; // Reference diff, kept apart from the checked buffers
+    cv::MatAllocator* defaultAllocator = cv::Mat::getDefaultAllocator();
+    CountingMatAllocator matAllocator(defaultAllocator);
+    
+    cv::Mat frame;
+    cv::Size frameSize;
+    int frames = 0;
+    int checked = 0;
+    int allocatingFrames = 0;
+    uint64_t heapAllocations = 0;
+    uint64_t matAllocations = 0;
+    
+    std::vector<cv::Rect> detected, expected, unmatched;
+    cv::Mat edges, referenceEdges, edgeDiff;
+    uint64_t edgePixels = 0;
+    uint64_t differentEdges = 0;
+    int edgeFrames = 0;
+    uint64_t matchedBlocks = 0;
+    uint64_t missingBlocks = 0;
+    uint64_t extraBlocks = 0;
+    int blockFrames = 0;
+    
+    while ((maxFrames <= 0 || frames < maxFrames) && source.Grab(frame)) {
+        if (frame.empty()) continue;
+        frames++;
+        
+        // A new frame size resizes the buffers and starts a new warm-up
+        if (frame.size() != frameSize) {
+            frameSize = frame.size();
+            checked = -WARMUP_FRAMES;
+        }
+        
+        // Same mining ROI and crosshair as OptimizedMinecraftBot
+        cv::Rect roi(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+        cv::Point2f crosshair(frame.cols / 2.0f, frame.rows / 2.0f);
+        
+        // The gray image belongs to the frame context, not to the detector
+        FrameContext context(frame, frames);
+        context.GetGray();
+        
+        if (checked++ < 0) {
+            detector.Detect(context, roi, crosshair);
+        } else {
+            matAllocator.count = 0;
+            cv::Mat::setDefaultAllocator(&matAllocator);
+            AllocationCounter::Start();
+            
+            detector.Detect(context, roi, crosshair);
+            
+            uint64_t heap = AllocationCounter::Stop();
+            cv::Mat::setDefaultAllocator(defaultAllocator);
+            
+            heapAllocations += heap;
+            matAllocations += matAllocator.count;
+            if (heap > 0 || matAllocator.count > 0) allocatingFrames++;
+        }
+        
+        // Every candidate, so the cap cannot hide a difference behind a distance tie
+        const std::vector<cv::Rect>& found = uncapped.Detect(context, roi, crosshair,
+                                                             std::numeric_limits<size_t>::max());
+        detected.assign(found.begin(), found.end());
+        uncapped.GetEdges(edges);
+        DetectReference(context.GetGray(), roi, expected, referenceEdges);
+        
+        cv::compare(edges, referenceEdges, edgeDiff, cv::CMP_NE);
+        int differing = cv::countNonZero(edgeDiff);
+        edgePixels += cv::countNonZero(referenceEdges);
+        differentEdges += differing;
+        if (differing > 0) edgeFrames++;
+        
+        std::sort(detected.begin(), detected.end(), RectLess);
+        std::sort(expected.begin(), expected.end(), RectLess);
+        unmatched.clear();
+        std::set_difference(expected.begin(), expected.end(), detected.begin(), detected.end(),
+                            std::back_inserter(unmatched), RectLess);
+        size_t missing = unmatched.size();
+        unmatched.clear();
+        std::set_difference(detected.begin(), detected.end(), expected.begin(), expected.end(),
+                            std::back_inserter(unmatched), RectLess);
+        size_t extra = unmatched.size();
+        matchedBlocks += expected.size() - missing;
+        missingBlocks += missing;
+        extraBlocks += extra;
+        if (missing > 0 || extra > 0) blockFrames++;
+    }
+    
+    int measured = 0;
+    if (frames > 0) measured = std::max(0, checked);
+    if (measured == 0) {
+        std::cout << "Need more than " << WARMUP_FRAMES << " frames of one size from " << path << std::endl;
+        return 1;
+    }
+    
+    std::cout << "=== Detector allocation check (" << frames << " frames, "
+             << frameSize.width << "x" << frameSize.height << ") ===" << std::endl;
+    std::cout << "cv::Mat buffers: " << matAllocations << " allocations" << std::endl;
+    bool counted = AllocationCounter::IsAvailable();
+    if (counted) {
+        std::cout << "operator new: " << heapAllocations << " allocations" << std::endl;
+    } else {
+        std::cout << "operator new: not counted (configure with -DMINECRAFTAI_COUNT_ALLOCATIONS=ON)" << std::endl;
+    }
+    
+    bool allocationFree = counted && allocatingFrames == 0;
+    std::cout << (allocationFree ? "PASS" : "FAIL") << ": " << allocatingFrames << " of " << measured
+             << " frames after warm-up allocated";
+    if (!counted) std::cout << ", operator new unchecked";
+    std::cout << std::endl;
+    
+    std::cout << "\n=== Reference diff (GaussianBlur, Canny, morphologyEx, findContours) ===" << std::endl;
+    std::cout << "Edge pixels: " << differentEdges << " differ of " << edgePixels
+             << " (" << edgeFrames << " of " << frames << " frames)" << std::endl;
+    std::cout << "Blocks: " << matchedBlocks << " matched, " << missingBlocks << " missing, "
+             << extraBlocks << " extra (" << blockFrames << " of " << frames << " frames)" << std::endl;
+    
+    bool matches = edgeFrames == 0 && blockFrames == 0;
+    std::cout << (matches ? "PASS" : "FAIL") << ": hand-written pipeline "
+             << (matches ? "matches" : "differs from") << " OpenCV" << std::endl;
+    
+    return allocationFree && matches ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#include "MinecraftAI.h"
+
+CrosshairProbe::CrosshairProbe() : quadrants(QUADRANTS) {}
+
+cv::Rect CrosshairProbe::GetWindow(cv::Size frameSize) {
+    return cv::Rect(frameSize.width / 2 - WINDOW_SIZE / 2, frameSize.height / 2 - WINDOW_SIZE / 2,
+                    WINDOW_SIZE, WINDOW_SIZE);
+}
+
+bool CrosshairProbe::Update(const cv::Mat& frame, const BlockClassifier& classifier) {
+    auto start = std::chrono::steady_clock::now();
+    
+    cv::Rect window = GetWindow(frame.size());
+    if (frame.empty() || (window & cv::Rect(0, 0, frame.cols, frame.rows)) != window) {
+        Reset();
+        return false;
+    }
+    
+    // Corner quadrants of the window, the crosshair band between them is skipped
+    const int side = (WINDOW_SIZE - CROSSHAIR_BAND) / 2;
+    const int far = WINDOW_SIZE - side;
+    quadrants[0] = cv::Rect(window.x, window.y, side, side);
+    quadrants[1] = cv::Rect(window.x + far, window.y, side, side);
+    quadrants[2] = cv::Rect(window.x, window.y + far, side, side);
+    quadrants[3] = cv::Rect(window.x + far, window.y + far, side, side);
+    
+    stats.Build(frame, window, true);
+    
+    RegionStatsEngine::RegionStats current[QUADRANTS];
+    for (int q = 0; q < QUADRANTS; q++) {
+        current[q] = stats.GetStats(quadrants[q]);
+    }
+    float difference = Difference(current, quadrantStats);
+    
+    int votes[QUADRANTS] = {};
+    for (int q = 0; q < QUADRANTS; q++) {
+        quadrantStats[q] = current[q];
+        quadrantClasses[q] = classifier.HasTable() ? classifier.Classify(frame, quadrants[q])
+                                                   : classifier.ClassifyStats(current[q]);
+        for (int other = 0; other <= q; other++) {
+            if (quadrantClasses[other] == quadrantClasses[q]) {
+                votes[other]++;
+                break;
+            }
+        }
+    }
+    
+    // Two quadrants agreeing decide; with the crosshair on a block corner
+    // every quadrant may see a different block
+    int majority = BlockClassifier::UNKNOWN;
+    int bestVotes = 1;
+    for (int q = 0; q < QUADRANTS; q++) {
+        if (votes[q] > bestVotes) {
+            bestVotes = votes[q];
+            majority = quadrantClasses[q];
+        }
+    }
+    
+    changed = hasSample && (majority != classIndex || difference > changeThreshold);
+    classIndex = majority;
+    hasSample = true;
+    
+    lastCostMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return changed;
+}
+
+void CrosshairProbe::Reset() {
+    classIndex = BlockClassifier::UNKNOWN;
+    hasSample = false;
+    changed = false;
+}
+
+float CrosshairProbe::Difference(const RegionStatsEngine::RegionStats* a, const RegionStatsEngine::RegionStats* b) {
+    float difference = 0.0f;
+    for (int q = 0; q < QUADRANTS; q++) {
+        for (int c = 0; c < RegionStatsEngine::MAX_CHANNELS; c++) {
+            difference += static_cast<float>(std::fabs(a[q].mean[c] - b[q].mean[c]) +
+                                             std::fabs(a[q].stddev[c] - b[q].stddev[c]));
+        }
+    }
+    return difference / (QUADRANTS * RegionStatsEngine::MAX_CHANNELS);
+}
+
+// BlockBreakDetector Implementation
+namespace {
+
+const int MIN_BREAK_MS = 40;            // Faster than the game can break anything after the click
+const float CRACK_FULL_DRIFT = 20.0f;   // Drift of a complete crack overlay
+const float MIN_CRACK_PEAK = 6.0f;      // Drift that proves cracks were visible
+const float CRACK_GONE_FRACTION = 0.35f;
+
+} // namespace
+
+void BlockBreakDetector::Arm(Clock::time_point now) {
+    armed = true;
+    hasReference = false;
+    broken = false;
+    crackDrift = 0.0f;
+    crackPeak = 0.0f;
+    armTime = now;
+}
+
+void BlockBreakDetector::Disarm() {
+    armed = false;
+    hasReference = false;
+    broken = false;
+    crackDrift = 0.0f;
+    crackPeak = 0.0f;
+}
+
+bool BlockBreakDetector::Update(const CrosshairProbe& probe, Clock::time_point frameTime) {
+    if (!armed || broken || !probe.HasSample()) return false;
+    
+    RegionStatsEngine::RegionStats sample[CrosshairProbe::QUADRANTS];
+    for (int q = 0; q < CrosshairProbe::QUADRANTS; q++) {
+        sample[q] = probe.GetQuadrantStats(q);
+    }
+    
+    float drift = hasReference ? CrosshairProbe::Difference(sample, reference) : 0.0f;
+    bool cracksGone = crackPeak >= MIN_CRACK_PEAK && drift < crackPeak * CRACK_GONE_FRACTION;
+    bool replaced = hasReference && (probe.TargetChanged() || probe.GetClass() != referenceClass);
+    bool early = frameTime - armTime < std::chrono::milliseconds(MIN_BREAK_MS);
+    
+    if ((replaced || cracksGone) && !early) {
+        broken = true;
+        return true;
+    }
+    
+    // A jump right after arming is the view still settling from the aim
+    // movement, the block is compared against where it ended up
+    if (!hasReference || replaced) {
+        std::copy(sample, sample + CrosshairProbe::QUADRANTS, reference);
+        referenceClass = probe.GetClass();
+        hasReference = true;
+        crackDrift = 0.0f;
+        crackPeak = 0.0f;
+        return false;
+    }
+    
+    // Still the same block, the drift is crack progress
+    crackDrift = drift;
+    crackPeak = std::max(crackPeak, drift);
+    return false;
+}
+
+float BlockBreakDetector::GetCrackLevel() const {
+    return std::min(1.0f, crackDrift / CRACK_FULL_DRIFT);
+}
@@ -0,0 +1,626 @@
+#include "MinecraftAI.h"
+#include <bitset>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int ATLAS_CELLS = 16;          // Characters per row and column of the atlas
+const int INK_LEVEL = 128;           // Atlas alpha (or level without alpha) of glyph pixels
+const float PEAK_SHARE = 0.3f;       // Of the brightest ink: above its shadow at a quarter, below dark gray at a third
+const int ERROR_WEIGHT = 4;          // Ink pixels a misread pixel costs when choosing a line's phase
+
+const int BENCH_SEED = 1234;
+const int BENCH_MAX_SCALE = 4;
+const int BENCH_MAX_LENGTH = 40;
+const int BENCH_NOISE = 64;          // Background levels, about the chat box over the game
+const int BENCH_DIM_NOISE = 24;      // Dark gray stands out by minContrast only over darker scenes
+const double MIN_BENCH_ACCURACY = 0.99;
+const cv::Scalar BENCH_COLORS[] = {
+    cv::Scalar(255, 255, 255), cv::Scalar(170, 170, 170), cv::Scalar(85, 255, 255), cv::Scalar(255, 255, 85),
+    cv::Scalar(85, 255, 85), cv::Scalar(85, 85, 255), cv::Scalar(0, 170, 255), cv::Scalar(255, 85, 255),
+    cv::Scalar(0, 0, 170), cv::Scalar(170, 0, 0) // Dark red and dark blue, near black in luma
+};
+const cv::Scalar BENCH_DARK_GRAY(85, 85, 85);
+
+// The font as Minecraft draws it, from the atlas cells
+struct AtlasFont {
+    cv::Mat ink;    // Alpha, or the level of an atlas without alpha
+    int cell = 0;   // Atlas pixels per cell side
+    int advances[FontOCR::LAST_CHAR + 1] = {};
+};
+
+int PopCount(uint64_t bits) {
+    return static_cast<int>(std::bitset<64>(bits).count());
+}
+
+int EditDistance(const std::string& a, const std::string& b) {
+    std::vector<int> previous(b.size() + 1);
+    std::vector<int> current(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++) previous[j] = static_cast<int>(j);
+    
+    for (size_t i = 1; i <= a.size(); i++) {
+        current[0] = static_cast<int>(i);
+        for (size_t j = 1; j <= b.size(); j++) {
+            int substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+            current[j] = std::min(substitution, std::min(previous[j], current[j - 1]) + 1);
+        }
+        std::swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+// Printable ASCII with single spaces between words, none at either end
+std::string RandomText(std::mt19937& random) {
+    std::uniform_int_distribution<int> length(1, BENCH_MAX_LENGTH);
+    std::uniform_int_distribution<int> code(FontOCR::FIRST_CHAR, FontOCR::LAST_CHAR);
+    std::uniform_int_distribution<int> spacing(0, 5);
+    
+    int count = length(random);
+    std::string text;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && i < count - 1 && text.back() != ' ' && spacing(random) == 0) {
+            text += ' ';
+        } else {
+            text += static_cast<char>(code(random));
+        }
+    }
+    return text;
+}
+
+bool LoadAtlasFont(const std::string& path, AtlasFont& font) {
+    cv::Mat atlas = cv::imread(path, cv::IMREAD_UNCHANGED);
+    if (atlas.empty() || atlas.depth() != CV_8U || atlas.cols < ATLAS_CELLS * FontOCR::GLYPH_SIZE ||
+        atlas.rows < atlas.cols) {
+        return false;
+    }
+    
+    if (atlas.channels() == 4) {
+        cv::extractChannel(atlas, font.ink, 3);
+    } else if (atlas.channels() == 3) {
+        cv::cvtColor(atlas, font.ink, cv::COLOR_BGR2GRAY);
+    } else {
+        font.ink = atlas;
+    }
+    font.cell = atlas.cols / ATLAS_CELLS;
+    
+    // Minecraft's width rule: the last cell column holding any ink, in GUI
+    // pixels, and one empty column after it
+    for (int code = FontOCR::FIRST_CHAR; code <= FontOCR::LAST_CHAR; code++) {
+        cv::Mat cell = font.ink(cv::Rect((code % ATLAS_CELLS) * font.cell, (code / ATLAS_CELLS) * font.cell,
+                                         font.cell, font.cell));
+        int last = font.cell - 1;
+        while (last >= 0 && cv::countNonZero(cell.col(last)) == 0) last--;
+        font.advances[code] = last < 0 ? FontOCR::SPACE_ADVANCE
+                                       : static_cast<int>(0.5 + (last + 1) * FontOCR::GLYPH_SIZE / static_cast<double>(font.cell)) + 1;
+    }
+    return true;
+}
+
+// GUI pixels Minecraft advances over the text
+int AtlasTextWidth(const AtlasFont& font, const std::string& text) {
+    int width = 0;
+    for (char code : text) {
+        int c = static_cast<unsigned char>(code);
+        width += c >= FontOCR::FIRST_CHAR && c <= FontOCR::LAST_CHAR ? font.advances[c] : FontOCR::SPACE_ADVANCE;
+    }
+    return width;
+}
+
+// Draws each character's cell scaled to the GUI scale, its ink blended over
+// a CV_8UC3 image by its alpha
+void RenderAtlasText(cv::Mat& image, const AtlasFont& font, const std::string& text, cv::Point origin, int scale,
+                     const cv::Scalar& color) {
+    const int side = FontOCR::GLYPH_SIZE * scale;
+    cv::Mat scaled;
+    int x = origin.x;
+    for (char code : text) {
+        int c = static_cast<unsigned char>(code);
+        if (c < FontOCR::FIRST_CHAR || c > FontOCR::LAST_CHAR) {
+            x += FontOCR::SPACE_ADVANCE * scale;
+            continue;
+        }
+        
+        cv::Rect cell((c % ATLAS_CELLS) * font.cell, (c / ATLAS_CELLS) * font.cell, font.cell, font.cell);
+        cv::resize(font.ink(cell), scaled, cv::Size(side, side), 0, 0, cv::INTER_NEAREST);
+        for (int v = 0; v < side; v++) {
+            int y = origin.y + v;
+            if (y < 0 || y >= image.rows) continue;
+            const uchar* alpha = scaled.ptr<uchar>(v);
+            uchar* row = image.ptr<uchar>(y);
+            for (int u = 0; u < side; u++) {
+                int px = x + u;
+                if (!alpha[u] || px < 0 || px >= image.cols) continue;
+                uchar* pixel = row + px * 3;
+                for (int ch = 0; ch < 3; ch++) {
+                    pixel[ch] = cv::saturate_cast<uchar>(pixel[ch] + (color[ch] - pixel[ch]) * alpha[u] / 255.0);
+                }
+            }
+        }
+        x += font.advances[c] * scale;
+    }
+}
+
+} // namespace
+
+// FontOCR Implementation
+bool FontOCR::LoadFont(const std::string& path) {
+    cv::Mat atlas = cv::imread(path, cv::IMREAD_UNCHANGED);
+    if (atlas.empty()) return false;
+    if (atlas.depth() != CV_8U || atlas.cols < ATLAS_CELLS * GLYPH_SIZE || atlas.rows < atlas.cols) {
+        std::cerr << "Font atlas " << path << " is not 16x16 cells of at least 8x8 pixels" << std::endl;
+        return false;
+    }
+    
+    cv::Mat ink;
+    if (atlas.channels() == 4) {
+        cv::extractChannel(atlas, ink, 3);
+    } else if (atlas.channels() == 3) {
+        cv::cvtColor(atlas, ink, cv::COLOR_BGR2GRAY);
+    } else {
+        ink = atlas;
+    }
+    
+    // High resolution atlases are read at 8x8 per cell, the GUI pixels
+    // Minecraft draws a character on
+    const int cell = atlas.cols / ATLAS_CELLS;
+    std::vector<Glyph> loaded;
+    std::vector<uint64_t> loadedBits;
+    std::vector<uint64_t> loadedMasks;
+    
+    for (int code = FIRST_CHAR; code <= LAST_CHAR; code++) {
+        int cellX = (code % ATLAS_CELLS) * cell;
+        int cellY = (code / ATLAS_CELLS) * cell;
+        uint8_t cellColumns[GLYPH_SIZE] = {};
+        for (int v = 0; v < GLYPH_SIZE; v++) {
+            const uchar* row = ink.ptr<uchar>(cellY + (2 * v + 1) * cell / (2 * GLYPH_SIZE));
+            for (int u = 0; u < GLYPH_SIZE; u++) {
+                if (row[cellX + (2 * u + 1) * cell / (2 * GLYPH_SIZE)] >= INK_LEVEL) {
+                    cellColumns[u] |= static_cast<uint8_t>(1 << v);
+                }
+            }
+        }
+        
+        int first = 0;
+        while (first < GLYPH_SIZE && !cellColumns[first]) first++;
+        if (first == GLYPH_SIZE) continue;
+        int last = GLYPH_SIZE - 1;
+        while (!cellColumns[last]) last--;
+        
+        Glyph glyph;
+        glyph.code = static_cast<char>(code);
+        glyph.leading = first;
+        glyph.width = last - first + 1;
+        glyph.advance = last + 2; // Minecraft leaves one empty column after the ink
+        
+        // Byte c holds column c; bits and window are both copied from bytes in
+        // memory, so the comparison does not depend on byte order
+        uint8_t bits[GLYPH_SIZE] = {};
+        uint8_t mask[GLYPH_SIZE] = {};
+        for (int c = 0; c <= glyph.width && c < GLYPH_SIZE; c++) {
+            if (c < glyph.width) bits[c] = cellColumns[first + c];
+            mask[c] = 0xFF;
+        }
+        
+        uint64_t packedBits = 0;
+        uint64_t packedMask = 0;
+        std::memcpy(&packedBits, bits, sizeof(packedBits));
+        std::memcpy(&packedMask, mask, sizeof(packedMask));
+        glyph.pixels = PopCount(packedBits);
+        
+        loaded.push_back(glyph);
+        loadedBits.push_back(packedBits);
+        loadedMasks.push_back(packedMask);
+    }
+    
+    if (loaded.empty()) {
+        std::cerr << "No glyphs in font atlas " << path << std::endl;
+        return false;
+    }
+    
+    // Nothing masked equals a non-zero value, so padding never matches
+    while (loadedBits.size() % GLYPH_BATCH != 0) {
+        loadedBits.push_back(1);
+        loadedMasks.push_back(0);
+    }
+    
+    glyphs.swap(loaded);
+    glyphBits.swap(loadedBits);
+    glyphMasks.swap(loadedMasks);
+    return true;
+}
+
+const std::vector<FontOCR::Line>& FontOCR::ReadLines(const cv::Mat& image, const cv::Rect& area, int scale) {
+    lines.clear();
+    if (!HasFont() || scale < 1 || image.empty() || image.depth() != CV_8U ||
+        (image.channels() != 1 && image.channels() != 3 && image.channels() != 4)) {
+        return lines;
+    }
+    
+    cv::Rect grid = SampleLevels(image, area, scale);
+    if (grid.height < GLYPH_SIZE || grid.width == 0) return lines;
+    
+    const int background = BackgroundLevel();
+    const int inkLevel = background + minContrast;
+    auto hasInk = [this, inkLevel](int v) {
+        const uchar* row = levels.ptr<uchar>(v);
+        return std::any_of(row, row + levels.cols, [inkLevel](uchar level) { return level >= inkLevel; });
+    };
+    
+    int next = 0;
+    while (next < grid.height) {
+        int start = next;
+        while (start < grid.height && !hasInk(start)) start++;
+        if (start >= grid.height) break;
+        
+        // The first row with ink is one of the line's 8; capitals and digits
+        // reach the top one, so that phase is tried first and kept on a tie
+        int bestTop = -1;
+        int bestScore = 0;
+        for (int top = start; top >= std::max(next, start - GLYPH_SIZE + 1); top--) {
+            if (top + GLYPH_SIZE > grid.height) continue;
+            
+            ReadRow(top, background, grid.tl(), scale, candidate);
+            int score = candidate.pixels - ERROR_WEIGHT * candidate.errors;
+            if (candidate.characters.empty() || score <= bestScore) continue;
+            
+            if (bestTop < 0) lines.emplace_back();
+            std::swap(lines.back(), candidate);
+            bestTop = top;
+            bestScore = score;
+        }
+        
+        next = bestTop >= 0 ? bestTop + GLYPH_SIZE : start + 1;
+    }
+    return lines;
+}
+
+bool FontOCR::ReadLine(const cv::Mat& image, cv::Point origin, int width, int scale, Line& line) {
+    line = Line();
+    if (!HasFont() || scale < 1 || image.empty() || image.depth() != CV_8U ||
+        (image.channels() != 1 && image.channels() != 3 && image.channels() != 4)) {
+        return false;
+    }
+    
+    cv::Rect grid = SampleLevels(image, cv::Rect(origin.x, origin.y, width, GLYPH_SIZE * scale), scale);
+    if (grid.height < GLYPH_SIZE || grid.width == 0) return false;
+    
+    ReadRow(0, BackgroundLevel(), grid.tl(), scale, line);
+    return !line.characters.empty();
+}
+
+uint64_t FontOCR::HashLineInk(const cv::Mat& image, cv::Point origin, int width, int scale) {
+    if (scale < 1 || image.empty() || image.depth() != CV_8U ||
+        (image.channels() != 1 && image.channels() != 3 && image.channels() != 4)) {
+        return 0;
+    }
+    
+    cv::Rect grid = SampleLevels(image, cv::Rect(origin.x, origin.y, width, GLYPH_SIZE * scale), scale);
+    if (grid.height < GLYPH_SIZE || grid.width == 0 || !FindInk(0, BackgroundLevel())) return 0;
+    
+    return TileChangeMap::HashImage(cv::Mat(1, grid.width, CV_8U, columns.data()));
+}
+
+cv::Rect FontOCR::SampleLevels(const cv::Mat& image, const cv::Rect& area, int scale) {
+    // GUI pixels wholly inside the area, each sampled at its center
+    cv::Rect clipped = area & cv::Rect(0, 0, image.cols, image.rows);
+    int left = (clipped.x + scale - 1) / scale;
+    int top = (clipped.y + scale - 1) / scale;
+    int right = clipped.br().x / scale;
+    int bottom = clipped.br().y / scale;
+    cv::Rect grid(left, top, std::max(0, right - left), std::max(0, bottom - top));
+    
+    // Text of any color is brighter than its background in its strongest channel
+    levels.create(grid.height, grid.width, CV_8U);
+    const int channels = image.channels();
+    for (int v = 0; v < grid.height; v++) {
+        const uchar* row = image.ptr<uchar>((grid.y + v) * scale + scale / 2);
+        uchar* out = levels.ptr<uchar>(v);
+        for (int u = 0; u < grid.width; u++) {
+            const uchar* pixel = row + ((grid.x + u) * scale + scale / 2) * channels;
+            out[u] = channels == 1 ? pixel[0] : std::max(pixel[0], std::max(pixel[1], pixel[2]));
+        }
+    }
+    return grid;
+}
+
+int FontOCR::BackgroundLevel() const {
+    // Median level; text covers far less than half of any area read
+    int histogram[256] = {};
+    for (int v = 0; v < levels.rows; v++) {
+        const uchar* row = levels.ptr<uchar>(v);
+        for (int u = 0; u < levels.cols; u++) {
+            histogram[row[u]]++;
+        }
+    }
+    
+    const int half = static_cast<int>(levels.total() / 2);
+    int count = 0;
+    for (int level = 0; level < 256; level++) {
+        count += histogram[level];
+        if (count > half) return level;
+    }
+    return 0;
+}
+
+bool FontOCR::FindInk(int top, int background) {
+    const int width = levels.cols;
+    columns.assign(width + GLYPH_SIZE, 0);
+    
+    int peak = 0;
+    for (int r = 0; r < GLYPH_SIZE; r++) {
+        const uchar* row = levels.ptr<uchar>(top + r);
+        peak = std::max(peak, static_cast<int>(*std::max_element(row, row + width)));
+    }
+    if (peak < background + minContrast) return false;
+    
+    // Above the background and above the shadows of the brightest text
+    const int threshold = std::max(background + minContrast, static_cast<int>(peak * PEAK_SHARE) + 1);
+    for (int r = 0; r < GLYPH_SIZE; r++) {
+        const uchar* row = levels.ptr<uchar>(top + r);
+        for (int u = 0; u < width; u++) {
+            if (row[u] >= threshold) columns[u] |= static_cast<uint8_t>(1 << r);
+        }
+    }
+    return true;
+}
+
+void FontOCR::ReadRow(int top, int background, cv::Point gridOrigin, int scale, Line& line) {
+    line.text.clear();
+    line.characters.clear();
+    line.bounds = cv::Rect();
+    line.pixels = 0;
+    line.errors = 0;
+    
+    if (!FindInk(top, background)) return;
+    
+    const int width = levels.cols;
+    const int y = (gridOrigin.y + top) * scale;
+    int cursor = -1; // Column the next character starts at when no space follows
+    int x = 0;
+    while (true) {
+        while (x < width && !columns[x]) x++;
+        if (x >= width) break;
+        
+        uint64_t window = 0;
+        std::memcpy(&window, &columns[x], sizeof(window));
+        int errors = 0;
+        int index = MatchGlyph(window, errors);
+        
+        if (index < 0) {
+            // Ink no glyph fits, such as an icon, is passed over to the next
+            // empty column
+            for (; x < width && columns[x]; x++) {
+                line.errors += PopCount(columns[x]);
+            }
+            cursor = x + 1;
+            continue;
+        }
+        
+        const Glyph& glyph = glyphs[index];
+        int origin = x - glyph.leading;
+        if (cursor >= 0) {
+            int spaces = (origin - cursor + SPACE_ADVANCE / 2) / SPACE_ADVANCE;
+            for (int s = 0; s < spaces; s++) {
+                Character space;
+                space.bounds = cv::Rect((gridOrigin.x + cursor + s * SPACE_ADVANCE) * scale, y,
+                                        SPACE_ADVANCE * scale, GLYPH_SIZE * scale);
+                line.characters.push_back(space);
+                line.text += ' ';
+            }
+        }
+        
+        Character character;
+        character.code = glyph.code;
+        character.bounds = cv::Rect((gridOrigin.x + x) * scale, y, glyph.width * scale, GLYPH_SIZE * scale);
+        character.errors = errors;
+        line.characters.push_back(character);
+        line.text += glyph.code;
+        line.pixels += glyph.pixels;
+        line.errors += errors;
+        
+        cursor = origin + glyph.advance;
+        x += glyph.width;
+    }
+    
+    if (!line.characters.empty()) {
+        line.bounds = line.characters.front().bounds | line.characters.back().bounds;
+    }
+}
+
+int FontOCR::MatchGlyph(uint64_t window, int& errors) const {
+    // Exact matches first: the window masked to a glyph's columns equals its
+    // bits. A glyph with an empty column inside also matches the narrower
+    // one it starts with, so the widest match wins.
+    const int count = static_cast<int>(glyphBits.size());
+    int best = -1;
+    auto consider = [this, &best](int index) {
+        if (best < 0 || glyphs[index].width > glyphs[best].width) best = index;
+    };
+    
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i wide = _mm256_set1_epi64x(static_cast<long long>(window));
+    for (; i + 4 <= count; i += 4) {
+        __m256i masks = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&glyphMasks[i]));
+        __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&glyphBits[i]));
+        __m256i equal = _mm256_cmpeq_epi64(_mm256_and_si256(wide, masks), bits);
+        int hits = _mm256_movemask_pd(_mm256_castsi256_pd(equal));
+        for (int k = 0; hits != 0; k++, hits >>= 1) {
+            if (hits & 1) consider(i + k);
+        }
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    // No 64-bit compare before SSE4.1; both 32-bit halves of a glyph must agree
+    const __m128i wide = _mm_set1_epi64x(static_cast<long long>(window));
+    for (; i + 2 <= count; i += 2) {
+        __m128i masks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&glyphMasks[i]));
+        __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&glyphBits[i]));
+        __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(wide, masks), bits);
+        int hits = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        if ((hits & 0x3) == 0x3) consider(i);
+        if ((hits & 0xC) == 0xC) consider(i + 1);
+    }
+#endif
+    
+    for (; i < count; i++) {
+        if ((window & glyphMasks[i]) == glyphBits[i]) consider(i);
+    }
+    
+    errors = 0;
+    if (best >= 0) return best;
+    
+    // Otherwise the glyph differing in the fewest pixels, if only a few and
+    // not a large part of it
+    int fewest = maxErrors + 1;
+    for (size_t g = 0; g < glyphs.size(); g++) {
+        int differing = PopCount((window & glyphMasks[g]) ^ glyphBits[g]);
+        if (differing * 4 > glyphs[g].pixels) continue;
+        
+        if (differing < fewest || (differing == fewest && best >= 0 && glyphs[g].width > glyphs[best].width)) {
+            fewest = differing;
+            best = static_cast<int>(g);
+        }
+    }
+    
+    if (best >= 0) errors = fewest;
+    return best;
+}
+
+int RunFontOCRBenchmark(const std::string& fontPath, int lineCount) {
+    FontOCR ocr;
+    AtlasFont atlas;
+    if (!ocr.LoadFont(fontPath) || !LoadAtlasFont(fontPath, atlas)) {
+        std::cerr << "Could not load a font atlas from " << fontPath << std::endl;
+        return 1;
+    }
+    
+    std::mt19937 random(BENCH_SEED);
+    std::uniform_int_distribution<int> scales(1, BENCH_MAX_SCALE);
+    std::uniform_int_distribution<int> offsets(1, 8);
+    std::uniform_int_distribution<int> colors(0, static_cast<int>(sizeof(BENCH_COLORS) / sizeof(BENCH_COLORS[0])) - 1);
+    std::uniform_int_distribution<int> coin(0, 1);
+    
+    // Wide enough for the longest line at the largest scale
+    const int margin = 2 * FontOCR::GLYPH_SIZE * BENCH_MAX_SCALE;
+    cv::Mat frame((FontOCR::GLYPH_SIZE + 4) * BENCH_MAX_SCALE, BENCH_MAX_LENGTH * FontOCR::GLYPH_SIZE * BENCH_MAX_SCALE + margin,
+                  CV_8UC3);
+    
+    LatencyHistogram foundTime;
+    LatencyHistogram knownTime;
+    std::chrono::duration<double, std::micro> foundTotal(0.0);
+    std::chrono::duration<double, std::micro> knownTotal(0.0);
+    int characters = 0;
+    int wrongCharacters = 0;
+    int exactLines = 0;
+    int placedLines = 0;
+    int mixedLines = 0;
+    int mixedCharacters = 0;
+    int mixedWrong = 0;
+    
+    for (int n = 0; n < lineCount; n++) {
+        int scale = scales(random);
+        std::string text = RandomText(random);
+        cv::Point origin(scale * offsets(random), scale * (1 + offsets(random) / 4));
+        
+        // Half of the lines change color part way, like a chat name before
+        // its message; a dark gray part is read against the peak of the
+        // brighter one
+        cv::Scalar first = BENCH_COLORS[colors(random)];
+        cv::Scalar second = first;
+        size_t split = text.size();
+        bool mixed = text.size() > 1 && coin(random) == 1;
+        if (mixed) {
+            split = std::uniform_int_distribution<size_t>(1, text.size() - 1)(random);
+            second = coin(random) == 1 ? BENCH_DARK_GRAY : BENCH_COLORS[colors(random)];
+        }
+        std::string parts[2] = { text.substr(0, split), text.substr(split) };
+        cv::Scalar partColors[2] = { first, second };
+        cv::Point partOrigins[2] = { origin, origin + cv::Point(AtlasTextWidth(atlas, parts[0]) * scale, 0) };
+        
+        int noise = second == BENCH_DARK_GRAY ? BENCH_DIM_NOISE : BENCH_NOISE;
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(noise));
+        
+        // Shadows first, the color at a quarter of its level one GUI pixel down and right
+        if (coin(random) == 1) {
+            for (int p = 0; p < 2; p++) {
+                const cv::Scalar& color = partColors[p];
+                cv::Scalar shade(std::floor(color[0] / 4), std::floor(color[1] / 4), std::floor(color[2] / 4));
+                RenderAtlasText(frame, atlas, parts[p], partOrigins[p] + cv::Point(scale, scale), scale, shade);
+            }
+        }
+        for (int p = 0; p < 2; p++) {
+            RenderAtlasText(frame, atlas, parts[p], partOrigins[p], scale, partColors[p]);
+        }
+        
+        // The area around the line, off the GUI grid like a fixed HUD box
+        const int textWidth = AtlasTextWidth(atlas, text);
+        cv::Rect area(origin.x - scale - scale / 2, origin.y - scale - scale / 2,
+                      (textWidth + 3) * scale, (FontOCR::GLYPH_SIZE + 3) * scale);
+        
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<FontOCR::Line>& lines = ocr.ReadLines(frame, area, scale);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        foundTime.Record(elapsed);
+        foundTotal += elapsed;
+        
+        FontOCR::Line known;
+        start = std::chrono::steady_clock::now();
+        ocr.ReadLine(frame, origin, textWidth * scale, scale, known);
+        elapsed = std::chrono::steady_clock::now() - start;
+        knownTime.Record(elapsed);
+        knownTotal += elapsed;
+        
+        std::string read;
+        for (const auto& line : lines) {
+            read += line.text;
+        }
+        int wrong = std::min(static_cast<int>(text.size()), EditDistance(text, read));
+        characters += static_cast<int>(text.size());
+        wrongCharacters += wrong;
+        if (mixed) {
+            mixedLines++;
+            mixedCharacters += static_cast<int>(text.size());
+            mixedWrong += wrong;
+        }
+        if (lines.size() != 1 || lines[0].text != text) continue;
+        exactLines++;
+        
+        // Every character in its own cell of the line as it was drawn
+        bool placed = true;
+        for (size_t i = 0; i < text.size(); i++) {
+            const cv::Rect& bounds = lines[0].characters[i].bounds;
+            int cell = origin.x + AtlasTextWidth(atlas, text.substr(0, i)) * scale;
+            placed &= bounds.y == origin.y && bounds.x >= cell &&
+                      bounds.x < cell + FontOCR::GLYPH_SIZE * scale;
+        }
+        if (placed) placedLines++;
+    }
+    
+    if (lineCount <= 0 || characters == 0) {
+        std::cout << "No lines rendered" << std::endl;
+        return 1;
+    }
+    
+    double accuracy = 1.0 - static_cast<double>(wrongCharacters) / characters;
+    std::cout << "=== Font OCR (" << lineCount << " lines, GUI scales 1-" << BENCH_MAX_SCALE << ") ===" << std::endl;
+    std::cout << "characters: " << 100.0 * accuracy << "% correct (" << wrongCharacters << " of " << characters
+             << " wrong)" << std::endl;
+    std::cout << "mixed-color lines: " << (mixedCharacters > 0 ? 100.0 * (1.0 - static_cast<double>(mixedWrong) / mixedCharacters) : 0.0)
+             << "% of characters correct (" << mixedLines << " lines)" << std::endl;
+    std::cout << "lines: " << 100.0 * exactLines / lineCount << "% exact, " << 100.0 * placedLines / lineCount
+             << "% with every character in place" << std::endl;
+    std::cout << "found lines: " << foundTotal.count() / lineCount << " us/line (p99 "
+             << 1000.0 * foundTime.GetPercentile(99.0) << " us)" << std::endl;
+    std::cout << "known origin: " << knownTotal.count() / lineCount << " us/line (p99 "
+             << 1000.0 * knownTime.GetPercentile(99.0) << " us)" << std::endl;
+    
+    if (accuracy < MIN_BENCH_ACCURACY) {
+        std::cout << "FAILED: below " << 100.0 * MIN_BENCH_ACCURACY << "% of characters" << std::endl;
+        return 1;
+    }
+    return 0;
+}
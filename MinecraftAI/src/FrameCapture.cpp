@@ -0,0 +1,231 @@
+#include "MinecraftAI.h"
+
+// FrameCaptureThread Implementation
+FrameCaptureThread::FrameCaptureThread(FrameSource* frameSource, int intervalMs)
+    : source(frameSource), captureInterval(std::max(0, intervalMs)) {}
+
+FrameCaptureThread::~FrameCaptureThread() {
+    Stop();
+}
+
+void FrameCaptureThread::Start() {
+    if (running || !source) return;
+    
+    running = true;
+    worker = std::thread(&FrameCaptureThread::CaptureLoop, this);
+}
+
+void FrameCaptureThread::Stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool FrameCaptureThread::WaitForFirstFrame(int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    
+    while (publishedFrames == 0) {
+        if (!running || std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    return true;
+}
+
+const CapturedFrame* FrameCaptureThread::Latest() {
+    frames.Update();
+    
+    const CapturedFrame& frame = frames.ReadSlot();
+    return frame.sequence != 0 ? &frame : nullptr;
+}
+
+void FrameCaptureThread::SetRegions(const std::vector<CaptureRegion>& regions) {
+    std::lock_guard<std::mutex> lock(regionMutex);
+    requestedRegions = regions;
+    regionsChanged = true;
+}
+
+void FrameCaptureThread::ApplyRegionChanges() {
+    std::vector<CaptureRegion> regions;
+    {
+        std::lock_guard<std::mutex> lock(regionMutex);
+        regions = requestedRegions;
+        regionsChanged = false;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    schedule.clear();
+    
+    for (const auto& region : regions) {
+        if (region.rect.empty()) continue;
+        
+        ScheduledRegion scheduled;
+        scheduled.state.rect = region.rect;
+        scheduled.interval = std::chrono::milliseconds(std::max(0, region.intervalMs));
+        scheduled.due = now; // New regions are captured right away
+        schedule.push_back(scheduled);
+    }
+}
+
+void FrameCaptureThread::CaptureLoop() {
+    auto nextCapture = std::chrono::steady_clock::now();
+    cv::Mat grabbed;
+    
+    while (running) {
+        if (regionsChanged) {
+            ApplyRegionChanges();
+        }
+        
+        bool captured = schedule.empty() ? CaptureFull(grabbed) : CaptureScheduledRegions();
+        if (!captured) {
+            if (source->IsFinished()) break;
+            
+            failedGrabs++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        
+        if (captureInterval.count() > 0) {
+            nextCapture += captureInterval;
+            auto now = std::chrono::steady_clock::now();
+            if (nextCapture < now) {
+                nextCapture = now; // Fell behind, don't try to catch up with a burst
+            }
+            std::this_thread::sleep_until(nextCapture);
+        }
+    }
+    
+    running = false;
+}
+
+bool FrameCaptureThread::CaptureFull(cv::Mat& grabbed) {
+    if (!source->Grab(grabbed)) return false;
+    
+    // Leaving partial mode, the composite goes stale from here on
+    composite.release();
+    
+    auto captureTime = std::chrono::steady_clock::now();
+    CapturedFrame& slot = frames.WriteSlot();
+    
+    // Never overwrite pixels a consumer still holds a reference to; detach
+    // the slot from that buffer instead and let copyTo allocate a fresh one
+    if (slot.image.u && CV_XADD(&slot.image.u->refcount, 0) > 1) {
+        slot.image.release();
+    }
+    
+    // Source views are only valid until the next grab, so copy into the slot
+    // (copyTo reuses the slot's buffer when size and type match)
+    grabbed.copyTo(slot.image);
+    slot.sequence = nextSequence++;
+    slot.captureTime = captureTime;
+    slot.windowRect = source->GetLastCaptureRect();
+    slot.regions.clear();
+    slot.fullRefreshVersion = 0;
+    
+    frames.Publish();
+    publishedFrames++;
+    capturedPixels += grabbed.total();
+    return true;
+}
+
+bool FrameCaptureThread::CaptureScheduledRegions() {
+    auto now = std::chrono::steady_clock::now();
+    
+    std::vector<cv::Rect> dueRegions;
+    for (const auto& region : schedule) {
+        if (now >= region.due) {
+            dueRegions.push_back(region.state.rect);
+        }
+    }
+    
+    if (dueRegions.empty()) return true; // Nothing due, no new frame
+    
+    // A region inside another due region is refreshed along with it
+    for (size_t i = 0; i < dueRegions.size();) {
+        bool contained = false;
+        for (size_t j = 0; j < dueRegions.size() && !contained; j++) {
+            contained = i != j && (dueRegions[i] & dueRegions[j]) == dueRegions[i] &&
+                       (dueRegions[i] != dueRegions[j] || j < i);
+        }
+        
+        if (contained) {
+            dueRegions.erase(dueRegions.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    
+    bool fullRefresh = false;
+    if (!source->GrabRegions(dueRegions, composite, fullRefresh)) return false;
+    
+    auto captureTime = std::chrono::steady_clock::now();
+    uint64_t sequence = nextSequence++;
+    
+    if (fullRefresh) {
+        fullRefreshVersion = nextVersion++;
+        capturedPixels += composite.total();
+    } else {
+        for (const auto& rect : dueRegions) {
+            capturedPixels += rect.area();
+        }
+    }
+    
+    for (auto& region : schedule) {
+        if (fullRefresh || now >= region.due) {
+            region.state.version = nextVersion++;
+            region.state.sequence = sequence;
+            region.due = now + region.interval;
+        }
+    }
+    
+    CapturedFrame& slot = frames.WriteSlot();
+    UpdateSlot(slot);
+    slot.sequence = sequence;
+    slot.captureTime = captureTime;
+    slot.windowRect = source->GetLastCaptureRect();
+    
+    frames.Publish();
+    publishedFrames++;
+    return true;
+}
+
+void FrameCaptureThread::UpdateSlot(CapturedFrame& slot) {
+    // Same rule as full captures: pixels a consumer still holds stay untouched
+    if (slot.image.u && CV_XADD(&slot.image.u->refcount, 0) > 1) {
+        slot.image.release();
+    }
+    
+    bool stale = slot.image.size() != composite.size() || slot.image.type() != composite.type() ||
+                 slot.fullRefreshVersion != fullRefreshVersion || slot.regions.size() != schedule.size();
+    for (size_t i = 0; i < schedule.size() && !stale; i++) {
+        stale = slot.regions[i].rect != schedule[i].state.rect;
+    }
+    
+    if (stale) {
+        // The slot missed a full refresh or the schedule changed, copy everything
+        composite.copyTo(slot.image);
+        slot.regions.resize(schedule.size());
+        for (size_t i = 0; i < schedule.size(); i++) {
+            slot.regions[i] = schedule[i].state;
+        }
+        slot.fullRefreshVersion = fullRefreshVersion;
+        return;
+    }
+    
+    // The slot was last written up to two captures ago; bring over every
+    // region refreshed since then, not only the ones grabbed just now
+    cv::Rect bounds(0, 0, composite.cols, composite.rows);
+    for (size_t i = 0; i < schedule.size(); i++) {
+        const CapturedRegion& current = schedule[i].state;
+        if (slot.regions[i].version == current.version) continue;
+        
+        cv::Rect rect = current.rect & bounds;
+        if (!rect.empty()) {
+            composite(rect).copyTo(slot.image(rect));
+        }
+        slot.regions[i] = current;
+    }
+}
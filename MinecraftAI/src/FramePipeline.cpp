@@ -0,0 +1,336 @@
+#include "MinecraftAI.h"
+
+struct FramePipeline::Stage {
+    std::string name;
+    StageFunction function;
+    size_t queueCapacity = 0;
+    Backpressure backpressure = Backpressure::DROP_OLDEST;
+    std::unique_ptr<HandoffQueue<PipelineFrame>> input; // Null for the source
+    std::thread thread;
+    
+    // Wakes the stage for a new input frame or, under BLOCK, for room in the
+    // queue of the next stage
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    uint64_t wakeEpoch = 0;
+    
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> busyMicros{0};
+    std::atomic<uint64_t> queueSamples{0};
+    std::atomic<uint64_t> queueTotal{0};
+    LatencyHistogram time;
+    
+    uint64_t Epoch() {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        return wakeEpoch;
+    }
+    
+    void Wake() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeEpoch++;
+        }
+        wake.notify_one();
+    }
+    
+    // Until Wake() after the epoch was read as seen, or the pipeline stops
+    void Wait(uint64_t seen, const std::atomic<bool>& running) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS),
+                      [&] { return wakeEpoch != seen || !running; });
+    }
+};
+
+// FramePipeline Implementation
+FramePipeline::FramePipeline() = default;
+
+FramePipeline::~FramePipeline() {
+    Stop();
+}
+
+void FramePipeline::AddStage(const std::string& name, StageFunction function, size_t queueCapacity,
+                             Backpressure backpressure) {
+    if (running) throw std::runtime_error("AddStage on running FramePipeline");
+    
+    auto stage = std::make_unique<Stage>();
+    stage->name = name;
+    stage->function = std::move(function);
+    stage->queueCapacity = queueCapacity;
+    stage->backpressure = backpressure;
+    stages.push_back(std::move(stage));
+}
+
+void FramePipeline::Start() {
+    if (running || stages.empty()) return;
+    
+    // Every run starts with empty queues and fresh counters
+    for (size_t i = 0; i < stages.size(); i++) {
+        Stage& stage = *stages[i];
+        if (i > 0) stage.input = std::make_unique<HandoffQueue<PipelineFrame>>(stage.queueCapacity);
+        stage.processed = 0;
+        stage.rejected = 0;
+        stage.dropped = 0;
+        stage.errors = 0;
+        stage.busyMicros = 0;
+        stage.queueSamples = 0;
+        stage.queueTotal = 0;
+        stage.time.Reset();
+    }
+    
+    running = true;
+    startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < stages.size(); i++) {
+        stages[i]->thread = std::thread(&FramePipeline::RunStage, this, i);
+    }
+}
+
+void FramePipeline::Stop() {
+    if (!running.exchange(false)) return;
+    
+    for (auto& stage : stages) {
+        stage->Wake();
+    }
+    for (auto& stage : stages) {
+        if (stage->thread.joinable()) stage->thread.join();
+    }
+    stopTime = std::chrono::steady_clock::now();
+}
+
+void FramePipeline::RunStage(size_t index) {
+    Stage& stage = *stages[index];
+    Stage* next = index + 1 < stages.size() ? stages[index + 1].get() : nullptr;
+    Stage* previous = index > 0 ? stages[index - 1].get() : nullptr;
+    PipelineFrame frame;
+    int consecutiveErrors = 0;
+    
+    while (running) {
+        if (stage.input) {
+            uint64_t seen = stage.Epoch();
+            if (!stage.input->TryPop(frame)) {
+                stage.Wait(seen, running);
+                continue;
+            }
+            
+            // Length including the frame just taken
+            stage.queueSamples++;
+            stage.queueTotal += stage.input->Size() + 1;
+            if (stage.backpressure == Backpressure::BLOCK) previous->Wake();
+        } else {
+            frame = PipelineFrame();
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        bool passed = false;
+        std::exception_ptr error;
+        try {
+            passed = stage.function(frame);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        stage.busyMicros += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        
+        // Frame times of frames passed on only, the source mostly finds none
+        if (passed) stage.time.Record(elapsed);
+        
+        // Outside the timing, handlers may back off
+        if (error) {
+            stage.errors++;
+            consecutiveErrors++;
+            if (errorHandler) errorHandler(stage.name, error, consecutiveErrors);
+        } else {
+            consecutiveErrors = 0;
+        }
+        
+        if (!passed) {
+            if (!error) stage.rejected++;
+            if (!stage.input) std::this_thread::sleep_for(std::chrono::milliseconds(SOURCE_IDLE_MS));
+            continue;
+        }
+        
+        stage.processed++;
+        if (next) PassOn(stage, *next, frame);
+    }
+}
+
+void FramePipeline::PassOn(Stage& stage, Stage& next, PipelineFrame& frame) {
+    using PushResult = HandoffQueue<PipelineFrame>::PushResult;
+    
+    PushResult result;
+    while ((result = next.input->TryPush(frame)) != PushResult::PUSHED) {
+        // The consumer is moving the oldest frame out, its slot is free next
+        if (result == PushResult::BUSY) {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        if (next.backpressure == Backpressure::DROP_OLDEST) {
+            // Nothing is dropped if the consumer made room meanwhile
+            PipelineFrame dropped;
+            if (next.input->DropOldest(dropped)) next.dropped++;
+            continue;
+        }
+        
+        // A pop after the epoch is read wakes this stage
+        uint64_t seen = stage.Epoch();
+        result = next.input->TryPush(frame);
+        if (result == PushResult::PUSHED) break;
+        if (!running) return;
+        if (result == PushResult::FULL) stage.Wait(seen, running);
+    }
+    
+    next.Wake();
+}
+
+std::vector<FramePipeline::StageStats> FramePipeline::GetStats() const {
+    auto end = running ? std::chrono::steady_clock::now() : stopTime;
+    double seconds = std::chrono::duration<double>(end - startTime).count();
+    
+    std::vector<StageStats> stats;
+    for (const auto& stage : stages) {
+        StageStats entry;
+        entry.name = stage->name;
+        entry.processed = stage->processed;
+        entry.rejected = stage->rejected;
+        entry.dropped = stage->dropped;
+        entry.errors = stage->errors;
+        entry.queueCapacity = stage->input ? stage->input->Capacity() : 0;
+        entry.meanMs = stage->time.GetMean();
+        entry.p95Ms = stage->time.GetPercentile(95.0);
+        
+        uint64_t samples = stage->queueSamples;
+        entry.queueFill = samples > 0 ? static_cast<double>(stage->queueTotal) / samples : 0.0;
+        if (seconds > 0.0) {
+            entry.framesPerSecond = entry.processed / seconds;
+            entry.busy = stage->busyMicros / 1e6 / seconds;
+        }
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+void FramePipeline::PrintReport() const {
+    std::vector<StageStats> stats = GetStats();
+    if (stats.empty()) return;
+    
+    std::cout << "=== Frame pipeline ===" << std::endl;
+    size_t bottleneck = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        const StageStats& stage = stats[i];
+        std::cout << stage.name << ": " << stage.framesPerSecond << " frames/s, busy " << 100.0 * stage.busy
+                 << "%, " << stage.meanMs << " ms/frame (p95 " << stage.p95Ms << " ms)";
+        if (stage.queueCapacity > 0) {
+            std::cout << ", queue " << stage.queueFill << "/" << stage.queueCapacity << ", "
+                     << stage.dropped << " dropped";
+        }
+        std::cout << ", " << stage.rejected << " skipped";
+        if (stage.errors > 0) std::cout << ", " << stage.errors << " errors";
+        std::cout << std::endl;
+        
+        if (stage.busy > stats[bottleneck].busy) bottleneck = i;
+    }
+    std::cout << "Bottleneck: " << stats[bottleneck].name << " (busy "
+             << 100.0 * stats[bottleneck].busy << "%)" << std::endl;
+}
+
+namespace {
+
+const size_t STRESS_CAPACITIES[] = { 2, 3, 8 };
+
+} // namespace
+
+int RunHandoffQueueStress(int itemCount) {
+    using Item = std::unique_ptr<uint64_t>; // Taken twice, the second taker finds it moved out
+    using PushResult = HandoffQueue<Item>::PushResult;
+    
+    // What one side took: counts per value and items out of order or broken
+    struct Takes {
+        std::vector<uint8_t> seen;
+        uint64_t count = 0;
+        uint64_t last = 0;
+        uint64_t outOfOrder = 0;
+        uint64_t broken = 0;
+        
+        void Add(const Item& item) {
+            count++;
+            if (!item || *item == 0 || *item >= seen.size()) {
+                broken++;
+                return;
+            }
+            if (*item <= last) outOfOrder++;
+            last = *item;
+            seen[*item]++;
+        }
+    };
+    
+    std::cout << "=== Stage queue, drop oldest under contention (" << itemCount << " items) ===" << std::endl;
+    bool passed = itemCount > 0;
+    const uint64_t count = static_cast<uint64_t>(std::max(0, itemCount));
+    
+    for (size_t capacity : STRESS_CAPACITIES) {
+        HandoffQueue<Item> queue(capacity);
+        Takes popped;
+        Takes dropped;
+        popped.seen.assign(count + 1, 0);
+        dropped.seen.assign(count + 1, 0);
+        std::atomic<bool> producing{true};
+        
+        // Once the producer is done, an empty queue stays empty
+        std::thread consumer([&] {
+            Item item;
+            while (true) {
+                bool done = !producing.load(std::memory_order_acquire);
+                if (queue.TryPop(item)) {
+                    popped.Add(item);
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (done) break;
+                std::this_thread::yield();
+            }
+        });
+        
+        // The loop of FramePipeline::PassOn under DROP_OLDEST
+        uint64_t busy = 0;
+        for (uint64_t value = 1; value <= count; value++) {
+            Item item(new uint64_t(value));
+            PushResult result;
+            while ((result = queue.TryPush(item)) != PushResult::PUSHED) {
+                if (result == PushResult::BUSY) {
+                    busy++;
+                    std::this_thread::yield();
+                    continue;
+                }
+                
+                Item oldest;
+                if (queue.DropOldest(oldest)) dropped.Add(oldest);
+            }
+            
+            // Bursts longer than the queue force drops; without the pauses a
+            // single core would run the whole loop before the consumer's turn
+            if (value % (2 * capacity + 1) == 0) std::this_thread::yield();
+        }
+        producing.store(false, std::memory_order_release);
+        consumer.join();
+        
+        uint64_t lost = 0;
+        uint64_t twice = 0;
+        for (uint64_t value = 1; value <= count; value++) {
+            int takes = popped.seen[value] + dropped.seen[value];
+            if (takes == 0) lost++;
+            if (takes > 1) twice++;
+        }
+        uint64_t outOfOrder = popped.outOfOrder + dropped.outOfOrder;
+        uint64_t broken = popped.broken + dropped.broken;
+        
+        bool ok = lost == 0 && twice == 0 && outOfOrder == 0 && broken == 0 && popped.count + dropped.count == count;
+        passed &= ok;
+        std::cout << "capacity " << capacity << ": " << popped.count << " taken, " << dropped.count << " dropped, "
+                 << busy << " busy retries; " << lost << " lost, " << twice << " taken twice, "
+                 << outOfOrder << " out of order, " << broken << " broken - " << (ok ? "PASS" : "FAIL") << std::endl;
+    }
+    return passed ? 0 : 1;
+}
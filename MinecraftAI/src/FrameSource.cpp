@@ -0,0 +1,191 @@
+#include "MinecraftAI.h"
+#include <filesystem>
+
+// FrameSource Implementation
+bool FrameSource::GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh) {
+    cv::Mat grabbed;
+    if (!Grab(grabbed)) return false;
+    
+    fullRefresh = frame.size() != grabbed.size() || frame.type() != grabbed.type();
+    if (fullRefresh) {
+        grabbed.copyTo(frame);
+        return true;
+    }
+    
+    cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    for (const auto& region : regions) {
+        cv::Rect rect = region & bounds;
+        if (!rect.empty()) {
+            grabbed(rect).copyTo(frame(rect));
+        }
+    }
+    
+    return true;
+}
+
+#ifdef _WIN32
+// WindowFrameSource Implementation
+WindowFrameSource::WindowFrameSource(HWND targetWindow, bool captureGameAreaOnly)
+    : window(targetWindow), gameAreaOnly(captureGameAreaOnly) {}
+
+bool WindowFrameSource::Open() {
+    return window != nullptr && IsWindow(window);
+}
+
+bool WindowFrameSource::GetCaptureArea(cv::Rect& area) const {
+    if (!window) return false;
+    
+    RECT windowRect;
+    if (!GetWindowRect(window, &windowRect)) return false;
+    
+    int left = windowRect.left;
+    int top = windowRect.top;
+    int width = windowRect.right - windowRect.left;
+    int height = windowRect.bottom - windowRect.top;
+    
+    if (gameAreaOnly) {
+        // Only capture the game area, skip title bar and borders
+        int gameAreaTop = 30; // Skip title bar
+        int gameAreaHeight = height - 60; // Skip title bar and bottom border
+        int gameAreaLeft = 8; // Skip left border
+        int gameAreaWidth = width - 16; // Skip left and right borders
+        
+        // Fall back to the full window if the game area would be out of bounds
+        if (gameAreaTop < height && gameAreaLeft < width &&
+            gameAreaHeight > 0 && gameAreaWidth > 0) {
+            left += gameAreaLeft;
+            top += gameAreaTop;
+            width = gameAreaWidth;
+            height = gameAreaHeight;
+        }
+    }
+    
+    area = cv::Rect(left, top, width, height);
+    return width > 0 && height > 0;
+}
+
+bool WindowFrameSource::Grab(cv::Mat& frame) {
+    cv::Rect area;
+    if (!GetCaptureArea(area)) return false;
+    
+    frame = captureContext.Capture(area.x, area.y, area.width, area.height);
+    lastCaptureRect = area;
+    return !frame.empty();
+}
+
+bool WindowFrameSource::GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh) {
+    cv::Rect area;
+    if (!GetCaptureArea(area)) return false;
+    
+    // Window resized (or first grab): the whole frame has to be refreshed
+    fullRefresh = frame.cols != area.width || frame.rows != area.height || frame.type() != CV_8UC4;
+    if (fullRefresh) {
+        cv::Mat grabbed = captureContext.Capture(area.x, area.y, area.width, area.height);
+        if (grabbed.empty()) return false;
+        
+        grabbed.copyTo(frame);
+        lastCaptureRect = area;
+        return true;
+    }
+    
+    lastCaptureRect = area;
+    return captureContext.CaptureRegions(area.x, area.y, regions, frame);
+}
+#endif
+
+// FileFrameSource Implementation
+FileFrameSource::FileFrameSource(const std::string& path, double fps, bool loop)
+    : sourcePath(path), framesPerSecond(fps), loopPlayback(loop) {}
+
+bool FileFrameSource::Open() {
+    framePaths.clear();
+    nextFrameIndex = 0;
+    finished = false;
+    isVideo = false;
+    
+    if (std::filesystem::is_directory(sourcePath)) {
+        for (const auto& entry : std::filesystem::directory_iterator(sourcePath)) {
+            if (!entry.is_regular_file()) continue;
+            
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".png") {
+                framePaths.push_back(entry.path().string());
+            }
+        }
+        
+        // Frames are replayed in file name order (frame_00001.png, ...)
+        std::sort(framePaths.begin(), framePaths.end());
+        
+        if (framePaths.empty()) {
+            std::cerr << "No PNG frames found in: " << sourcePath << std::endl;
+            return false;
+        }
+    } else {
+        if (!video.open(sourcePath)) {
+            std::cerr << "Failed to open replay video: " << sourcePath << std::endl;
+            return false;
+        }
+        isVideo = true;
+    }
+    
+    nextFrameTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+size_t FileFrameSource::GetFrameCount() const {
+    if (isVideo) {
+        double count = video.get(cv::CAP_PROP_FRAME_COUNT);
+        return count > 0 ? static_cast<size_t>(count) : 0;
+    }
+    return framePaths.size();
+}
+
+bool FileFrameSource::ReadNextImage(cv::Mat& image) {
+    if (isVideo) {
+        if (video.read(image)) return true;
+        if (!loopPlayback) return false;
+        
+        video.set(cv::CAP_PROP_POS_FRAMES, 0);
+        return video.read(image);
+    }
+    
+    if (nextFrameIndex >= framePaths.size()) {
+        if (!loopPlayback || framePaths.empty()) return false;
+        nextFrameIndex = 0;
+    }
+    
+    image = cv::imread(framePaths[nextFrameIndex++], cv::IMREAD_COLOR);
+    return !image.empty();
+}
+
+bool FileFrameSource::Grab(cv::Mat& frame) {
+    if (finished) return false;
+    
+    // Pace playback to the configured frame rate
+    if (framesPerSecond > 0) {
+        std::this_thread::sleep_until(nextFrameTime);
+        auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / framesPerSecond));
+        nextFrameTime = std::max(nextFrameTime + frameInterval,
+                                 std::chrono::steady_clock::now() - frameInterval);
+    }
+    
+    if (!ReadNextImage(decodedFrame)) {
+        finished = true;
+        return false;
+    }
+    
+    // Match the BGRA layout of live window captures
+    if (decodedFrame.channels() == 3) {
+        cv::cvtColor(decodedFrame, outputFrame, cv::COLOR_BGR2BGRA);
+    } else if (decodedFrame.channels() == 1) {
+        cv::cvtColor(decodedFrame, outputFrame, cv::COLOR_GRAY2BGRA);
+    } else {
+        decodedFrame.copyTo(outputFrame);
+    }
+    
+    frame = outputFrame;
+    lastCaptureRect = cv::Rect(0, 0, frame.cols, frame.rows);
+    return true;
+}
@@ -0,0 +1,487 @@
+#include "MinecraftAI.h"
+
+namespace {
+
+const int ORIENTATION_BINS = 90;        // 2 degree bins over [0, pi)
+const int MIN_FAMILY_SEPARATION = 15;   // Line families at least 30 degrees apart
+const float FAMILY_TOLERANCE = 0.105f;  // About 6 degrees around a family's normal
+const float MIN_PERIOD = 12.0f;         // Block edge spacing searched for, level 0 pixels
+const float MAX_PERIOD = 120.0f;
+const int MIN_EDGE_POINTS = 50;
+const int MAX_LINES = 64;               // Per family, guards degenerate fits
+const int EDGE_SAMPLES = 8;             // Border samples per face edge
+const int TENSOR_WINDOW = 7;            // Structure tensor averaging window
+const float PI_F = static_cast<float>(CV_PI);
+
+// Distance between two angles that are only defined modulo pi
+float AngleDistance(float a, float b) {
+    float d = std::fabs(a - b);
+    return std::min(d, PI_F - d);
+}
+
+// Sub-sample offset of a peak from the parabola through it and its neighbours
+float RefinePeak(float left, float center, float right) {
+    float denominator = left - 2.0f * center + right;
+    if (std::fabs(denominator) < 1e-6f) return 0.0f;
+    return std::max(-0.5f, std::min(0.5f, 0.5f * (left - right) / denominator));
+}
+
+// Point where the lines n(a0).p = d0 and n(a1).p = d1 cross
+bool IntersectLines(float a0, float d0, float a1, float d1, cv::Point2f& point) {
+    float c0 = std::cos(a0), s0 = std::sin(a0);
+    float c1 = std::cos(a1), s1 = std::sin(a1);
+    float det = c0 * s1 - s0 * c1;
+    if (std::fabs(det) < 1e-3f) return false;
+    
+    point.x = (d0 * s1 - s0 * d1) / det;
+    point.y = (c0 * d1 - d0 * c1) / det;
+    return true;
+}
+
+} // namespace
+
+// GridBlockDetector Implementation
+GridBlockDetector::GridBlockDetector(int level)
+    : pyramidLevel(std::max(0, std::min(level, FrameContext::MAX_LEVELS - 1))) {}
+
+std::vector<GridBlockDetector::BlockFace> GridBlockDetector::Detect(const FrameContext& context,
+                                                                  const cv::Rect& roi, cv::Point2f crosshair) {
+    std::vector<BlockFace> faces;
+    lastFit = GridFit();
+    
+    const cv::Mat& gray = context.GetGray(pyramidLevel);
+    if (gray.empty() || roi.empty()) return faces;
+    
+    const float scale = static_cast<float>(1 << pyramidLevel);
+    cv::Rect levelRoi(cvFloor(roi.x / scale), cvFloor(roi.y / scale),
+                      cvCeil(roi.width / scale), cvCeil(roi.height / scale));
+    levelRoi &= cv::Rect(0, 0, gray.cols, gray.rows);
+    if (levelRoi.width < 16 || levelRoi.height < 16) return faces;
+    
+    // Crosshair in ROI coordinates of this level, the lattice is anchored there
+    cv::Point2f origin(crosshair.x / scale - levelRoi.x, crosshair.y / scale - levelRoi.y);
+    
+    cv::Sobel(gray(levelRoi), gradX, CV_32F, 1, 0, 3);
+    cv::Sobel(gray(levelRoi), gradY, CV_32F, 0, 1, 3);
+    cv::magnitude(gradX, gradY, magnitude);
+    
+    // Orientation from the locally averaged structure tensor. Per pixel Sobel
+    // angles of aliased (stair-stepped) block edges snap to the image axes.
+    cv::multiply(gradX, gradX, tensorXX);
+    cv::multiply(gradX, gradY, tensorXY);
+    cv::multiply(gradY, gradY, tensorYY);
+    cv::boxFilter(tensorXX, tensorXX, -1, cv::Size(TENSOR_WINDOW, TENSOR_WINDOW));
+    cv::boxFilter(tensorXY, tensorXY, -1, cv::Size(TENSOR_WINDOW, TENSOR_WINDOW));
+    cv::boxFilter(tensorYY, tensorYY, -1, cv::Size(TENSOR_WINDOW, TENSOR_WINDOW));
+    
+    // Edge threshold follows the view's contrast, with a floor for flat views
+    float edgeThreshold = std::max(60.0f, static_cast<float>(cv::mean(magnitude)[0] * 2.0));
+    
+    // Magnitude weighted histogram of edge normals, folded to [0, pi)
+    histogram.assign(ORIENTATION_BINS, 0.0f);
+    edgePoints.clear();
+    for (int y = 0; y < magnitude.rows; y++) {
+        const float* mag = magnitude.ptr<float>(y);
+        const float* jxx = tensorXX.ptr<float>(y);
+        const float* jxy = tensorXY.ptr<float>(y);
+        const float* jyy = tensorYY.ptr<float>(y);
+        for (int x = 0; x < magnitude.cols; x++) {
+            if (mag[x] < edgeThreshold) continue;
+            
+            float angle = 0.5f * std::atan2(2.0f * jxy[x], jxx[x] - jyy[x]);
+            if (angle < 0.0f) angle += PI_F;
+            int bin = std::min(static_cast<int>(angle * ORIENTATION_BINS / PI_F), ORIENTATION_BINS - 1);
+            histogram[bin] += mag[x];
+            edgePoints.push_back({ static_cast<float>(x), static_cast<float>(y), angle, mag[x] });
+        }
+    }
+    
+    if (static_cast<int>(edgePoints.size()) < MIN_EDGE_POINTS) return faces;
+    
+    // Circular [1 2 1] smoothing, block edges rarely fall into a single bin
+    std::vector<float> smoothed(ORIENTATION_BINS);
+    for (int i = 0; i < ORIENTATION_BINS; i++) {
+        smoothed[i] = histogram[(i + ORIENTATION_BINS - 1) % ORIENTATION_BINS] +
+                      2.0f * histogram[i] +
+                      histogram[(i + 1) % ORIENTATION_BINS];
+    }
+    
+    // Two dominant orientations: the strongest bin, then the strongest one
+    // far enough from it to be a different line family
+    int peaks[2] = { 0, -1 };
+    for (int i = 1; i < ORIENTATION_BINS; i++) {
+        if (smoothed[i] > smoothed[peaks[0]]) peaks[0] = i;
+    }
+    for (int i = 0; i < ORIENTATION_BINS; i++) {
+        int distance = std::abs(i - peaks[0]);
+        distance = std::min(distance, ORIENTATION_BINS - distance);
+        if (distance < MIN_FAMILY_SEPARATION) continue;
+        if (peaks[1] < 0 || smoothed[i] > smoothed[peaks[1]]) peaks[1] = i;
+    }
+    
+    if (peaks[1] < 0 || smoothed[peaks[1]] < 0.15f * smoothed[peaks[0]]) return faces;
+    
+    float normalAngle[2];
+    float period[2];
+    float phase[2];
+    float maxDistance = std::sqrt(static_cast<float>(levelRoi.width * levelRoi.width +
+                                                     levelRoi.height * levelRoi.height)) +
+                        static_cast<float>(cv::norm(origin));
+    
+    for (int k = 0; k < 2; k++) {
+        int bin = peaks[k];
+        float offset = RefinePeak(smoothed[(bin + ORIENTATION_BINS - 1) % ORIENTATION_BINS], smoothed[bin],
+                                  smoothed[(bin + 1) % ORIENTATION_BINS]);
+        normalAngle[k] = (bin + 0.5f + offset) * PI_F / ORIENTATION_BINS;
+        
+        if (!FitFamily(normalAngle[k], origin, maxDistance, period[k], phase[k])) return faces;
+    }
+    
+    lastFit.valid = true;
+    for (int k = 0; k < 2; k++) {
+        lastFit.normalAngle[k] = normalAngle[k];
+        lastFit.period[k] = period[k] * scale;
+        lastFit.phase[k] = phase[k] * scale;
+    }
+    
+    // Range of line indices whose lines pass through the ROI
+    int firstLine[2];
+    int lastLine[2];
+    for (int k = 0; k < 2; k++) {
+        float c = std::cos(normalAngle[k]), s = std::sin(normalAngle[k]);
+        float minD = std::numeric_limits<float>::max();
+        float maxD = std::numeric_limits<float>::lowest();
+        const cv::Point2f roiCorners[4] = {
+            cv::Point2f(0.0f, 0.0f), cv::Point2f(static_cast<float>(levelRoi.width), 0.0f),
+            cv::Point2f(0.0f, static_cast<float>(levelRoi.height)),
+            cv::Point2f(static_cast<float>(levelRoi.width), static_cast<float>(levelRoi.height))
+        };
+        for (const auto& corner : roiCorners) {
+            float d = (corner.x - origin.x) * c + (corner.y - origin.y) * s;
+            minD = std::min(minD, d);
+            maxD = std::max(maxD, d);
+        }
+        
+        firstLine[k] = cvFloor((minD - phase[k]) / period[k]);
+        lastLine[k] = cvCeil((maxD - phase[k]) / period[k]);
+        if (lastLine[k] - firstLine[k] > MAX_LINES) return faces;
+    }
+    
+    // Every lattice cell inside the ROI whose four borders sit on edges is a face
+    cv::Rect2f bounds(0.0f, 0.0f, static_cast<float>(levelRoi.width - 1), static_cast<float>(levelRoi.height - 1));
+    for (int i = firstLine[0]; i < lastLine[0]; i++) {
+        for (int j = firstLine[1]; j < lastLine[1]; j++) {
+            const int steps[4][2] = { {0, 0}, {1, 0}, {1, 1}, {0, 1} };
+            cv::Point2f corners[4];
+            bool inside = true;
+            
+            for (int c = 0; c < 4 && inside; c++) {
+                float d0 = phase[0] + (i + steps[c][0]) * period[0];
+                float d1 = phase[1] + (j + steps[c][1]) * period[1];
+                inside = IntersectLines(normalAngle[0], d0, normalAngle[1], d1, corners[c]);
+                corners[c] += origin;
+                inside = inside && bounds.contains(corners[c]);
+            }
+            if (!inside) continue;
+            
+            float score = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                score += ScoreEdge(corners[c], corners[(c + 1) % 4], edgeThreshold);
+            }
+            score /= 4.0f;
+            if (score < minScore) continue;
+            
+            BlockFace face;
+            float minX = std::numeric_limits<float>::max(), minY = minX;
+            float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+            for (int c = 0; c < 4; c++) {
+                face.corners[c] = cv::Point2f((corners[c].x + levelRoi.x) * scale, (corners[c].y + levelRoi.y) * scale);
+                minX = std::min(minX, face.corners[c].x);
+                minY = std::min(minY, face.corners[c].y);
+                maxX = std::max(maxX, face.corners[c].x);
+                maxY = std::max(maxY, face.corners[c].y);
+            }
+            face.bounds = cv::Rect(cvFloor(minX), cvFloor(minY), cvCeil(maxX - minX), cvCeil(maxY - minY));
+            face.score = score;
+            faces.push_back(face);
+        }
+    }
+    
+    // Sort faces by proximity to the crosshair (the block the bot would mine first)
+    auto faceDistance = [&crosshair](const BlockFace& face) {
+        cv::Point2f center = (face.corners[0] + face.corners[1] + face.corners[2] + face.corners[3]) * 0.25f;
+        return cv::norm(center - crosshair);
+    };
+    std::sort(faces.begin(), faces.end(), [&faceDistance](const BlockFace& a, const BlockFace& b) {
+        return faceDistance(a) < faceDistance(b);
+    });
+    
+    if (faces.size() > MAX_FACES) {
+        faces.resize(MAX_FACES);
+    }
+    
+    return faces;
+}
+
+bool GridBlockDetector::FitFamily(float normalAngle, cv::Point2f origin, float maxDistance,
+                                  float& period, float& phase) {
+    const float scale = static_cast<float>(1 << pyramidLevel);
+    const int minLag = std::max(2, cvFloor(MIN_PERIOD / scale));
+    const int maxLag = cvCeil(MAX_PERIOD / scale);
+    
+    // Edge strength of this family projected onto its normal, crosshair at offset
+    int offset = cvCeil(maxDistance);
+    profile.assign(2 * offset + 1, 0.0f);
+    
+    float c = std::cos(normalAngle), s = std::sin(normalAngle);
+    for (const auto& point : edgePoints) {
+        if (AngleDistance(point.angle, normalAngle) > FAMILY_TOLERANCE) continue;
+        
+        float d = (point.x - origin.x) * c + (point.y - origin.y) * s;
+        int index = cvRound(d) + offset;
+        if (index >= 0 && index < static_cast<int>(profile.size())) {
+            profile[index] += point.weight;
+        }
+    }
+    
+    int length = static_cast<int>(profile.size());
+    if (length <= maxLag + 1) return false;
+    
+    float mean = 0.0f;
+    for (float value : profile) mean += value;
+    mean /= length;
+    for (float& value : profile) value -= mean;
+    
+    // Autocorrelation over the plausible block sizes
+    correlation.assign(maxLag + 2, 0.0f);
+    float best = 0.0f;
+    for (int lag = minLag - 1; lag <= maxLag + 1; lag++) {
+        float sum = 0.0f;
+        for (int i = 0; i + lag < length; i++) {
+            sum += profile[i] * profile[i + lag];
+        }
+        correlation[lag] = sum / (length - lag);
+        if (lag >= minLag && lag <= maxLag) best = std::max(best, correlation[lag]);
+    }
+    if (best <= 0.0f) return false;
+    
+    // Multiples of the block size correlate almost as well, take the first
+    // local maximum that comes close to the best one
+    int lag = -1;
+    for (int l = minLag; l <= maxLag; l++) {
+        if (correlation[l] >= 0.8f * best &&
+            correlation[l] >= correlation[l - 1] && correlation[l] >= correlation[l + 1]) {
+            lag = l;
+            break;
+        }
+    }
+    if (lag < 0) return false;
+    
+    period = lag + RefinePeak(correlation[lag - 1], correlation[lag], correlation[lag + 1]);
+    
+    // Phase: fold the profile onto one period and take the strongest offset
+    int bins = std::max(1, cvRound(period));
+    folded.assign(bins, 0.0f);
+    for (int i = 0; i < length; i++) {
+        float d = static_cast<float>(i - offset);
+        float wrapped = d - std::floor(d / period) * period;
+        folded[std::min(bins - 1, static_cast<int>(wrapped * bins / period))] += profile[i];
+    }
+    
+    int peak = static_cast<int>(std::max_element(folded.begin(), folded.end()) - folded.begin());
+    float refined = peak + 0.5f + RefinePeak(folded[(peak + bins - 1) % bins], folded[peak],
+                                             folded[(peak + 1) % bins]);
+    phase = refined * period / bins;
+    return true;
+}
+
+float GridBlockDetector::ScoreEdge(cv::Point2f from, cv::Point2f to, float edgeThreshold) const {
+    int hits = 0;
+    for (int i = 0; i < EDGE_SAMPLES; i++) {
+        float t = (i + 0.5f) / EDGE_SAMPLES;
+        int x = cvRound(from.x + (to.x - from.x) * t);
+        int y = cvRound(from.y + (to.y - from.y) * t);
+        
+        // One pixel of slack absorbs the rounding of the fitted lattice
+        bool onEdge = false;
+        for (int dy = -1; dy <= 1 && !onEdge; dy++) {
+            int row = y + dy;
+            if (row < 0 || row >= magnitude.rows) continue;
+            const float* mag = magnitude.ptr<float>(row);
+            for (int dx = -1; dx <= 1; dx++) {
+                int col = x + dx;
+                if (col >= 0 && col < magnitude.cols && mag[col] >= edgeThreshold) {
+                    onEdge = true;
+                    break;
+                }
+            }
+        }
+        if (onEdge) hits++;
+    }
+    
+    return static_cast<float>(hits) / EDGE_SAMPLES;
+}
+
+std::vector<cv::Rect> GridBlockDetector::ToRects(const std::vector<BlockFace>& faces) {
+    std::vector<cv::Rect> rects;
+    rects.reserve(faces.size());
+    for (const auto& face : faces) {
+        rects.push_back(face.bounds);
+    }
+    return rects;
+}
+
+int RunDetectorBenchmark(const std::string& path, int maxFrames) {
+    FileFrameSource source(path, 0.0);
+    if (!source.Open()) {
+        std::cerr << "Could not open frames from " << path << std::endl;
+        return 1;
+    }
+    
+    struct DetectorRun {
+        const char* name;
+        LatencyHistogram time;
+        int found = 0;         // Frames with at least one block
+        int onCrosshair = 0;   // Frames whose first block contains the crosshair (not checked against labels)
+        double jitter = 0.0;   // Movement of the chosen target between frames
+        int jitterSamples = 0;
+        bool hasTarget = false;
+        cv::Point2f lastTarget;
+        cv::Rect target;
+    };
+    
+    DetectorRun runs[2];
+    runs[0].name = "contour";
+    runs[1].name = "grid";
+    
+    ContourBlockDetector contour;
+    GridBlockDetector grid;
+    
+    // The bot's per-frame crosshair path, with the same classifier setup
+    BlockClassifier classifier;
+    classifier.Load("block_colors.lut");
+    CrosshairProbe probe;
+    LatencyHistogram probeTime;
+    int targetChanges = 0;
+    
+    // IdentifyBlockTypes' texture match of the contour blocks, with the cache
+    TextureClassifier textures;
+    textures.LoadAtlas("block_textures");
+    LatencyHistogram textureTime;
+    std::vector<cv::Rect> contourBlocks;
+    uint64_t textureFaces = 0;
+    uint64_t staleHits = 0; // Cached result differs from a fresh match
+    
+    cv::Mat frame;
+    cv::Size frameSize;
+    int frames = 0;
+    int bothOnCrosshair = 0;
+    int agreed = 0;
+    
+    while ((maxFrames <= 0 || frames < maxFrames) && source.Grab(frame)) {
+        if (frame.empty()) continue;
+        frames++;
+        frameSize = frame.size();
+        
+        // Same mining ROI and crosshair as OptimizedMinecraftBot
+        cv::Rect roi(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+        cv::Point2f crosshair(frame.cols / 2.0f, frame.rows / 2.0f);
+        
+        // The bot shares gray images between stages, so they are not charged to a detector
+        FrameContext context(frame, frames);
+        context.GetGray(0);
+        context.GetGray(1);
+        
+        for (int d = 0; d < 2; d++) {
+            DetectorRun& run = runs[d];
+            auto start = std::chrono::steady_clock::now();
+            std::vector<cv::Rect> blocks = d == 0
+                ? contour.Detect(context, roi, crosshair)
+                : GridBlockDetector::ToRects(grid.Detect(context, roi, crosshair));
+            run.time.Record(std::chrono::steady_clock::now() - start);
+            if (d == 0) contourBlocks = blocks;
+            
+            run.target = blocks.empty() ? cv::Rect() : blocks[0];
+            if (blocks.empty()) {
+                run.hasTarget = false;
+                continue;
+            }
+            
+            run.found++;
+            if (run.target.contains(cv::Point(cvRound(crosshair.x), cvRound(crosshair.y)))) run.onCrosshair++;
+            
+            cv::Point2f center(run.target.x + run.target.width / 2.0f, run.target.y + run.target.height / 2.0f);
+            if (run.hasTarget) {
+                run.jitter += cv::norm(center - run.lastTarget);
+                run.jitterSamples++;
+            }
+            run.lastTarget = center;
+            run.hasTarget = true;
+        }
+        
+        auto probeStart = std::chrono::steady_clock::now();
+        if (probe.Update(frame, classifier)) targetChanges++;
+        probeTime.Record(std::chrono::steady_clock::now() - probeStart);
+        
+        if (textures.HasAtlas()) {
+            std::chrono::steady_clock::duration textureCost{};
+            for (const auto& block : contourBlocks) {
+                uint64_t hits = textures.GetCacheHits();
+                auto textureStart = std::chrono::steady_clock::now();
+                TextureClassifier::Match match = textures.Classify(frame, block);
+                textureCost += std::chrono::steady_clock::now() - textureStart;
+                
+                if (textures.GetCacheHits() > hits &&
+                    textures.Classify(frame, block, false).texture != match.texture) {
+                    staleHits++;
+                }
+            }
+            textureTime.Record(textureCost);
+            textureFaces += contourBlocks.size();
+        }
+        
+        // Agreement: both pick a block under the crosshair and the contour
+        // block's center lies inside the grid face
+        cv::Point crosshairPixel(cvRound(crosshair.x), cvRound(crosshair.y));
+        if (runs[0].target.contains(crosshairPixel) && runs[1].target.contains(crosshairPixel)) {
+            bothOnCrosshair++;
+            cv::Point contourCenter(runs[0].target.x + runs[0].target.width / 2,
+                                    runs[0].target.y + runs[0].target.height / 2);
+            if (runs[1].target.contains(contourCenter)) agreed++;
+        }
+    }
+    
+    if (frames == 0) {
+        std::cout << "No frames read from " << path << std::endl;
+        return 1;
+    }
+    
+    std::cout << "=== Block detector benchmark (" << frames << " frames, "
+             << frameSize.width << "x" << frameSize.height << ") ===" << std::endl;
+    
+    for (const auto& run : runs) {
+        std::cout << run.name << ": " << run.time.GetMean() << " ms/frame (p95 "
+                 << run.time.GetPercentile(95.0) << " ms), crosshair detection rate "
+                 << 100.0 * run.onCrosshair / frames << "%, blocks found in "
+                 << 100.0 * run.found / frames << "% of frames, target jitter "
+                 << (run.jitterSamples > 0 ? run.jitter / run.jitterSamples : 0.0) << " px" << std::endl;
+    }
+    
+    std::cout << "Same crosshair block in " << (bothOnCrosshair > 0 ? 100.0 * agreed / bothOnCrosshair : 0.0)
+             << "% of the " << bothOnCrosshair << " frames both detectors found one" << std::endl;
+    std::cout << "(Detection rates only; the frames carry no labels to tell right blocks from wrong ones)" << std::endl;
+    std::cout << "crosshair probe: " << probeTime.GetMean() << " ms/frame (p95 "
+             << probeTime.GetPercentile(95.0) << " ms), " << targetChanges << " target changes" << std::endl;
+    
+    if (textures.HasAtlas()) {
+        uint64_t hits = textures.GetCacheHits();
+        uint64_t lookups = hits + textures.GetCacheMisses();
+        std::cout << "texture match: " << textureTime.GetMean() << " ms/frame (p95 "
+                 << textureTime.GetPercentile(95.0) << " ms) for " << textureFaces << " contour blocks, cache hit rate "
+                 << (lookups > 0 ? 100.0 * hits / lookups : 0.0) << "%, " << staleHits << " of " << hits
+                 << " hits differ from a fresh match" << std::endl;
+    } else {
+        std::cout << "texture match: skipped, no atlas in block_textures" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include "MinecraftAI.h"
+#include <filesystem>
+
+namespace {
+
+const float MIN_LAYOUT_SCORE = 3.0f;    // Slot pattern variance over its noise, see LayoutScore
+const float LAYOUT_NOISE = 4.0f;        // Squared gray levels every sample is allowed to differ by
+const float MIN_SELECTION_CONTRAST = 30.0f;
+const int MIN_OPAQUE_PIXELS = 16;       // Icons with fewer opaque pixels are not matched
+
+float Luma(const cv::Mat& frame, int x, int y) {
+    const uchar* pixel = frame.ptr<uchar>(y) + x * frame.channels();
+    return 0.114f * pixel[0] + 0.587f * pixel[1] + 0.299f * pixel[2];
+}
+
+} // namespace
+
+// HotbarReader Implementation
+bool HotbarReader::LoadIcons(const std::string& directory) {
+    std::error_code error;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!entry.is_regular_file()) continue;
+        
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".png") files.push_back(entry.path());
+    }
+    if (error || files.empty()) return false;
+    std::sort(files.begin(), files.end());
+    
+    std::vector<Icon> loaded;
+    for (const auto& file : files) {
+        cv::Mat image = cv::imread(file.string(), cv::IMREAD_UNCHANGED);
+        if (image.empty() || image.depth() != CV_8U) continue;
+        
+        // Animated items are vertical strips of square frames
+        if (image.rows > image.cols) image = image(cv::Rect(0, 0, image.cols, image.cols));
+        cv::resize(image, image, cv::Size(ICON_SIZE, ICON_SIZE), 0, 0, cv::INTER_NEAREST);
+        
+        Icon icon;
+        icon.name = file.stem().string();
+        if (image.channels() == 4) {
+            cv::cvtColor(image, icon.color, cv::COLOR_BGRA2BGR);
+            cv::extractChannel(image, icon.mask, 3);
+            cv::threshold(icon.mask, icon.mask, 127, 1, cv::THRESH_BINARY);
+        } else if (image.channels() == 3) {
+            icon.color = image;
+            icon.mask = cv::Mat::ones(ICON_SIZE, ICON_SIZE, CV_8U);
+        } else {
+            continue;
+        }
+        
+        icon.opaque = cv::countNonZero(icon.mask);
+        if (icon.opaque >= MIN_OPAQUE_PIXELS) loaded.push_back(std::move(icon));
+    }
+    
+    if (loaded.empty()) {
+        std::cerr << "No readable item icons in " << directory << std::endl;
+        return false;
+    }
+    
+    icons.swap(loaded);
+    for (auto& slot : slots) {
+        slot.hash = 0; // Match every slot again against the new set
+    }
+    return true;
+}
+
+cv::Rect HotbarReader::HotbarBounds(cv::Size frameSize, int scale) {
+    // Minecraft lays the GUI out on the screen divided by the scale, rounded
+    // up, and centers the hotbar at the bottom of it
+    int scaledWidth = (frameSize.width + scale - 1) / scale;
+    int scaledHeight = (frameSize.height + scale - 1) / scale;
+    return cv::Rect((scaledWidth / 2 - WIDTH / 2) * scale, (scaledHeight - HEIGHT) * scale,
+                    WIDTH * scale, HEIGHT * scale);
+}
+
+cv::Rect HotbarReader::GetRegion() const {
+    if (IsLocated()) return bounds;
+    
+    cv::Rect area = HotbarBounds(frameSize, MAX_GUI_SCALE);
+    return area & cv::Rect(0, 0, frameSize.width, frameSize.height);
+}
+
+const std::string& HotbarReader::GetItem(int slot) const {
+    static const std::string none;
+    if (slot < 0 || slot >= SLOTS || slots[slot].item < 0) return none;
+    return icons[slots[slot].item].name;
+}
+
+void HotbarReader::Reset() {
+    guiScale = 0;
+    bounds = cv::Rect();
+    selectedSlot = -1;
+    for (auto& slot : slots) {
+        slot = Slot();
+    }
+}
+
+bool HotbarReader::Update(const cv::Mat& frame) {
+    if (frame.empty() || frame.depth() != CV_8U || (frame.channels() != 3 && frame.channels() != 4)) {
+        return false;
+    }
+    
+    // Located once per resolution; while a menu hides it every call retries
+    if (frame.size() != frameSize) {
+        Reset();
+        frameSize = frame.size();
+    }
+    if (!IsLocated() && !Locate(frame)) return false;
+    
+    int selected = FindSelectedSlot(frame);
+    bool changed = selected != selectedSlot;
+    selectedSlot = selected;
+    
+    // Slots whose icon pixels are unchanged keep their item
+    for (auto& slot : slots) {
+        uint64_t hash = TileChangeMap::HashImage(frame(slot.icon));
+        if (hash == slot.hash) continue;
+        slot.hash = hash;
+        
+        int item = MatchIcon(frame, slot.icon, slot.distance);
+        changed |= item != slot.item;
+        slot.item = item;
+    }
+    return changed;
+}
+
+bool HotbarReader::Locate(const cv::Mat& frame) {
+    cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    int bestScale = 0;
+    float bestScore = MIN_LAYOUT_SCORE;
+    
+    for (int scale = 1; scale <= MAX_GUI_SCALE; scale++) {
+        cv::Rect candidate = HotbarBounds(frame.size(), scale);
+        if ((candidate & frameRect) != candidate) break;
+        
+        float score = LayoutScore(frame, candidate, scale);
+        if (score > bestScore) {
+            bestScore = score;
+            bestScale = scale;
+        }
+    }
+    if (bestScale == 0) return false;
+    
+    guiScale = bestScale;
+    bounds = HotbarBounds(frame.size(), guiScale);
+    for (int i = 0; i < SLOTS; i++) {
+        slots[i] = Slot();
+        slots[i].icon = cv::Rect(bounds.x + (3 + SLOT_SPACING * i) * guiScale, bounds.y + 3 * guiScale,
+                                 ICON_SIZE * guiScale, ICON_SIZE * guiScale);
+    }
+    return true;
+}
+
+float HotbarReader::LayoutScore(const cv::Mat& frame, const cv::Rect& candidate, int scale) const {
+    // The two GUI rows above the icons repeat with the slot spacing whatever
+    // the slots hold; sampled at a wrong scale or on the game view they do not
+    float values[SLOTS][SLOT_SPACING];
+    for (int i = 0; i < SLOTS; i++) {
+        for (int u = 0; u < SLOT_SPACING; u++) {
+            int x = candidate.x + (1 + SLOT_SPACING * i + u) * scale + scale / 2;
+            values[i][u] = 0.5f * (Luma(frame, x, candidate.y + scale + scale / 2) +
+                                   Luma(frame, x, candidate.y + 2 * scale + scale / 2));
+        }
+    }
+    
+    // The selection frame breaks the pattern of one slot, the slot fitting
+    // the others worst is left out
+    float mean[SLOT_SPACING];
+    float error[SLOTS] = {};
+    int skipped = -1;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int u = 0; u < SLOT_SPACING; u++) {
+            float sum = 0.0f;
+            for (int i = 0; i < SLOTS; i++) {
+                if (i != skipped) sum += values[i][u];
+            }
+            mean[u] = sum / (SLOTS - (skipped >= 0 ? 1 : 0));
+        }
+        
+        for (int i = 0; i < SLOTS; i++) {
+            error[i] = 0.0f;
+            for (int u = 0; u < SLOT_SPACING; u++) {
+                error[i] += (values[i][u] - mean[u]) * (values[i][u] - mean[u]);
+            }
+        }
+        if (pass == 0) skipped = static_cast<int>(std::max_element(error, error + SLOTS) - error);
+    }
+    
+    float noise = 0.0f;
+    for (int i = 0; i < SLOTS; i++) {
+        if (i != skipped) noise += error[i];
+    }
+    noise /= (SLOTS - 1) * SLOT_SPACING;
+    
+    float average = 0.0f;
+    for (int u = 0; u < SLOT_SPACING; u++) average += mean[u];
+    average /= SLOT_SPACING;
+    
+    float signal = 0.0f;
+    for (int u = 0; u < SLOT_SPACING; u++) signal += (mean[u] - average) * (mean[u] - average);
+    signal /= SLOT_SPACING;
+    
+    return signal / (noise + LAYOUT_NOISE);
+}
+
+int HotbarReader::FindSelectedSlot(const cv::Mat& frame) const {
+    // The selection frame is drawn over the outer GUI columns of its slot,
+    // which are dark on every other slot
+    float brightness[SLOTS];
+    for (int i = 0; i < SLOTS; i++) {
+        float sum = 0.0f;
+        for (int v = 1; v < HEIGHT - 1; v++) {
+            int y = bounds.y + v * guiScale + guiScale / 2;
+            sum += Luma(frame, bounds.x + SLOT_SPACING * i * guiScale + guiScale / 2, y);
+            sum += Luma(frame, bounds.x + (SLOT_SPACING * i + 21) * guiScale + guiScale / 2, y);
+        }
+        brightness[i] = sum / (2 * (HEIGHT - 2));
+    }
+    
+    float sorted[SLOTS];
+    std::copy(brightness, brightness + SLOTS, sorted);
+    std::nth_element(sorted, sorted + SLOTS / 2, sorted + SLOTS);
+    
+    int brightest = static_cast<int>(std::max_element(brightness, brightness + SLOTS) - brightness);
+    return brightness[brightest] - sorted[SLOTS / 2] >= MIN_SELECTION_CONTRAST ? brightest : -1;
+}
+
+int HotbarReader::MatchIcon(const cv::Mat& frame, const cv::Rect& icon, float& distance) {
+    distance = 0.0f;
+    if (icons.empty()) return -1;
+    
+    // One frame pixel per GUI pixel, taken from its center; the GUI scale is
+    // an integer, so this is the icon as it was drawn
+    sample.create(ICON_SIZE, ICON_SIZE, CV_8UC3);
+    const int channels = frame.channels();
+    for (int v = 0; v < ICON_SIZE; v++) {
+        const uchar* row = frame.ptr<uchar>(icon.y + v * guiScale + guiScale / 2);
+        uchar* out = sample.ptr<uchar>(v);
+        for (int u = 0; u < ICON_SIZE; u++) {
+            const uchar* pixel = row + (icon.x + u * guiScale + guiScale / 2) * channels;
+            out[u * 3] = pixel[0];
+            out[u * 3 + 1] = pixel[1];
+            out[u * 3 + 2] = pixel[2];
+        }
+    }
+    
+    // Mean absolute difference over the opaque pixels of each icon; the slot
+    // background shows through the rest
+    int best = -1;
+    float bestDistance = maxDistance;
+    for (size_t i = 0; i < icons.size(); i++) {
+        const Icon& candidate = icons[i];
+        int sum = 0;
+        for (int v = 0; v < ICON_SIZE; v++) {
+            const uchar* a = sample.ptr<uchar>(v);
+            const uchar* b = candidate.color.ptr<uchar>(v);
+            const uchar* mask = candidate.mask.ptr<uchar>(v);
+            for (int u = 0; u < ICON_SIZE; u++) {
+                if (!mask[u]) continue;
+                sum += std::abs(a[u * 3] - b[u * 3]) + std::abs(a[u * 3 + 1] - b[u * 3 + 1]) +
+                       std::abs(a[u * 3 + 2] - b[u * 3 + 2]);
+            }
+        }
+        
+        float meanDifference = static_cast<float>(sum) / (candidate.opaque * 3);
+        if (meanDifference < bestDistance) {
+            bestDistance = meanDifference;
+            best = static_cast<int>(i);
+        }
+    }
+    
+    distance = bestDistance;
+    return best;
+}
@@ -19,6 +19,7 @@ MinecraftAI::MinecraftAI() {
     // Use optimized bot instead of regular bot
     bot = std::make_unique<OptimizedMinecraftBot>(humanizer.get(), stats.get(), 
                                                   playerDetector.get(), chatHandler.get());
+    bot->SetPerformanceMonitor(perfMonitor.get());
     
     LoadMemoryFromFile();
 }
@@ -29,9 +30,13 @@ MinecraftAI::~MinecraftAI() {
     SaveMemoryToFile();
 }
 
-bool MinecraftAI::Initialize() {
+bool MinecraftAI::Initialize(std::unique_ptr<FrameSource> frameSource) {
     try {
-        if (!bot->FindMinecraftWindow()) {
+        if (frameSource) {
+            // Headless replay, no game window required
+            std::cout << "Using frame source: " << frameSource->GetName() << std::endl;
+            bot->SetFrameSource(std::move(frameSource));
+        } else if (!bot->FindMinecraftWindow()) {
             std::cerr << "Critical Error: Minecraft window not found!" << std::endl;
             std::cerr << "Please ensure Minecraft is running and try again." << std::endl;
             return false;
@@ -93,6 +98,11 @@ void MinecraftAI::Start() {
     paused = false;
     startTime = std::chrono::steady_clock::now();
     
+    // Capture runs on its own thread and feeds the processing stages
+    if (!bot->StartCaptureThread(OptimizedMinecraftBot::CAPTURE_INTERVAL_MS)) {
+        std::cerr << "Warning: capture thread produced no frame yet" << std::endl;
+    }
+    
     std::lock_guard<std::mutex> lock(statsMutex);
     statistics.status = "Running";
     statistics.isPaused = false;
@@ -108,6 +118,9 @@ void MinecraftAI::Stop() {
         mainLoop.join();
     }
     
+    bot->StopCaptureThread();
+    StopRecording();
+    
     std::lock_guard<std::mutex> lock(statsMutex);
     statistics.status = "Stopped";
     statistics.isPaused = false;
@@ -129,94 +142,118 @@ void MinecraftAI::Resume() {
 }
 
 void MinecraftAI::OptimizedMainExecutionLoop() {
-    int consecutiveErrors = 0;
-    const int maxConsecutiveErrors = 5;
+    auto* optimizedBot = dynamic_cast<OptimizedMinecraftBot*>(bot.get());
+    if (!optimizedBot) {
+        MainExecutionLoop();
+        return;
+    }
     
-    while (running) {
-        perfMonitor->FrameStart();
-        
-        try {
-            if (!paused) {
-                // Parallel processing of different components
-                auto gameStateTask = threadPool->enqueue([this] {
-                    ProcessGameState();
-                });
-                
-                auto playerDetectionTask = threadPool->enqueue([this] {
-                    if (config.pauseOnPlayer) {
-                        auto state = bot->GetCurrentState();
-                        if (!state.screenshot.empty()) {
-                            playerDetector->UpdateDetection(state.screenshot);
-                        }
-                    }
-                });
-                
-                auto chatTask = threadPool->enqueue([this] {
-                    if (config.chatResponses) {
-                        auto state = bot->GetCurrentState();
-                        if (!state.screenshot.empty()) {
-                            chatHandler->ProcessChatRegion(state.screenshot);
-                        }
-                    }
-                });
-                
-                // Wait for all tasks to complete
-                gameStateTask.wait();
-                playerDetectionTask.wait();
-                chatTask.wait();
-                
-                ExecuteActions();
-                UpdateStatistics();
-                consecutiveErrors = 0; // Reset error counter on success
-            }
-            
-            // Adaptive frame rate based on performance
-            double fps = perfMonitor->GetFPS();
-            int adaptiveDelay = fps > 30 ? config.actionDelay : config.actionDelay * 2;
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(adaptiveDelay));
-            
-        } catch (const cv::Exception& e) {
-            std::cerr << "OpenCV Error in main loop: " << e.what() << std::endl;
-            consecutiveErrors++;
-            
-            if (consecutiveErrors >= maxConsecutiveErrors) {
-                std::cerr << "Too many consecutive OpenCV errors. Stopping AI." << std::endl;
-                running = false;
-                break;
-            }
-            
-            // Try to recover by re-initializing camera
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Error in optimized main loop: " << e.what() << std::endl;
-            consecutiveErrors++;
-            
-            if (consecutiveErrors >= maxConsecutiveErrors) {
-                std::cerr << "Too many consecutive errors. Stopping AI." << std::endl;
-                running = false;
-                break;
-            }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            
-        } catch (...) {
-            std::cerr << "Unknown error in optimized main loop!" << std::endl;
-            consecutiveErrors++;
-            
-            if (consecutiveErrors >= maxConsecutiveErrors) {
-                std::cerr << "Too many consecutive unknown errors. Stopping AI." << std::endl;
-                running = false;
-                break;
+    actionPending = false;
+    lastDecisionTime = std::chrono::steady_clock::time_point();
+    
+    auto backpressure = config.pipelineBackpressure == "block" ? FramePipeline::Backpressure::BLOCK
+                                                               : FramePipeline::Backpressure::DROP_OLDEST;
+    
+    // Each stage works on the next frame while the one after it is still busy
+    FramePipeline pipeline;
+    pipeline.AddStage("capture", [this, optimizedBot](PipelineFrame& frame) {
+        // Replay sources end the run once all frames have been consumed
+        if (optimizedBot->IsFrameSourceFinished()) {
+            if (running.exchange(false)) {
+                std::cout << "Frame source exhausted, stopping." << std::endl;
             }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            return false;
         }
+        if (paused) return false;
+        return optimizedBot->CaptureFrame(frame);
+    });
+    
+    pipeline.AddStage("preprocess", [optimizedBot](PipelineFrame& frame) {
+        optimizedBot->PreprocessFrame(frame);
+        return true;
+    }, PIPELINE_QUEUE_SIZE, backpressure);
+    
+    pipeline.AddStage("detect", [optimizedBot](PipelineFrame& frame) {
+        optimizedBot->DetectFrame(frame);
+        return frame.state != nullptr;
+    }, PIPELINE_QUEUE_SIZE, backpressure);
+    
+    pipeline.AddStage("decide", [this](PipelineFrame& frame) {
+        // Decisions at most every actionDelay, frames in between only update detection
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastDecisionTime < std::chrono::milliseconds(config.actionDelay)) return false;
+        lastDecisionTime = now;
+        
+        perfMonitor->FrameStart();
+        bool act = DecideActions(frame);
+        UpdateStatistics();
+        return act;
+    }, PIPELINE_QUEUE_SIZE, backpressure);
+    
+    // A decision is never dropped, decide holds back until the last one is carried out
+    pipeline.AddStage("actuate", [this](PipelineFrame& frame) {
+        PerformActions(frame);
+        return true;
+    }, 2, FramePipeline::Backpressure::BLOCK);
+    
+    // Errors count per stage, so a stage failing on every frame stops the
+    // run even while the others succeed
+    pipeline.SetErrorHandler([this](const std::string& stage, std::exception_ptr error, int consecutiveErrors) {
+        HandleStageError(stage, error, consecutiveErrors);
+    });
+    
+    pipeline.Start();
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
+    pipeline.Stop();
     
     std::cout << "Optimized main execution loop ended." << std::endl;
     std::cout << "Final performance stats: " << perfMonitor->GetFPS() << " FPS average" << std::endl;
+    perfMonitor->PrintLatencyReport();
+    pipeline.PrintReport();
+}
+
+void MinecraftAI::HandleStageError(const std::string& stage, std::exception_ptr error, int consecutiveErrors) {
+    const int maxConsecutiveErrors = 5;
+    
+    // Sleeping here backs off the failing stage only
+    try {
+        std::rethrow_exception(error);
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV Error in " << stage << " stage: " << e.what() << std::endl;
+        
+        if (consecutiveErrors >= maxConsecutiveErrors) {
+            std::cerr << "Too many consecutive OpenCV errors. Stopping AI." << std::endl;
+            running = false;
+            return;
+        }
+        
+        // Try to recover by re-initializing camera
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error in " << stage << " stage: " << e.what() << std::endl;
+        
+        if (consecutiveErrors >= maxConsecutiveErrors) {
+            std::cerr << "Too many consecutive errors. Stopping AI." << std::endl;
+            running = false;
+            return;
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        
+    } catch (...) {
+        std::cerr << "Unknown error in " << stage << " stage!" << std::endl;
+        
+        if (consecutiveErrors >= maxConsecutiveErrors) {
+            std::cerr << "Too many consecutive unknown errors. Stopping AI." << std::endl;
+            running = false;
+            return;
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    }
 }
 
 void MinecraftAI::MainExecutionLoop() {
@@ -246,7 +283,7 @@ void MinecraftAI::ProcessGameState() {
         
         // Validate captured state
         auto currentState = bot->GetCurrentState();
-        if (currentState.screenshot.empty()) {
+        if (currentState->screenshot.empty()) {
             throw std::runtime_error("Captured screenshot is empty");
         }
         
@@ -256,39 +293,136 @@ void MinecraftAI::ProcessGameState() {
 }
 
 void MinecraftAI::ExecuteActions() {
-    auto state = bot->GetCurrentState();
+    PipelineFrame frame;
+    frame.state = bot->GetCurrentState();
+    if (DecideActions(frame)) {
+        PerformActions(frame);
+    }
+}
+
+bool MinecraftAI::DecideActions(PipelineFrame& frame) {
+    const auto& state = frame.state;
+    
+    // Log each processed frame once, together with the decision taken on it
+    auto recordDecision = [&](MinecraftBot::ActionType action, cv::Point2f target) {
+        std::lock_guard<std::mutex> lock(recorderMutex);
+        if (!recorder || state->frameSequence == lastRecordedSequence) return;
+        
+        lastRecordedSequence = state->frameSequence;
+        if (!recorder->Record(state, action, target)) {
+            std::cerr << "Recording failed, stopping session recorder" << std::endl;
+            recorder.reset();
+        }
+    };
+    
+    // The previous decision is still being carried out
+    if (actionPending) {
+        recordDecision(MinecraftBot::ActionType::IDLE, cv::Point2f());
+        return false;
+    }
+    
+    frame.decisionTime = std::chrono::steady_clock::now();
+    if (state->frameSequence != 0) {
+        perfMonitor->RecordLatency(PerformanceMonitor::LatencyStage::CAPTURE_TO_DECISION,
+                                  frame.decisionTime - state->captureTime);
+    }
     
     // Priority 1: Respond to player interactions
-    if (config.pauseOnPlayer && playerDetector->IsPlayerNearby("", 3.0)) {
-        bot->StopMining();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        return;
+    if (config.pauseOnPlayer) {
+        for (const auto& player : state->nearbyPlayers) {
+            if (player.distance <= 3.0) {
+                frame.pauseForPlayer = true;
+                break;
+            }
+        }
+        if (frame.pauseForPlayer) {
+            recordDecision(MinecraftBot::ActionType::IDLE, cv::Point2f());
+            actionPending = true;
+            return true;
+        }
     }
     
-    if (config.chatResponses && chatHandler->WasMentioned()) {
-        auto mentions = chatHandler->GetRecentMentions();
-        for (const auto& mention : mentions) {
-            std::string response = "Hello " + mention.playerName + "! I'm just mining here.";
-            chatHandler->SendChatMessage(response);
+    if (config.chatResponses) {
+        for (const auto& playerName : state->mentionedBy) {
+            frame.chatResponses.push_back("Hello " + playerName + "! I'm just mining here.");
         }
     }
     
     // Priority 2: Normal mining behavior
     if (!bot->isMining) {
-        if (!state.detectedBlocks.empty()) {
-            cv::Point2f target(static_cast<float>(state.detectedBlocks[0].x + state.detectedBlocks[0].width/2),
-                             static_cast<float>(state.detectedBlocks[0].y + state.detectedBlocks[0].height/2));
-            bot->StartMining(target);
+        if (!state->detectedBlocks.empty()) {
+            frame.action = MinecraftBot::ActionType::MINE_BLOCK;
+            frame.target = cv::Point2f(static_cast<float>(state->detectedBlocks[0].x + state->detectedBlocks[0].width/2),
+                                       static_cast<float>(state->detectedBlocks[0].y + state->detectedBlocks[0].height/2));
+            frame.targetId = state->GetBlockId(0);
+            recordDecision(frame.action, frame.target);
         }
     } else {
-        if (bot->IsBlockBroken() || (config.avoidBedrock && state.currentBlockType == "bedrock")) {
-            bot->StopMining();
-            bot->MoveToNextBlock();
+        if (bot->IsBlockBroken() || (config.avoidBedrock && state->currentBlockType == "bedrock")) {
+            frame.action = MinecraftBot::ActionType::MOVE_TO_POSITION;
+            recordDecision(frame.action, cv::Point2f());
             
             std::lock_guard<std::mutex> lock(statsMutex);
             statistics.blocksMined++;
         }
     }
+    
+    if (frame.action == MinecraftBot::ActionType::IDLE) {
+        recordDecision(MinecraftBot::ActionType::IDLE, cv::Point2f());
+        if (frame.chatResponses.empty()) return false;
+    }
+    
+    actionPending = true;
+    return true;
+}
+
+void MinecraftAI::PerformActions(const PipelineFrame& frame) {
+    try {
+        // Carry the frame's capture stamp into the inputs the decision causes
+        if (frame.state->frameSequence != 0) {
+            bot->BeginDecision(frame.state->captureTime, frame.decisionTime);
+        }
+        
+        if (frame.pauseForPlayer) {
+            bot->StopMining();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        } else {
+            for (const auto& response : frame.chatResponses) {
+                chatHandler->SendChatMessage(response);
+            }
+            
+            if (frame.action == MinecraftBot::ActionType::MINE_BLOCK) {
+                bot->StartMining(frame.target, frame.targetId, frame.state->cameraOffset);
+            } else if (frame.action == MinecraftBot::ActionType::MOVE_TO_POSITION) {
+                bot->StopMining();
+                bot->MoveToNextBlock();
+            }
+        }
+    } catch (...) {
+        actionPending = false;
+        throw;
+    }
+    
+    actionPending = false;
+}
+
+bool MinecraftAI::StartRecording(const std::string& directory, bool compressFrames) {
+    auto newRecorder = std::make_unique<SessionRecorder>(directory, compressFrames);
+    if (!newRecorder->Open()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    recorder = std::move(newRecorder);
+    lastRecordedSequence = 0;
+    std::cout << "Recording session to " << directory
+             << (compressFrames ? " (lossless compressed)" : " (raw frames)") << std::endl;
+    return true;
+}
+
+void MinecraftAI::StopRecording() {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    recorder.reset(); // Closing truncates the last chunk to its used size
 }
 
 void MinecraftAI::UpdateStatistics() {
@@ -345,6 +479,16 @@ bool MinecraftAI::ValidateConfig(const AIConfig& newConfig) {
             throw std::runtime_error("Invalid mining mode: " + newConfig.miningMode);
         }
         
+        // Validate block detector
+        if (newConfig.blockDetector != "contour" && newConfig.blockDetector != "grid") {
+            throw std::runtime_error("Invalid block detector: " + newConfig.blockDetector);
+        }
+        
+        // Validate frame pipeline backpressure
+        if (newConfig.pipelineBackpressure != "drop_oldest" && newConfig.pipelineBackpressure != "block") {
+            throw std::runtime_error("Invalid pipeline backpressure: " + newConfig.pipelineBackpressure);
+        }
+        
         // Validate known players
         for (const auto& player : newConfig.knownPlayers) {
             if (player.length() < 3 || player.length() > 16) {
@@ -421,6 +565,13 @@ void MinecraftAI::ApplyConfigToComponents() {
     bot->SetPauseOnPlayer(config.pauseOnPlayer);
     bot->SetActionDelay(config.actionDelay);
     
+    if (auto* optimizedBot = dynamic_cast<OptimizedMinecraftBot*>(bot.get())) {
+        optimizedBot->SetBlockDetector(config.blockDetector == "grid"
+            ? OptimizedMinecraftBot::BlockDetectorType::GRID
+            : OptimizedMinecraftBot::BlockDetectorType::CONTOUR);
+        optimizedBot->SetDetectionPool(config.tiledDetection ? threadPool.get() : nullptr);
+    }
+    
     stats->SetMiningSpeedMultiplier(config.miningSpeed / 100.0);
 }
 
@@ -474,6 +625,20 @@ void MinecraftAI::SaveMemoryToFile() {
     if (perfMonitor) {
         memory["performance"]["averageFPS"] = perfMonitor->GetFPS();
         memory["performance"]["averageFrameTime"] = perfMonitor->GetAverageFrameTime();
+        
+        for (int i = 0; i < static_cast<int>(PerformanceMonitor::LatencyStage::COUNT); i++) {
+            auto stage = static_cast<PerformanceMonitor::LatencyStage>(i);
+            const LatencyHistogram& histogram = perfMonitor->GetLatency(stage);
+            if (histogram.GetCount() == 0) continue;
+            
+            Json::Value latency;
+            latency["count"] = static_cast<Json::UInt64>(histogram.GetCount());
+            latency["p50"] = histogram.GetPercentile(50);
+            latency["p95"] = histogram.GetPercentile(95);
+            latency["p99"] = histogram.GetPercentile(99);
+            latency["max"] = histogram.GetMax();
+            memory["performance"]["latencyMs"][PerformanceMonitor::GetLatencyStageName(stage)] = latency;
+        }
     }
     
     std::ofstream file("ai_memory.json");
@@ -1,5 +1,9 @@
 #pragma once
+#ifdef _WIN32
 #include <Windows.h>
+#else
+typedef void* HWND; // Native window handles only exist on Windows builds
+#endif
 #include <vector>
 #include <random>
 #include <chrono>
@@ -19,9 +23,12 @@
 #include <iostream>
 #include <cmath>
 #include <queue>
+#include <deque>
 #include <condition_variable>
 #include <future>
 #include <functional>
+#include <cstdint>
+#include <cstddef>
 
 // Forward declarations
 class MinecraftBot;
@@ -34,6 +41,11 @@ class WebGUI;
 class PerformanceMonitor;
 class ThreadPool;
 class ImageProcessingCache;
+class ScreenCaptureContext;
+class FrameSource;
+class FrameCaptureThread;
+class SessionRecorder;
+struct PipelineFrame;
 
 // Configuration structure for GUI integration
 struct AIConfig {
@@ -49,6 +61,9 @@ struct AIConfig {
     int detectionRadius = 16;
     std::string botUsername = "MinecraftAI";
     std::string miningMode = "blocks";
+    std::string blockDetector = "contour"; // "contour" or "grid"
+    std::string pipelineBackpressure = "drop_oldest"; // "drop_oldest" or "block", between the frame pipeline stages
+    bool tiledDetection = true;            // Contour detection split over the worker threads
     bool smoothRotation = true;
     bool humanizeMovement = true;
     bool autoSwitchTools = true;
@@ -68,38 +83,192 @@ struct AIStats {
     bool isPaused = false;
 };
 
+// Lock-free log-linear latency histogram with microsecond resolution and
+// 32 buckets per power of two (about 3% error). Any thread may record.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_VALUE_BITS = 36;   // ~19 hours, larger values are clamped
+    static const int BUCKET_COUNT = SUB_BUCKETS * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1);
+    
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> totalMicros{0};
+    std::atomic<uint64_t> maxMicros{0};
+    
+public:
+    void Record(std::chrono::steady_clock::duration latency);
+    void Reset();
+    
+    uint64_t GetCount() const { return count; }
+    // Latencies in milliseconds; percentile in [0, 100]
+    double GetPercentile(double percentile) const;
+    double GetMean() const;
+    double GetMax() const { return maxMicros / 1000.0; }
+    
+private:
+    static int BucketIndex(uint64_t micros);
+    static double BucketMidpoint(int index);
+};
+
 // Performance monitoring class
 class PerformanceMonitor {
+public:
+    // Stages of the capture-to-input path a frame's stamp is carried through
+    enum class LatencyStage {
+        CAPTURE_TO_DETECTION,   // Frame grabbed -> detection results in GameState
+        CAPTURE_TO_DECISION,    // Frame grabbed -> ExecuteActions decides on it
+        DECISION_TO_INPUT,      // Decision -> first SendMouseMove/SendClick
+        CAPTURE_TO_INPUT,       // Frame grabbed -> first input based on it
+        COUNT
+    };
+    
 private:
     std::chrono::steady_clock::time_point lastFrameTime;
     std::vector<double> frameTimes;
     size_t frameIndex = 0;
     static const size_t FRAME_HISTORY_SIZE = 60;
+    LatencyHistogram latencies[static_cast<int>(LatencyStage::COUNT)];
     
 public:
     PerformanceMonitor();
     void FrameStart();
     double GetAverageFrameTime() const;
     double GetFPS() const;
+    
+    void RecordLatency(LatencyStage stage, std::chrono::steady_clock::duration latency);
+    const LatencyHistogram& GetLatency(LatencyStage stage) const;
+    static const char* GetLatencyStageName(LatencyStage stage);
+    void PrintLatencyReport() const;
 };
 
-// Thread pool for parallel processing
+// Move-only callable for ThreadPool tasks. Callables of up to INLINE_SIZE
+// bytes that move without throwing are stored in place, so queueing them
+// allocates nothing; larger ones are moved to the heap.
+class PoolTask {
+public:
+    static const size_t INLINE_SIZE = 48;
+    
+    PoolTask() = default;
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, PoolTask>::value>>
+    PoolTask(F&& f);
+    PoolTask(PoolTask&& other) noexcept;
+    PoolTask& operator=(PoolTask&& other) noexcept;
+    PoolTask(const PoolTask&) = delete;
+    PoolTask& operator=(const PoolTask&) = delete;
+    ~PoolTask() { Reset(); }
+    
+    explicit operator bool() const { return ops != nullptr; }
+    void operator()() { ops->invoke(storage); }
+    void Reset();
+    
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to); // Leaves from destroyed
+        void (*destroy)(void* storage);
+    };
+    template<typename F> struct InlineOps;
+    template<typename F> struct HeapOps;
+    
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+// Work-stealing thread pool. Every worker owns a fixed-size Chase-Lev deque:
+// tasks submitted from a worker go to the bottom of its own deque and it pops
+// them from there, idle workers steal from the top of the others. Tasks from
+// other threads go through a bounded multi-producer queue; a locked overflow
+// queue takes what the bounded queues cannot.
 class ThreadPool {
+public:
+    static const int64_t DEQUE_CAPACITY = 1024; // Per worker, a power of two
+    static const size_t INJECT_CAPACITY = 1024; // A power of two
+    
 private:
+    struct WorkerQueue;
+    struct InjectQueue;
+    
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queueMutex;
-    std::condition_variable condition;
-    bool stop = false;
+    std::vector<std::unique_ptr<WorkerQueue>> queues; // One per worker
+    std::unique_ptr<InjectQueue> injected;
+    std::deque<PoolTask> overflow;
+    std::mutex overflowMutex;
+    std::atomic<size_t> overflowSize{0};
+    
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<uint64_t> epoch{0}; // Bumped by every submission, so sleepers miss none
+    std::atomic<int> sleeping{0};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> steals{0};
     
 public:
     ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
     ~ThreadPool();
     
+    // Queues a task, which must not throw. Throws on a stopped pool; on a pool
+    // without workers the task runs right away.
+    void Submit(PoolTask task);
+    
     template<typename F>
-    auto enqueue(F&& f) -> std::future<typename std::result_of<F()>::type>;
+    auto enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>>;
+    
+    // Calls body(first, last) for chunks of at most grain indices of
+    // [begin, end) on the calling thread and idle workers. Returns when all
+    // chunks are done and rethrows the first exception of body.
+    template<typename Body>
+    void parallel_for(size_t begin, size_t end, size_t grain, Body&& body);
+    
+    // Runs one queued task on the calling thread; a worker takes its own
+    // deque first. Returns false if no task was found.
+    bool RunPendingTask(bool ownQueueOnly = false);
+    // True on one of this pool's worker threads
+    bool IsWorkerThread() const;
+    
+    size_t GetThreadCount() const { return workers.size(); }
+    uint64_t GetStealCount() const { return steals.load(std::memory_order_relaxed); }
+    
+private:
+    void WorkerLoop(size_t index);
+    bool TakeTask(PoolTask& task, bool ownQueueOnly);
+    void Notify();
 };
 
+// Fork-join over a ThreadPool without futures: run() queues tasks, wait()
+// returns once all of them finished and rethrows the first exception. While
+// waiting a worker of the pool runs queued tasks, so waiting inside a pool
+// task does not take a worker away from the pool. Any other thread blocks;
+// it would otherwise run unrelated tasks of any length on its own time.
+class TaskGroup {
+private:
+    static constexpr std::chrono::microseconds WAIT_SLICE{100};
+    
+    ThreadPool& pool;
+    std::atomic<int> pending{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+    
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup(); // Waits, dropping any exception
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    template<typename F>
+    void run(F&& f);
+    void wait();
+    
+private:
+    void Finish(std::exception_ptr taskError);
+};
+
+// Tasks per second and submission latency of the work-stealing pool against
+// a single-queue pool, plus a chunked sum with futures against parallel_for
+int RunThreadPoolBenchmark(int taskCount);
+
 // Memory pool for frequent allocations
 template<typename T>
 class ObjectPool {
@@ -115,6 +284,75 @@ public:
     size_t size() const;
 };
 
+// Lock-free single-producer/single-consumer triple buffer. The writer fills
+// its private slot and publishes it, the reader always takes the newest
+// published slot; neither side ever blocks or waits for the other.
+template<typename T>
+class TripleBuffer {
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t NEW_DATA = 0x4;
+    
+    T slots[3];
+    std::atomic<uint8_t> middle{1}; // Shared slot index plus unread flag
+    uint8_t writeIndex = 0;         // Owned by the writer
+    uint8_t readIndex = 2;          // Owned by the reader
+    
+public:
+    T& WriteSlot() { return slots[writeIndex]; }
+    void Publish();
+    
+    // Swaps in the newest published slot; returns false if nothing new arrived
+    bool Update();
+    T& ReadSlot() { return slots[readIndex]; }
+};
+
+// Bounded queue handing items from one producer thread to one consumer
+// thread. Not a plain single-producer/single-consumer queue: to make room the
+// producer may take the oldest item itself (DropOldest), so both threads take
+// from the tail. The read index is claimed with a compare-and-swap and each
+// slot carries a sequence number, as in the ThreadPool queues; only pushing
+// is left to a single thread.
+template<typename T>
+class HandoffQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T item;
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    alignas(64) std::atomic<size_t> head{0}; // Next index written, producer only
+    alignas(64) std::atomic<size_t> tail{0}; // Next index read
+    
+public:
+    enum class PushResult {
+        PUSHED,
+        FULL,  // capacity items queued
+        BUSY   // Room, but the consumer is still moving the oldest item out of the slot
+    };
+    
+    // At least two slots, with one the full and the free sequence numbers would coincide
+    explicit HandoffQueue(size_t capacity);
+    HandoffQueue(const HandoffQueue&) = delete;
+    HandoffQueue& operator=(const HandoffQueue&) = delete;
+    
+    // Producer; item is moved from only when PUSHED
+    PushResult TryPush(T& item);
+    // Producer; moves the oldest item into dropped, false unless the queue
+    // is full (the consumer may have made room meanwhile)
+    bool DropOldest(T& dropped) { return Take(dropped, true); }
+    // Consumer; false if the queue is empty
+    bool TryPop(T& item) { return Take(item, false); }
+    
+    size_t Size() const;
+    size_t Capacity() const { return capacity; }
+    
+private:
+    bool Take(T& item, bool onlyIfFull);
+};
+
 // Optimized image processing utilities
 class ImageProcessingCache {
 private:
@@ -132,6 +370,1081 @@ private:
     void cleanOldEntries();
 };
 
+// Per-frame grid of 32x32 tile content hashes. Each tile remembers the frame
+// sequence it last changed in, so a stage can ask whether its region changed
+// since the frame it last processed and skip work on a static view.
+class TileChangeMap {
+private:
+    cv::Size frameSize;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<uint64_t> tileHashes;
+    std::vector<uint64_t> tileChangedAt;
+    std::vector<uint32_t> laneState; // Hash lanes of the tile row being scanned
+    uint64_t lastSequence = 0;
+    size_t changedTiles = 0;
+    
+public:
+    static const int TILE_SIZE = 32;
+    
+    // Hashes all tiles of a CV_8U frame and records which ones differ from the
+    // previous frame. A size change marks every tile as changed.
+    void Update(const cv::Mat& frame, uint64_t frameSequence);
+    
+    // True if any tile overlapping the region changed after frameSequence.
+    // Also true before the first update and for regions outside the frame.
+    bool RegionChangedSince(const cv::Rect& region, uint64_t frameSequence) const;
+    
+    uint64_t GetLastSequence() const { return lastSequence; }
+    size_t GetChangedTileCount() const { return changedTiles; }
+    size_t GetTileCount() const { return tileHashes.size(); }
+    
+    // Content hash of a whole CV_8U image, same mixing as the tile hashes
+    static uint64_t HashImage(const cv::Mat& image);
+    
+private:
+    void Reset(const cv::Mat& frame);
+};
+
+// Derived images of one captured frame: gray, HSV and a 2x downsampled
+// pyramid. Each is computed on first use and at most once (std::call_once), so pool workers can share one context.
+class FrameContext {
+public:
+    static const int MAX_LEVELS = 4; // Level 0 is the frame itself, each next level half size
+    
+private:
+    struct Level {
+        std::once_flag imageOnce;
+        std::once_flag grayOnce;
+        std::once_flag hsvOnce;
+        cv::Mat image;
+        cv::Mat gray;
+        cv::Mat hsv;
+    };
+    
+    uint64_t sequence;
+    mutable Level levels[MAX_LEVELS];
+    
+public:
+    // The frame is shared, not copied; it must not be modified afterwards
+    FrameContext(const cv::Mat& frame, uint64_t frameSequence = 0);
+    FrameContext(const FrameContext&) = delete;
+    FrameContext& operator=(const FrameContext&) = delete;
+    
+    uint64_t GetSequence() const { return sequence; }
+    const cv::Mat& GetFrame() const { return levels[0].image; }
+    const cv::Mat& GetLevel(int level) const;
+    const cv::Mat& GetGray(int level = 0) const;
+    const cv::Mat& GetHSV(int level = 0) const;
+};
+
+// Contour block detector that owns all of its working buffers. It runs the
+// classic pipeline (3x3 Gaussian, Canny 30/90, 3x3 close, external contours,
+// box shape filter) with its own kernels instead of the OpenCV calls, which
+// allocate scratch memory internally, and traces contours without storing
+// their points. Once the buffers have grown to the ROI size a call makes no
+// heap allocations; --check-detect-alloc verifies that, and diffs the edges
+// and blocks against the OpenCV calls on the same frames.
+class ContourBlockDetector {
+public:
+    static const int MAX_BLOCKS = 10;
+    static const int MIN_BLOCK_SIZE = 15; // Bounding box side limits of a block
+    static const int MAX_BLOCK_SIZE = 80;
+    static const int LOW_THRESHOLD = 30;  // Canny hysteresis thresholds (L1 gradient)
+    static const int HIGH_THRESHOLD = 90;
+    
+private:
+    struct Candidate {
+        cv::Rect rect;
+        float distance; // Squared distance of the rect center to the crosshair
+    };
+    
+    // All image buffers except blurRows and gradients carry a 1 pixel border
+    cv::Mat blurRows;   // CV_16U, horizontal Gaussian pass over roi rows -1..h
+    cv::Mat blurred;    // CV_8U, replicated border for Sobel
+    cv::Mat gradX, gradY;
+    cv::Mat magnitude;  // CV_32S, zero border
+    cv::Mat edgeMap;    // CV_8U, Canny states: 0 maybe, 1 no, 2 edge
+    cv::Mat rowPass;    // CV_8U, horizontal pass of the closing
+    cv::Mat dilated;    // CV_8U, border set so erosion ignores it
+    cv::Mat binary;     // CV_8U, closed edges as 0/1, zero border; contour labels
+    std::vector<int> edgeStack;
+    std::vector<Candidate> candidates;
+    std::vector<cv::Rect> blocks;
+    
+public:
+    ContourBlockDetector();
+    
+    // Blocks inside roi sorted by distance to center, at most maxBlocks. The
+    // vector belongs to the detector and stays valid until the next call.
+    const std::vector<cv::Rect>& Detect(const FrameContext& context, const cv::Rect& roi, cv::Point2f center,
+                                        size_t maxBlocks = MAX_BLOCKS);
+    
+    // Canny edges of the roi of the last Detect call, 255 on edges
+    void GetEdges(cv::Mat& edges) const;
+    
+private:
+    void Blur(const cv::Mat& gray, const cv::Rect& roi);
+    void FindEdges();
+    void CloseEdges();
+    void TraceContours(cv::Point offset, cv::Point2f center);
+};
+
+// Contour detection over overlapping tiles of the roi, run by the calling
+// thread together with ThreadPool workers. The tile cores partition the roi
+// and each block is reported by the tile whose core holds its center, so
+// blocks on a seam are found once.
+class TiledBlockDetector {
+public:
+    static const int MAX_TILES = 16;
+    static const int MIN_TILE_SIZE = 256; // Core side, smaller tiles cost more in overlap than they save
+    static const int SEAM_MARGIN = 4;     // Edges this close to a cut differ from the untiled result
+    // Any block owned by a tile lies inside it, clear of the seam margin
+    static const int OVERLAP = ContourBlockDetector::MAX_BLOCK_SIZE / 2 + SEAM_MARGIN;
+    
+private:
+    struct Tile {
+        cv::Rect core;
+        cv::Rect area; // Core grown by OVERLAP, clipped to the roi
+        ContourBlockDetector detector;
+        std::vector<std::pair<float, cv::Rect>> owned; // Squared distance to the crosshair, block
+    };
+    
+    std::vector<Tile> tiles;
+    cv::Rect layoutRoi;
+    int layoutTiles = 0;
+    std::vector<std::pair<float, cv::Rect>> merged;
+    std::vector<cv::Rect> blocks;
+    
+public:
+    // Blocks inside roi sorted by distance to center, at most MAX_BLOCKS. The
+    // roi is split into up to maxTiles tiles; without a pool, or when the roi
+    // is too small to split, it is a single ContourBlockDetector pass.
+    const std::vector<cv::Rect>& Detect(const FrameContext& context, const cv::Rect& roi, cv::Point2f center,
+                                        ThreadPool* pool, int maxTiles);
+    
+    int GetTileCount() const { return static_cast<int>(tiles.size()); }
+    
+private:
+    void Layout(const cv::Rect& roi, int maxTiles);
+    void DetectTile(Tile& tile, const FrameContext& context, const cv::Rect& roi, cv::Point2f center);
+};
+
+// Times the tiled detector with 1, 2, 4 and 8 threads on recorded frames
+// against a single ContourBlockDetector and prints the scaling curve
+int RunTiledDetectionBenchmark(const std::string& path, int maxFrames);
+
+// Heap allocations through operator new, counted process wide while started.
+// Only available when built with MINECRAFTAI_COUNT_ALLOCATIONS.
+class AllocationCounter {
+public:
+    static bool IsAvailable();
+    static void Start();
+    // Stops counting and returns the allocations since Start()
+    static uint64_t Stop();
+};
+
+// Runs the contour detector over recorded frames and fails if any frame after
+// the warm-up allocates heap memory (operator new or cv::Mat buffers), or if
+// its edge map or blocks differ from GaussianBlur, Canny, morphologyEx and
+// findContours on the same frame. Without MINECRAFTAI_COUNT_ALLOCATIONS it
+// cannot count operator new and fails.
+int RunDetectorAllocationCheck(const std::string& path, int maxFrames);
+
+// Block face detector built on Minecraft's voxel grid. Instead of tracing
+// contours it finds the two dominant edge orientations, fits the spacing and
+// phase of both line families around the crosshair and emits the lattice
+// cells whose borders are backed by edges. Near the crosshair the projected
+// grid is close to affine, so one period per family is enough there.
+class GridBlockDetector {
+public:
+    struct BlockFace {
+        cv::Point2f corners[4]; // Lattice order: (i,j), (i+1,j), (i+1,j+1), (i,j+1)
+        cv::Rect bounds;
+        float score = 0.0f;     // Fraction of border samples lying on an edge
+    };
+    
+    struct GridFit {
+        bool valid = false;
+        float normalAngle[2] = {0.0f, 0.0f}; // Radians, direction across each line family
+        float period[2] = {0.0f, 0.0f};      // Line spacing in level 0 pixels
+        float phase[2] = {0.0f, 0.0f};       // First line offset from the crosshair
+    };
+    
+    static const int MAX_FACES = 10;
+    
+private:
+    int pyramidLevel;
+    float minScore = 0.45f;
+    GridFit lastFit;
+    
+    struct EdgePoint {
+        float x, y;
+        float angle;  // Gradient direction folded into [0, pi)
+        float weight; // Gradient magnitude
+    };
+    
+    // Scratch buffers, reused between frames
+    cv::Mat gradX, gradY, magnitude;
+    cv::Mat tensorXX, tensorXY, tensorYY;
+    std::vector<EdgePoint> edgePoints;
+    std::vector<float> histogram;
+    std::vector<float> profile;
+    std::vector<float> correlation;
+    std::vector<float> folded;
+    
+public:
+    // Level 1 (half resolution) keeps block edges of normal view distances
+    // above the smallest period the fit searches for
+    explicit GridBlockDetector(int level = 1);
+    
+    // Faces inside roi sorted by distance to the crosshair, in level 0 pixels
+    std::vector<BlockFace> Detect(const FrameContext& context, const cv::Rect& roi, cv::Point2f crosshair);
+    
+    const GridFit& GetLastFit() const { return lastFit; }
+    void SetMinScore(float score) { minScore = score; }
+    
+    static std::vector<cv::Rect> ToRects(const std::vector<BlockFace>& faces);
+    
+private:
+    // Period and phase (level pixels) of the lines whose normal is normalAngle
+    bool FitFamily(float normalAngle, cv::Point2f origin, float maxDistance, float& period, float& phase);
+    float ScoreEdge(cv::Point2f from, cv::Point2f to, float edgeThreshold) const;
+};
+
+// Runs the contour and grid detectors over recorded frames and prints the
+// time per frame, how often a block covers the crosshair (a detection rate,
+// without labels to check it against) and target stability of each, plus the
+// cost of the per-frame CrosshairProbe
+int RunDetectorBenchmark(const std::string& path, int maxFrames);
+
+// Keeps detected blocks alive between detection passes. Detections are
+// matched to tracks by IoU against each track's predicted box, an alpha-beta
+// filter smooths position and size and estimates screen velocity, and every
+// track keeps its id for as long as it is matched. Confidence decays while a
+// track is only predicted (faster when it moves), so detection can be skipped
+// until the tracks become uncertain.
+class BlockTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Track {
+        uint32_t id = 0;
+        cv::Rect2f box;          // Filtered box at lastUpdate
+        cv::Rect2f predicted;    // Box at the last Predict() time
+        cv::Point2f velocity;    // Pixels per second
+        float confidence = 0.0f; // At lastUpdate, see GetConfidence()
+        int hits = 0;
+        int misses = 0;          // Detection passes in a row without a match
+        std::string type;        // Block type, empty until identified
+        Clock::time_point lastUpdate;
+    };
+    
+    static const int MAX_TRACKS = 32;
+    
+private:
+    std::vector<Track> tracks;
+    uint32_t nextId = 1;
+    Clock::time_point predictTime;
+    bool motionCompensated = false; // Tracks follow the measured camera motion
+    
+    // Scratch buffers, reused between detection passes
+    std::vector<std::pair<float, std::pair<int, int>>> candidates;
+    std::vector<int> trackMatch;
+    std::vector<bool> trackSearched;
+    std::vector<bool> detectionMatched;
+    
+public:
+    // Associates one detection pass with the tracks. Unmatched detections
+    // start new tracks, unmatched tracks lose confidence and are dropped
+    // after a few misses. A pass over part of the roi gives that part as
+    // region; tracks outside it were not searched for and are left alone.
+    void Update(const std::vector<cv::Rect>& detections, Clock::time_point now,
+                const cv::Rect& region = cv::Rect());
+    // Moves every track to its predicted box at now and drops tracks that
+    // left the roi
+    void Predict(Clock::time_point now, const cv::Rect& roi);
+    // The camera moved the whole view by shift since the last call; every
+    // track moves with it instead of by its own velocity, and tracks that
+    // left the roi are dropped
+    void Shift(cv::Point2f shift, Clock::time_point now, const cv::Rect& roi);
+    // The view did not change since the last detection pass; all tracks are
+    // confirmed where they are
+    void Hold(Clock::time_point now);
+    void Reset();
+    
+    // True when there are no tracks, a track is new or uncertain, or the view
+    // moved enough to bring in new blocks
+    bool NeedsDetection() const;
+    float GetConfidence(const Track& track) const;
+    
+    // Reported tracks sorted by distance to center; ids and types parallel to blocks
+    void GetBlocks(cv::Point2f center, std::vector<cv::Rect>& blocks,
+                   std::vector<uint32_t>& ids, std::vector<std::string>& types) const;
+    void SetType(uint32_t id, const std::string& type);
+    const std::vector<Track>& GetTracks() const { return tracks; }
+    
+    static float IoU(const cv::Rect2f& a, const cv::Rect2f& b);
+    
+private:
+    void DropOutside(const cv::Rect& roi, Clock::time_point now);
+};
+
+// Global camera motion between consecutive frames by phase correlation of the
+// downsampled gray mining area. Turning the view moves the picture near the
+// crosshair by nearly the same amount everywhere, so one shift per frame
+// carries tracked blocks and the mining target along without a detection pass.
+class CameraMotionEstimator {
+public:
+    static const int PYRAMID_LEVEL = 2; // Quarter resolution
+    static const int MIN_SIZE = 32;     // Level pixels per side needed for a usable peak
+    
+    struct Motion {
+        bool valid = false;
+        cv::Point2f shift;     // Level 0 pixels the picture moved since the previous frame
+        float response = 0.0f; // Height of the correlation peak, 0 to 1
+    };
+    
+private:
+    cv::Rect area;       // Level 0 region the reference was taken from
+    cv::Mat reference;   // CV_32F, area of the previous frame at PYRAMID_LEVEL
+    cv::Mat current;
+    cv::Mat window;      // Hanning window, keeps the image borders out of the peak
+    float minResponse = 0.08f;
+    float maxShift = 0.25f; // Of the region size, larger jumps are a scene change
+    Motion lastMotion;
+    
+public:
+    // Motion of region between the previous call's frame and this one.
+    // Invalid on the first call, after the region moved or resized, and when
+    // the peak is too weak to trust (a scene change or a mostly moving view).
+    Motion Update(const FrameContext& context, const cv::Rect& region);
+    void Reset();
+    
+    const Motion& GetLastMotion() const { return lastMotion; }
+    void SetMinResponse(float response) { minResponse = response; }
+};
+
+// Per-channel integral sums and squared sums over one area of an 8-bit image.
+// Built in a single pass, after which the mean and standard deviation of any
+// rect inside the area cost four lookups per channel. Meant to be built once
+// per frame over the union of a batch of candidates.
+class RegionStatsEngine {
+public:
+    static const int MAX_CHANNELS = 3;        // Alpha of BGRA frames is ignored
+    static const int MAX_AREA = 16 * 1024 * 1024; // Keeps 32-bit sums from overflowing
+    
+    struct RegionStats {
+        int count = 0;
+        double mean[MAX_CHANNELS] = {};
+        double stddev[MAX_CHANNELS] = {}; // Zero unless built with squares
+    };
+    
+private:
+    cv::Rect area;
+    int channels = 0;
+    bool hasSquares = false;
+    std::vector<uint32_t> sums;    // (height + 1) x (width + 1) x channels
+    std::vector<uint64_t> squares; // Same layout, only with squares
+    
+public:
+    void Build(const cv::Mat& image, const cv::Rect& region, bool withSquares = false);
+    // Builds over the bounding box of all rects
+    void Build(const cv::Mat& image, const std::vector<cv::Rect>& rects, bool withSquares = false);
+    
+    // Stats of the part of rect inside the built area
+    RegionStats GetStats(const cv::Rect& rect) const;
+    void GetStats(const std::vector<cv::Rect>& rects, std::vector<RegionStats>& stats) const;
+    
+    const cv::Rect& GetArea() const { return area; }
+    bool Contains(const cv::Rect& rect) const { return (rect & area) == rect && !rect.empty(); }
+    
+    static cv::Rect BoundingRect(const std::vector<cv::Rect>& rects);
+};
+
+// Block type classifier over a 32x32x32 color lookup table. Each pixel of a
+// region is quantized to 5 bits per channel and mapped straight to a block
+// class, the class histogram of the region decides. The table is generated
+// from labelled sample textures. Without a table the old mean color
+// thresholds apply, with region means taken from a RegionStatsEngine.
+class BlockClassifier {
+public:
+    static const int CHANNEL_BITS = 5;
+    static const int TABLE_SIZE = 1 << (3 * CHANNEL_BITS);
+    static const int MAX_CLASSES = 64;
+    static const int UNKNOWN = 0;
+    
+private:
+    std::vector<uint8_t> table;          // TABLE_SIZE entries plus gather padding, empty without a table
+    std::vector<std::string> classNames; // Index 0 is "unknown"
+    std::vector<float> expectedShare;    // Share of a class's own samples it claims
+    float minScore = 0.5f;
+    
+public:
+    BlockClassifier();
+    
+    // Drops the table and goes back to the old mean color thresholds
+    void UseDefaultRules();
+    bool HasTable() const { return !table.empty(); }
+    // Builds the table from <directory>/<block_type>/ sample images
+    bool Train(const std::string& directory);
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+    
+    // Class of a region of a CV_8UC4 (BGRA) or CV_8UC3 image, UNKNOWN if no
+    // class reaches minScore of the share it has on its own samples
+    int Classify(const cv::Mat& image, const cv::Rect& region) const;
+    // Batch version; without a table one stats pass over the union of the
+    // regions replaces a mean per region
+    void ClassifyRegions(const cv::Mat& image, const std::vector<cv::Rect>& regions,
+                         std::vector<int>& classes, RegionStatsEngine& stats) const;
+    // Pixel count per class inside the region, histogram has MAX_CLASSES
+    // entries (all zero without a table)
+    void ComputeHistogram(const cv::Mat& image, const cv::Rect& region, uint32_t* histogram) const;
+    // Class from a region's stats by the mean color thresholds (the rules
+    // used without a table)
+    int ClassifyStats(const RegionStatsEngine::RegionStats& stats) const;
+    
+    const std::string& GetClassName(int classIndex) const;
+    size_t GetClassCount() const { return classNames.size(); }
+    void SetMinScore(float score) { minScore = score; }
+    
+    static int TableIndex(uint8_t b, uint8_t g, uint8_t r) {
+        return ((b >> 3) << 10) | ((g >> 3) << 5) | (r >> 3);
+    }
+    
+private:
+    int ClassifyTable(const cv::Mat& image, const cv::Rect& region) const;
+    static int ClassifyMeanColor(const double* meanBGR);
+};
+
+// Builds a block color table from labelled samples and writes it to outputPath
+int BuildBlockColorTable(const std::string& sampleDirectory, const std::string& outputPath);
+
+// Block type classifier matching regions against block textures (one image
+// per block, named after it, such as a resource pack's textures/block
+// folder). Every texture is described once at 4x4, 8x8 and 16x16 as a zero
+// mean, unit length BGR vector; a region is resampled to 16x16 and matched
+// coarse to fine by normalized correlation, which tells ores from the stone
+// they share most pixels with. Results are cached by the 4x4 level as a
+// ternary pattern plus a signature of the ore spots (how many texels stand
+// out at 16x16 and which way their color leans), so the same block under
+// another light level or a box off by a pixel is matched once. Not thread
+// safe.
+class TextureClassifier {
+public:
+    static const int LEVELS = 3;
+    static const int FACE_SIZE = 16;            // Finest level, the vanilla texture resolution
+    static const int FACE_VALUES = FACE_SIZE * FACE_SIZE * 3;
+    static const int MAX_CACHE_ENTRIES = 4096;
+    static const int UNKNOWN = -1;
+    
+    struct Match {
+        int texture = UNKNOWN;
+        float score = 0.0f; // Correlation at 16x16, -1 to 1
+    };
+    
+private:
+    // Per level, the descriptors of all textures back to back
+    std::vector<float> descriptors[LEVELS];
+    std::vector<std::string> names;
+    float minScore = 0.6f;
+    
+    std::unordered_map<uint64_t, Match> cache;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    
+    // Scratch of the region being matched
+    cv::Mat face;
+    float faceDescriptors[LEVELS][FACE_VALUES];
+    std::vector<std::pair<float, int>> ranked;
+    
+public:
+    // Loads every image in directory as the texture of the block named by
+    // its file name; animated strips use their first frame
+    bool LoadAtlas(const std::string& directory);
+    bool HasAtlas() const { return !names.empty(); }
+    
+    // Best texture for a region of a CV_8UC4 (BGRA) or CV_8UC3 image,
+    // UNKNOWN when no texture correlates with at least minScore. Without
+    // useCache the region is matched afresh and the cache is left alone.
+    Match Classify(const cv::Mat& image, const cv::Rect& region, bool useCache = true);
+    
+    const std::string& GetName(int texture) const { return names[texture]; }
+    size_t GetTextureCount() const { return names.size(); }
+    uint64_t GetCacheHits() const { return cacheHits; }
+    uint64_t GetCacheMisses() const { return cacheMisses; }
+    void SetMinScore(float score) { minScore = score; cache.clear(); }
+    
+    static int LevelSize(int level) { return FACE_SIZE >> (LEVELS - 1 - level); }
+    
+private:
+    // Descriptors of all levels from a FACE_SIZE x FACE_SIZE image
+    static void Describe(const cv::Mat& face, float (*levels)[FACE_VALUES]);
+    static uint64_t CacheKey(const float (*levels)[FACE_VALUES]);
+    // Finest level correlation, best over small cyclic shifts of the texture
+    // (textures tile, the detected box may be off by a few texels)
+    float CorrelateShifted(const float* region, int texture) const;
+};
+
+// Per-frame fast path for the block under the crosshair. Samples a small
+// fixed window at the screen center and reports its block class and when the
+// targeted block changed. The crosshair is drawn over the window's center
+// lines, so only the four corner quadrants around it are sampled; the class
+// is their majority vote. A change is a new class or a jump of the quadrant
+// color statistics between two frames (a broken or replaced block), while the
+// slow crack overlay of a block being mined stays below the threshold.
+class CrosshairProbe {
+public:
+    static const int WINDOW_SIZE = 48;     // Level 0 pixels around the screen center
+    static const int CROSSHAIR_BAND = 12;  // Skipped band around the center lines
+    static const int QUADRANTS = 4;
+    
+private:
+    RegionStatsEngine stats;
+    std::vector<cv::Rect> quadrants;
+    RegionStatsEngine::RegionStats quadrantStats[QUADRANTS];
+    int quadrantClasses[QUADRANTS] = {};
+    int classIndex = BlockClassifier::UNKNOWN;
+    bool hasSample = false;
+    bool changed = false;
+    float changeThreshold = 24.0f; // Mean absolute difference of quadrant means and deviations
+    double lastCostMs = 0.0;
+    
+public:
+    CrosshairProbe();
+    
+    // Samples the center of a CV_8UC4 or CV_8UC3 frame; returns TargetChanged()
+    bool Update(const cv::Mat& frame, const BlockClassifier& classifier);
+    void Reset();
+    
+    int GetClass() const { return classIndex; }
+    // True if the block under the crosshair changed in the last Update()
+    bool TargetChanged() const { return changed; }
+    bool HasSample() const { return hasSample; }
+    const RegionStatsEngine::RegionStats& GetQuadrantStats(int quadrant) const { return quadrantStats[quadrant]; }
+    double GetLastCostMs() const { return lastCostMs; }
+    void SetChangeThreshold(float threshold) { changeThreshold = threshold; }
+    
+    static cv::Rect GetWindow(cv::Size frameSize);
+    // Mean absolute difference of the means and deviations of two samples
+    static float Difference(const RegionStatsEngine::RegionStats* a, const RegionStatsEngine::RegionStats* b);
+};
+
+// Watches the CrosshairProbe samples of the block being mined. The first
+// sample after arming is the reference; the crack overlay then drifts the
+// sample away from it a little per frame, and the block breaking shows up as
+// a jump between two frames, a new class, or (when the block behind looks
+// the same) the drift collapsing because the cracks are gone.
+class BlockBreakDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+private:
+    bool armed = false;
+    bool hasReference = false;
+    bool broken = false;
+    RegionStatsEngine::RegionStats reference[CrosshairProbe::QUADRANTS];
+    int referenceClass = BlockClassifier::UNKNOWN;
+    float crackDrift = 0.0f;
+    float crackPeak = 0.0f;
+    Clock::time_point armTime;
+    
+public:
+    // Mining of a new block starts with the next sample
+    void Arm(Clock::time_point now);
+    void Disarm();
+    // Feeds the probe's sample of a frame; true on the frame the block broke
+    bool Update(const CrosshairProbe& probe, Clock::time_point frameTime);
+    
+    bool IsArmed() const { return armed; }
+    bool IsBroken() const { return broken; }
+    // Crack drift from the reference, 0 to 1 (about a complete crack overlay)
+    float GetCrackLevel() const;
+};
+
+// Reads the hotbar: its place, the selected slot and the item in every slot.
+// The hotbar is located once per resolution by trying each GUI scale where
+// Minecraft would draw it and keeping the one whose slot pattern repeats.
+// Slot icons are matched against item icons (one image per item, named after
+// it, such as a resource pack's textures/item folder) over their opaque
+// pixels, and only again once the slot's pixels changed.
+class HotbarReader {
+public:
+    static const int SLOTS = 9;
+    static const int WIDTH = 182;        // GUI pixels of the hotbar texture
+    static const int HEIGHT = 22;
+    static const int SLOT_SPACING = 20;
+    static const int ICON_SIZE = 16;
+    static const int MAX_GUI_SCALE = 6;
+    
+    struct Slot {
+        cv::Rect icon;           // Frame pixels of the slot's icon
+        uint64_t hash = 0;       // Icon pixels the item was matched on
+        int item = -1;           // Icon index, -1 for an empty or unknown slot
+        float distance = 0.0f;   // Mean absolute difference to the matched icon
+    };
+    
+private:
+    struct Icon {
+        std::string name;
+        cv::Mat color; // CV_8UC3, ICON_SIZE x ICON_SIZE
+        cv::Mat mask;  // CV_8U, 1 on opaque pixels
+        int opaque = 0;
+    };
+    
+    std::vector<Icon> icons;
+    float maxDistance = 40.0f;
+    
+    cv::Size frameSize;
+    int guiScale = 0; // 0 while the hotbar is not located
+    cv::Rect bounds;
+    Slot slots[SLOTS];
+    int selectedSlot = -1;
+    cv::Mat sample;   // Icon being matched, one frame pixel per GUI pixel
+    
+public:
+    bool LoadIcons(const std::string& directory);
+    bool HasIcons() const { return !icons.empty(); }
+    
+    // Reads the hotbar of a CV_8UC4 or CV_8UC3 frame, locating it first after
+    // a resolution change or while it was not found. Returns true if the
+    // selection or an item changed.
+    bool Update(const cv::Mat& frame);
+    void Reset();
+    
+    bool IsLocated() const { return guiScale > 0; }
+    int GetGuiScale() const { return guiScale; }
+    // Frame pixels of the hotbar; before it is located the area searched for it
+    cv::Rect GetRegion() const;
+    int GetSelectedSlot() const { return selectedSlot; }
+    // Item in a slot, empty for empty or unknown slots
+    const std::string& GetItem(int slot) const;
+    const Slot& GetSlot(int slot) const { return slots[slot]; }
+    void SetMaxDistance(float distance) { maxDistance = distance; }
+    
+    // Where Minecraft draws the hotbar at a GUI scale
+    static cv::Rect HotbarBounds(cv::Size frameSize, int scale);
+    
+private:
+    bool Locate(const cv::Mat& frame);
+    // How well the slot pattern repeats at a candidate place and scale
+    float LayoutScore(const cv::Mat& frame, const cv::Rect& candidate, int scale) const;
+    int FindSelectedSlot(const cv::Mat& frame) const;
+    int MatchIcon(const cv::Mat& frame, const cv::Rect& icon, float& distance);
+};
+
+// Reads HUD text drawn in Minecraft's bitmap font (chat, scoreboard, action
+// bar, tooltips). Glyphs come from the font atlas, a resource pack's
+// textures/font/ascii.png of 16x16 cells, each stored as one byte per
+// column with a bit per row. A text area is sampled at one frame pixel per
+// GUI pixel and thresholded against its background into the same column
+// bytes; each line is then read left to right by comparing the 8 columns at
+// the next ink against every glyph mask at once, so characters come out in
+// drawing order with their frame positions.
+class FontOCR {
+public:
+    static const int GLYPH_SIZE = 8;      // GUI pixels of a glyph cell
+    static const int LINE_HEIGHT = 9;     // GUI pixels between chat or sidebar lines
+    static const int SPACE_ADVANCE = 4;
+    static const int FIRST_CHAR = 33;     // Printable ASCII read from the atlas
+    static const int LAST_CHAR = 126;
+    static const int GLYPH_BATCH = 4;     // Glyphs compared per SIMD step
+    
+    struct Character {
+        char code = ' ';
+        cv::Rect bounds;    // Frame pixels of the ink, or of the gap for spaces
+        int errors = 0;     // GUI pixels differing from the glyph
+    };
+    
+    struct Line {
+        std::string text;
+        std::vector<Character> characters; // One per character of text
+        cv::Rect bounds;
+        int pixels = 0;     // Ink pixels read as glyphs
+        int errors = 0;     // Ink pixels differing from or left out of glyphs
+    };
+    
+private:
+    struct Glyph {
+        char code = ' ';
+        int leading = 0;    // Empty columns of the cell before the ink
+        int width = 0;      // Columns from the first to the last inked one
+        int advance = 0;    // Columns from this character to the next
+        int pixels = 0;
+    };
+    
+    std::vector<Glyph> glyphs;
+    // Column bytes of each glyph from its first inked column, and the columns
+    // compared: the ink and the empty column after it. Padded to a multiple
+    // of GLYPH_BATCH with entries that match nothing.
+    std::vector<uint64_t> glyphBits;
+    std::vector<uint64_t> glyphMasks;
+    
+    int minContrast = 48;   // Levels text stands out from the background by
+    int maxErrors = 2;      // Pixels a glyph may miss and still be read
+    
+    cv::Mat levels;                 // One value per GUI pixel of the area read
+    std::vector<uint8_t> columns;   // Column bytes of the line being read
+    std::vector<Line> lines;
+    Line candidate;
+    
+public:
+    bool LoadFont(const std::string& path);
+    bool HasFont() const { return !glyphs.empty(); }
+    void SetMinContrast(int contrast) { minContrast = contrast; }
+    void SetMaxErrors(int errors) { maxErrors = errors; }
+    
+    // Reads every line of text in a frame area of a CV_8UC4, CV_8UC3 or CV_8U
+    // image drawn at a GUI scale. The GUI pixel grid starts at the image's
+    // top-left corner, so crops must start on it. Lines are found from the
+    // rows holding ink; the vertical phase of each is the one whose glyphs fit.
+    const std::vector<Line>& ReadLines(const cv::Mat& image, const cv::Rect& area, int scale);
+    // Reads one line whose glyph cells start at a known frame row, such as a
+    // sidebar line. Returns false if no character was read.
+    bool ReadLine(const cv::Mat& image, cv::Point origin, int width, int scale, Line& line);
+    // Hash of the ink ReadLine would read there, 0 if there is none. Unlike
+    // a hash of the pixels it stays the same while the world moves behind a
+    // translucent background.
+    uint64_t HashLineInk(const cv::Mat& image, cv::Point origin, int width, int scale);
+    
+private:
+    // Samples the GUI pixels of an area, GUI-pixel aligned, into levels
+    cv::Rect SampleLevels(const cv::Mat& image, const cv::Rect& area, int scale);
+    int BackgroundLevel() const;
+    // Column bytes of the ink in the glyph cells of levels starting at row
+    // top; false if nothing there stands out from the background
+    bool FindInk(int top, int background);
+    // Reads the glyph cells of levels starting at row top
+    void ReadRow(int top, int background, cv::Point gridOrigin, int scale, Line& line);
+    // Glyph read at the ink starting a window of 8 column bytes, -1 if none
+    int MatchGlyph(uint64_t window, int& errors) const;
+};
+
+// Draws random lines from the cells of the given font atlas, as Minecraft
+// does and independently of the glyphs FontOCR decodes from it, over noisy
+// backgrounds at GUI scales 1 to 4 and reads them back. Half of the lines
+// change color part way, some to dark gray after bright text. Prints the
+// character, line and position accuracy and the time per line. Fails below
+// 99% of characters.
+int RunFontOCRBenchmark(const std::string& fontPath, int lineCount);
+
+// Reads the scoreboard sidebar, where Hypixel Skyblock shows the area and
+// the buffs and abilities in effect. Minecraft draws it at the right edge,
+// centered vertically, one line every LINE_HEIGHT GUI pixels. A full read
+// finds the lines in the right third of the frame and keeps a slot for every
+// line position between the first and the last, blank ones included. After
+// that a slot is read again only once the hash of its ink changed; when
+// most slots changed at once (a line added or removed moves all the others)
+// or a line grew past the area read, everything is read again.
+class SidebarReader {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Values {
+        std::string area;              // Known area the sidebar names, empty if none
+        int miningSpeed = -1;          // Shown mining speed, -1 if not shown
+        int miningSpeedBuff = 0;       // Percent from "+N% Mining Speed" lines
+        bool speedBoostActive = false; // Mining Speed Boost ability running
+    };
+    
+    static const int MARGIN = 2;       // GUI pixels of background left of the widest line
+    static const int SEARCH_INTERVAL_MS = 1000; // Between full searches while no sidebar is found
+    
+private:
+    struct Slot {
+        int y = 0;                     // Frame row of the line's glyph cells
+        uint64_t hash = 0;             // Of the thresholded ink, see FontOCR::HashLineInk
+        bool changed = false;          // Hash differed on the last update
+        std::string text;
+    };
+    
+    FontOCR ocr;
+    cv::Size frameSize;
+    int guiScale = 0;
+    cv::Rect searchArea;               // Searched on a full read, GUI aligned
+    cv::Rect lineArea;                 // The sidebar's background, where lines are read and hashed
+    std::vector<Slot> slots;
+    std::vector<std::string> lines;    // Text of every slot, top to bottom
+    Values values;
+    FontOCR::Line line;
+    bool searched = false;             // A full read ran since the last Reset()
+    Clock::time_point lastSearch;
+    uint64_t linesRead = 0;
+    uint64_t fullReads = 0;
+    
+public:
+    // Minecraft's font atlas, see FontOCR::LoadFont
+    bool LoadFont(const std::string& path) { return ocr.LoadFont(path); }
+    bool HasFont() const { return ocr.HasFont(); }
+    
+    // Reads the sidebar of a frame drawn at a GUI scale. Returns true if the
+    // text of a line changed, and with it possibly the values. While no
+    // sidebar is found the search is repeated every SEARCH_INTERVAL_MS of
+    // frame time, not on every frame.
+    bool Update(const cv::Mat& frame, int scale, Clock::time_point frameTime);
+    void Reset();
+    
+    // Frame pixels the sidebar is read from; the whole search area before
+    // the first lines were found
+    cv::Rect GetRegion() const { return slots.empty() ? searchArea : lineArea; }
+    // The sidebar's lines, empty until they were found
+    cv::Rect GetLineArea() const { return slots.empty() ? cv::Rect() : lineArea; }
+    const std::vector<std::string>& GetLines() const { return lines; }
+    const Values& GetValues() const { return values; }
+    uint64_t GetLinesRead() const { return linesRead; }
+    uint64_t GetFullReads() const { return fullReads; }
+    
+    // Values named by sidebar lines; the score numbers Minecraft appends on
+    // the right are ignored
+    static Values Parse(const std::vector<std::string>& lines);
+    
+private:
+    bool ReadAll(const cv::Mat& frame, Clock::time_point frameTime);
+    uint64_t HashSlot(const cv::Mat& frame, const Slot& slot);
+};
+
+#ifdef _WIN32
+// Persistent GDI capture context backed by reusable 32-bit DIB sections.
+// Frames are returned as CV_8UC4 (BGRA) views onto the DIB memory, so no
+// per-frame allocation or color conversion takes place. Two buffers are
+// alternated so the previous frame stays intact while the next one is grabbed.
+class ScreenCaptureContext {
+private:
+    struct DibBuffer {
+        HBITMAP bitmap = nullptr;
+        void* bits = nullptr;
+        cv::Mat view;
+    };
+    
+    static const int BUFFER_COUNT = 2;
+    
+    HDC screenDC = nullptr;
+    HDC memoryDC = nullptr;
+    HGDIOBJ defaultBitmap = nullptr;
+    DibBuffer buffers[BUFFER_COUNT];
+    int nextBuffer = 0;
+    cv::Size bufferSize;
+    
+public:
+    ScreenCaptureContext() = default;
+    ~ScreenCaptureContext();
+    ScreenCaptureContext(const ScreenCaptureContext&) = delete;
+    ScreenCaptureContext& operator=(const ScreenCaptureContext&) = delete;
+    
+    // Grabs the given screen rectangle; the returned Mat is valid until the
+    // buffer is reused two captures later or the capture size changes
+    cv::Mat Capture(int screenX, int screenY, int width, int height);
+    // Copies only the given regions (relative to screenX/screenY) of a capture
+    // of target's size into target, one BitBlt per region
+    bool CaptureRegions(int screenX, int screenY, const std::vector<cv::Rect>& regions, cv::Mat& target);
+    void Release();
+    
+private:
+    bool EnsureBuffers(int width, int height);
+    void ReleaseBuffers();
+};
+#endif
+
+// Interface the bots pull game frames from. Grab() may return a view onto
+// memory owned by the source; it stays valid until the next Grab() call.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    
+    virtual bool Open() = 0;
+    virtual bool Grab(cv::Mat& frame) = 0;
+    
+    // Refreshes only the given frame-relative regions of a caller-owned frame
+    // and leaves its other pixels untouched. When frame does not match the
+    // source size it is re-grabbed as a whole and fullRefresh is set. The
+    // default grabs everything and copies the regions; sources that can read
+    // sub-rectangles directly override it.
+    virtual bool GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh);
+    virtual bool IsFinished() const { return false; }
+    virtual std::string GetName() const = 0;
+    
+    // Screen-space rectangle the last grabbed frame was taken from
+    cv::Rect GetLastCaptureRect() const { return lastCaptureRect; }
+    
+protected:
+    cv::Rect lastCaptureRect;
+};
+
+#ifdef _WIN32
+// Live capture of a game window through BitBlt
+class WindowFrameSource : public FrameSource {
+private:
+    HWND window;
+    bool gameAreaOnly;
+    ScreenCaptureContext captureContext;
+    
+public:
+    WindowFrameSource(HWND targetWindow, bool captureGameAreaOnly = false);
+    
+    bool Open() override;
+    bool Grab(cv::Mat& frame) override;
+    bool GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh) override;
+    std::string GetName() const override { return "window"; }
+    
+private:
+    bool GetCaptureArea(cv::Rect& area) const;
+};
+#endif
+
+#ifdef MINECRAFTAI_HAVE_XSHM
+// Linux capture of an X11 window through MIT-SHM shared-memory images.
+// XShmGetImage writes straight into a reusable shared segment that the
+// returned CV_8UC4 Mat wraps, so steady-state grabs neither copy nor allocate.
+class X11ShmFrameSource : public FrameSource {
+private:
+    struct X11State; // Keeps Xlib headers (and their macros) out of this header
+    std::unique_ptr<X11State> x11;
+    std::string windowTitle;
+    unsigned long windowId = 0;
+    std::string displayName;
+    cv::Mat frameView;
+    
+public:
+    // Finds the client window by title; an empty title tries the known client names
+    X11ShmFrameSource(const std::string& title = "", const std::string& display = "");
+    // Captures an already known window (used by the Xvfb benchmark)
+    X11ShmFrameSource(unsigned long window, const std::string& display = "");
+    ~X11ShmFrameSource();
+    
+    bool Open() override;
+    bool Grab(cv::Mat& frame) override;
+    bool GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh) override;
+    std::string GetName() const override { return "x11shm"; }
+    
+private:
+    void ProcessEvents();
+    bool EnsureImage(int width, int height);
+    void ReleaseImage();
+};
+
+// Captures synthetic windows on the current DISPLAY (e.g. Xvfb), verifies the
+// captured pixels and prints frames/s and us/frame at 1080p and 1440p
+int RunX11CaptureBenchmark(int frameCount);
+#endif
+
+// Frame-relative region the capture thread refreshes at its own rate
+// (intervalMs 0 refreshes it on every capture)
+struct CaptureRegion {
+    cv::Rect rect;
+    int intervalMs = 0;
+};
+
+// Capture state of one scheduled region inside a CapturedFrame
+struct CapturedRegion {
+    cv::Rect rect;
+    uint64_t sequence = 0;          // Capture that last refreshed the region
+    uint64_t version = 0;           // Used by the capture thread to update slots
+};
+
+// Frame produced by the capture thread. The sequence number increases by one
+// per captured frame so consumers can detect dropped or repeated frames.
+// In partial capture mode the image is a sparse frame: full size, but only
+// the scheduled regions are refreshed, each at its own rate, and the other
+// pixels keep the content of the last full refresh.
+struct CapturedFrame {
+    cv::Mat image;
+    uint64_t sequence = 0;
+    std::chrono::steady_clock::time_point captureTime;
+    cv::Rect windowRect;
+    std::vector<CapturedRegion> regions; // Empty for full-frame captures
+    uint64_t fullRefreshVersion = 0;
+};
+
+// Dedicated capture thread that keeps grabbing from a FrameSource into a
+// triple buffer, decoupling capture from the processing stages
+class FrameCaptureThread {
+private:
+    FrameSource* source;
+    TripleBuffer<CapturedFrame> frames;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::chrono::milliseconds captureInterval;
+    uint64_t nextSequence = 1;
+    std::atomic<uint64_t> publishedFrames{0};
+    std::atomic<uint64_t> failedGrabs{0};
+    
+    // Partial capture schedule, handed over from the consumer under regionMutex
+    std::mutex regionMutex;
+    std::vector<CaptureRegion> requestedRegions;
+    std::atomic<bool> regionsChanged{false};
+    
+    // Owned by the capture thread
+    struct ScheduledRegion {
+        CapturedRegion state;
+        std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point due;
+    };
+    std::vector<ScheduledRegion> schedule;
+    cv::Mat composite;              // Newest pixels of every region
+    uint64_t fullRefreshVersion = 0;
+    uint64_t nextVersion = 1;
+    std::atomic<uint64_t> capturedPixels{0};
+    
+public:
+    FrameCaptureThread(FrameSource* frameSource, int intervalMs);
+    ~FrameCaptureThread();
+    
+    void Start();
+    void Stop();
+    bool IsRunning() const { return running; }
+    bool WaitForFirstFrame(int timeoutMs);
+    
+    // Single consumer only. Returns the newest complete frame (nullptr before the
+    // first one); it stays valid until the next call to Latest()
+    const CapturedFrame* Latest();
+    uint64_t GetPublishedFrames() const { return publishedFrames; }
+    uint64_t GetFailedGrabs() const { return failedGrabs; }
+    uint64_t GetCapturedPixels() const { return capturedPixels; }
+    
+    // Switches to partial capture of the given regions; an empty list goes
+    // back to full-frame grabs. Safe to call while the thread runs.
+    void SetRegions(const std::vector<CaptureRegion>& regions);
+    
+private:
+    void CaptureLoop();
+    bool CaptureFull(cv::Mat& grabbed);
+    bool CaptureScheduledRegions();
+    void ApplyRegionChanges();
+    void UpdateSlot(CapturedFrame& slot);
+};
+
+// Headless replay of a PNG frame directory or a video file at a fixed rate
+class FileFrameSource : public FrameSource {
+private:
+    std::string sourcePath;
+    double framesPerSecond;
+    bool loopPlayback;
+    
+    std::vector<std::string> framePaths;
+    size_t nextFrameIndex = 0;
+    cv::VideoCapture video;
+    bool isVideo = false;
+    std::atomic<bool> finished{false}; // Read by the bot while the capture thread grabs
+    
+    cv::Mat decodedFrame;
+    cv::Mat outputFrame;
+    std::chrono::steady_clock::time_point nextFrameTime;
+    
+public:
+    // framesPerSecond <= 0 replays as fast as frames can be decoded
+    FileFrameSource(const std::string& path, double fps = 10.0, bool loop = false);
+    
+    bool Open() override;
+    bool Grab(cv::Mat& frame) override;
+    bool IsFinished() const override { return finished; }
+    std::string GetName() const override { return "file:" + sourcePath; }
+    size_t GetFrameCount() const;
+    
+private:
+    bool ReadNextImage(cv::Mat& image);
+};
+
 // Main AI controller class
 class MinecraftAI {
 private:
@@ -147,6 +1460,9 @@ private:
     std::unique_ptr<PerformanceMonitor> perfMonitor;
     std::unique_ptr<ThreadPool> threadPool;
     std::unique_ptr<ImageProcessingCache> imageCache;
+    std::unique_ptr<SessionRecorder> recorder;
+    std::mutex recorderMutex;
+    uint64_t lastRecordedSequence = 0;
     
     std::atomic<bool> running{false};
     std::atomic<bool> paused{false};
@@ -160,16 +1476,24 @@ private:
     
     std::chrono::steady_clock::time_point startTime;
     
+    // Frame pipeline of OptimizedMainExecutionLoop
+    static const int PIPELINE_QUEUE_SIZE = 2;
+    std::atomic<bool> actionPending{false}; // A decision not yet carried out by the actuate stage
+    std::chrono::steady_clock::time_point lastDecisionTime; // Decide stage only
+    
 public:
     MinecraftAI();
     ~MinecraftAI();
     
-    bool Initialize();
+    bool Initialize(std::unique_ptr<FrameSource> frameSource = nullptr);
     void Start();
     void Stop();
     void Pause();
     void Resume();
     void TrainFromVideos(const std::vector<std::string>& videoPaths);
+    bool IsRunning() const { return running; }
+    bool StartRecording(const std::string& directory, bool compressFrames = true);
+    void StopRecording();
     void AddKnownPlayer(const std::string& playerName);
     void RemoveKnownPlayer(const std::string& playerName);
     
@@ -185,6 +1509,11 @@ private:
     void OptimizedMainExecutionLoop(); // New optimized version
     void ProcessGameState();
     void ExecuteActions();
+    // ExecuteActions in two steps: the decision on frame.state, then the
+    // inputs for it. DecideActions returns false if there is nothing to send.
+    bool DecideActions(PipelineFrame& frame);
+    void PerformActions(const PipelineFrame& frame);
+    void HandleStageError(const std::string& stage, std::exception_ptr error, int consecutiveErrors);
     void UpdateStatistics();
     void SaveMemoryToFile();
     void LoadMemoryFromFile();
@@ -204,21 +1533,34 @@ public:
         int strength = 0;
         double critChance = 5.0;
         double critDamage = 50.0;
+        std::string area;        // Where the sidebar says the player is
+        int miningSpeedBuff = 0; // Percent on top of miningSpeed from buffs and abilities
     };
     
 private:
     Stats currentStats;
     std::unordered_map<std::string, double> toolMultipliers;
+    int speedBoostPercent = 200; // Mining speed the Mining Speed Boost ability adds
+    // Sidebar reader to the thread estimating break times, without locks
+    TripleBuffer<SidebarReader::Values> sidebarValues;
     
 public:
     SkyblockStats();
     
     void LoadStatsFromConfig(const std::string& configFile);
     double GetMiningSpeed(const std::string& tool, const std::string& block);
+    // Speed multiplier of a tool, 0 for items that are no known tool
+    double GetToolMultiplier(const std::string& tool) const;
     double GetMovementSpeed();
     void UpdateStats(const Stats& newStats);
+    // Hands the values of the sidebar to the thread calling GetMiningSpeed,
+    // which applies them through UpdateStats. One thread may publish.
+    void PublishSidebar(const SidebarReader::Values& values);
     void SetMiningSpeedMultiplier(double multiplier);
     Stats GetCurrentStats() const { return currentStats; }
+    
+private:
+    void ApplySidebar();
 };
 
 // Humanization engine for natural movements
@@ -288,6 +1630,8 @@ public:
     PlayerDetector();
     
     void UpdateDetection(const cv::Mat& gameFrame);
+    // Runs on a pyramid level of a shared frame, reusing its gray/HSV images
+    void UpdateDetection(const FrameContext& context, int level = 0);
     std::vector<Player> GetNearbyPlayers(double maxDistance = -1);
     bool IsPlayerNearby(const std::string& playerName = "", double radius = -1);
     void AddKnownPlayer(const std::string& name);
@@ -297,7 +1641,7 @@ public:
     int GetPlayerCount() const { return static_cast<int>(detectedPlayers.size()); }
     
 private:
-    std::vector<cv::Rect> DetectPlayerSilhouettes(const cv::Mat& frame);
+    std::vector<cv::Rect> DetectPlayerSilhouettes(const cv::Mat& gray, const cv::Mat& hsv);
     std::string ExtractPlayerName(const cv::Rect& playerRegion, const cv::Mat& frame);
     double CalculateDistance(const cv::Point2f& pos1, const cv::Point2f& pos2);
     bool IsValidPlayerDetection(const cv::Rect& region, const cv::Mat& frame);
@@ -320,6 +1664,9 @@ private:
     std::vector<std::string> responseTemplates;
     cv::Rect chatRegion;
     bool enabledResponses = true;
+    FontOCR ocr;
+    std::atomic<int> guiScale{0};          // Set by the bot once the hotbar is located
+    std::vector<std::string> visibleLines; // Chat lines of the previous read
     
 public:
     ChatHandler(const std::string& botPlayerName);
@@ -331,12 +1678,13 @@ public:
     void SendWhisper(const std::string& playerName, const std::string& message);
     void SetBotName(const std::string& name) { botName = name; }
     void EnableResponses(bool enabled) { enabledResponses = enabled; }
+    void SetGuiScale(int scale) { guiScale = scale; }
     
 private:
-    std::string ExtractChatText(const cv::Mat& chatRegion);
+    // Chat lines top to bottom, read with the font atlas
+    std::vector<std::string> ExtractChatLines(const cv::Mat& gameFrame);
     void ParseChatMessage(const std::string& rawText);
     std::string GenerateResponse(const ChatMessage& message);
-    char RecognizeCharacter(const cv::Mat& charRegion);
     bool CheckIfMentioned(const std::string& message);
 };
 
@@ -355,26 +1703,69 @@ public:
         cv::Mat screenshot;
         cv::Point2f playerPosition;
         cv::Point2f lookDirection;
-        std::string currentTool;
+        std::string currentTool;       // Item in the selected hotbar slot, empty if unknown
+        int selectedSlot = -1;
+        std::vector<std::string> hotbarItems; // Per slot, empty until the hotbar is read
         std::vector<cv::Rect> detectedBlocks;
+        std::vector<std::string> detectedBlockTypes; // Parallel to detectedBlocks
+        std::vector<uint32_t> detectedBlockIds;      // Tracker ids parallel to detectedBlocks, empty without tracking
+        uint64_t frameSequence = 0;
+        std::chrono::steady_clock::time_point captureTime;
+        std::chrono::steady_clock::time_point detectionTime;
+        cv::Rect windowRect;
+        std::shared_ptr<const FrameContext> frameContext; // Derived images of screenshot
         bool isBlockBroken = false;
-        std::string currentBlockType;
+        std::string currentBlockType;  // Block under the crosshair
+        uint64_t targetChanges = 0;    // Times the block under the crosshair changed so far
+        uint64_t miningGeneration = 0; // Mining start isBlockBroken refers to
+        float crackLevel = 0.0f;       // Crack overlay on the mined block, 0 to 1
+        cv::Point2f cameraOffset;      // Camera motion summed over all frames, level 0 pixels
         std::vector<PlayerDetector::Player> nearbyPlayers;
         bool shouldRespondToPlayer = false;
         std::string pendingChatResponse;
+        std::vector<std::string> mentionedBy; // Players who mentioned the bot in chat lately
+        
+        // Tracker id of a detected block, 0 when untracked
+        uint32_t GetBlockId(size_t index) const {
+            return index < detectedBlockIds.size() ? detectedBlockIds[index] : 0;
+        }
     };
     
+    // Immutable snapshot of a processed frame, shared by reference count
+    using StateHandle = std::shared_ptr<const GameState>;
+    
 protected: // Changed from private to protected for inheritance
+    friend class MinecraftAI;
+    
     HWND minecraftWindow;
-    GameState currentState;
+    std::unique_ptr<FrameSource> frameSource;
+    std::unique_ptr<FrameCaptureThread> captureThread;
+    GameState currentState;        // Working copy, only touched by the capture/detect stage
+    StateHandle publishedState = std::make_shared<const GameState>(); // Swapped with std::atomic_store
     HumanizationEngine* humanizer;
     SkyblockStats* stats;
     PlayerDetector* playerDetector;
     ChatHandler* chatHandler;
+    BlockClassifier blockClassifier;
+    TextureClassifier textureClassifier;
+    RegionStatsEngine regionStats; // Rebuilt for every batch of identified blocks
+    CrosshairProbe crosshairProbe;
+    HotbarReader hotbarReader;
+    SidebarReader sidebarReader;
     
     cv::Point2f currentMiningTarget;
-    bool isMining = false;
+    cv::Point2f targetCameraOffset; // cameraOffset of the frame the target was picked on
+    uint32_t currentTargetId = 0; // Tracker id of the mined block, 0 when untracked
+    std::atomic<bool> isMining{false};
+    std::atomic<uint64_t> miningGeneration{0}; // Counts StartMining clicks
     std::chrono::steady_clock::time_point miningStartTime;
+    BlockBreakDetector breakDetector;     // Capture/detect stage only
+    
+    // Latency tracing of the decision the next input belongs to
+    PerformanceMonitor* perfMonitor = nullptr;
+    std::chrono::steady_clock::time_point decisionCaptureTime;
+    std::chrono::steady_clock::time_point decisionTime;
+    bool inputPending = false;
     
     // GUI controllable parameters
     std::string miningMode = "blocks";
@@ -388,12 +1779,24 @@ public:
     virtual ~MinecraftBot() = default;
     
     bool FindMinecraftWindow();
+    void SetFrameSource(std::unique_ptr<FrameSource> source);
+    bool HasFrameSource() const { return frameSource != nullptr; }
+    bool IsFrameSourceFinished() const { return frameSource && frameSource->IsFinished(); }
+    bool StartCaptureThread(int intervalMs);
+    void StopCaptureThread();
+    void SetPerformanceMonitor(PerformanceMonitor* monitor) { perfMonitor = monitor; }
+    // Stamps the decision taken on a frame; the next input records its latency
+    void BeginDecision(std::chrono::steady_clock::time_point frameCaptureTime,
+                       std::chrono::steady_clock::time_point decidedAt);
     virtual void CaptureGameState();
     void ExecuteAction(ActionType action);
-    void StartMining(cv::Point2f blockPosition);
+    // cameraOffset is the one of the state the block was picked from
+    void StartMining(cv::Point2f blockPosition, uint32_t blockId = 0, cv::Point2f cameraOffset = cv::Point2f());
     void StopMining();
     bool IsBlockBroken();
     void MoveToNextBlock();
+    // Mining target moved by the camera motion between its frame and state
+    cv::Point2f GetMiningTarget(const GameState& state) const;
     
     // GUI control methods
     void SetMiningMode(const std::string& mode) { miningMode = mode; }
@@ -402,24 +1805,47 @@ public:
     void SetPauseOnPlayer(bool enabled) { pauseOnPlayer = enabled; }
     void SetActionDelay(int delayMs) { actionDelayMs = delayMs; }
     
-    GameState GetCurrentState() const { return currentState; }
+    // Handle to the newest complete state, never null. Snapshots are never
+    // modified after publishing, so readers need no locking or copying.
+    StateHandle GetCurrentState() const { return std::atomic_load(&publishedState); }
     
 protected: // Made protected for inheritance
     void SendMouseMove(cv::Point2f delta);
     void SendClick(bool leftClick = true);
     void SendKeyPress(int keyCode);
+    void RecordInputLatency();
+    // Publishes a snapshot of currentState for GetCurrentState()
+    void PublishState();
     cv::Mat CaptureScreen();
+    virtual bool UseGameAreaCapture() const { return false; }
     std::vector<cv::Rect> DetectBlocks(const cv::Mat& image);
     std::string IdentifyBlockType(const cv::Rect& blockRegion, const cv::Mat& image);
+    std::vector<std::string> IdentifyBlockTypes(const std::vector<cv::Rect>& blocks, const cv::Mat& image);
+    // Samples the block under the crosshair of currentState; true if it changed
+    bool UpdateCrosshairTarget();
+    // Sets isBlockBroken of currentState from the crosshair samples
+    void UpdateBreakDetection();
+    // Reads the hotbar into currentTool, selectedSlot and hotbarItems
+    void UpdateHotbar();
+    void UpdateSidebar();
+    // Slot of the fastest known tool in the hotbar, -1 if there is none
+    int FindBestToolSlot(const GameState& state) const;
     double CalculateMiningTime(const std::string& blockType);
 };
 
 // Enhanced MinecraftBot with performance optimizations
 class OptimizedMinecraftBot : public MinecraftBot {
+public:
+    enum class BlockDetectorType {
+        CONTOUR, // Canny + findContours, filtered by box shape
+        GRID     // GridBlockDetector, fitted voxel lattice
+    };
+    
 private:
     cv::Mat lastScreenshot;
-    std::chrono::steady_clock::time_point lastCaptureTime;
-    static const int CAPTURE_INTERVAL_MS = 100; // Limit to 10 FPS
+    uint64_t lastFrameSequence = 0;
+    uint64_t droppedFrames = 0;
+    uint64_t repeatedFrames = 0;
     
     // ROI (Region of Interest) optimization
     cv::Rect miningROI;
@@ -428,22 +1854,347 @@ private:
     
     // Image processing cache
     cv::Mat processedImage;
-    cv::Mat grayImage;
-    std::vector<cv::Rect> cachedBlocks;
+    BlockTracker blockTracker; // Carries detected blocks between detection passes
     std::chrono::steady_clock::time_point lastBlockDetection;
+    BlockDetectorType blockDetector = BlockDetectorType::CONTOUR;
+    TiledBlockDetector contourDetector;
+    ThreadPool* detectionPool = nullptr; // Workers for the contour detector tiles
+    GridBlockDetector gridDetector;
+    std::vector<cv::Rect> gridBlocks;
+    
+    // Camera motion carries the tracks between passes; the strip it moved into
+    // the mining ROI is searched on its own
+    CameraMotionEstimator cameraMotion;
+    cv::Point2f exposedShift; // Camera motion not yet covered by a detection pass
+    ContourBlockDetector stripDetector; // Strips are narrow, one pass without tiles
+    std::vector<cv::Rect> stripBlocks;
+    uint64_t stripDetections = 0;
+    
+    // Change detection, work is skipped while the regions it reads are static.
+    // The map belongs to the preprocess stage, detection reads the copy each
+    // frame carries.
+    TileChangeMap tileChanges;
+    uint64_t processedSequence = 0; // Last frame through ProcessRelevantRegions
+    uint64_t blockDetectionSequence = 0;
+    uint64_t chatSequence = 0;
+    uint64_t hotbarSequence = 0;
+    uint64_t sidebarSequence = 0;
+    uint64_t playerSequence = 0;
+    uint64_t skippedDetections = 0;
+    
+    // Partial capture schedule last handed to the capture thread
+    bool partialCapture = true;
+    std::vector<CaptureRegion> scheduledRegions;
+    const FrameCaptureThread* scheduledThread = nullptr;
     
 public:
+    static const int CAPTURE_INTERVAL_MS = 100; // Capture thread rate, 10 FPS
+    static const int HUD_REFRESH_MS = 250;      // Chat and other HUD regions
+    static const int FULL_REFRESH_MS = 500;     // Whole view (player detection)
+    static const int BLOCK_DETECTION_MS = 500;  // Background rate of the mining ROI detector
+    static const int MIN_EXPOSED_SHIFT = 8;     // Camera motion (px) before the exposed strip is searched
+    
     OptimizedMinecraftBot(HumanizationEngine* h, SkyblockStats* s, PlayerDetector* pd, ChatHandler* ch);
     
+    // Runs the three pipeline stages below in turn
     void CaptureGameState() override;
     
+    // Stages of CaptureGameState for a FramePipeline. Each one is called by
+    // one thread at a time and in frame order, so different frames can be in
+    // different stages at once.
+    // Newest frame of the capture thread; false if there is none since the last one
+    bool CaptureFrame(PipelineFrame& frame);
+    // Frame context with the derived images detection reads, and tile hashes
+    void PreprocessFrame(PipelineFrame& frame);
+    // Tracking, detection and HUD readers; publishes the state into frame.state
+    void DetectFrame(PipelineFrame& frame);
+    uint64_t GetDroppedFrames() const { return droppedFrames; }
+    uint64_t GetRepeatedFrames() const { return repeatedFrames; }
+    uint64_t GetSkippedDetections() const { return skippedDetections; }
+    uint64_t GetStripDetections() const { return stripDetections; }
+    const BlockTracker& GetBlockTracker() const { return blockTracker; }
+    
+    // Capture only the active ROIs, each at its own rate (on by default)
+    void SetPartialCapture(bool enabled) { partialCapture = enabled; }
+    void SetBlockDetector(BlockDetectorType type) { blockDetector = type; }
+    BlockDetectorType GetBlockDetector() const { return blockDetector; }
+    // Contour detection of large ROIs runs on these workers as well (null: calling thread only)
+    void SetDetectionPool(ThreadPool* pool) { detectionPool = pool; }
+    
+protected:
+    bool UseGameAreaCapture() const override { return true; }
+    
 private:
     cv::Mat CaptureOptimizedScreen();
     void UpdateROIs();
-    void ProcessRelevantRegions();
-    std::vector<cv::Rect> DetectBlocksOptimized(const cv::Mat& roi, cv::Point offset);
+    void ProcessRelevantRegions(const TileChangeMap& changes);
+    const std::vector<cv::Rect>& DetectBlocksOptimized(const FrameContext& context, const cv::Rect& roi);
+    // Contour passes over the strips the camera motion brought into the
+    // mining ROI; false if there was nothing to search
+    bool DetectExposedStrips(const FrameContext& context, std::chrono::steady_clock::time_point now);
 };
 
+// One frame on its way through the FramePipeline stages, each stage fills in
+// its part. Frames are moved from queue to queue, never copied.
+struct PipelineFrame {
+    // Capture
+    cv::Mat image;
+    uint64_t sequence = 0;
+    std::chrono::steady_clock::time_point captureTime;
+    cv::Rect windowRect;
+    
+    // Preprocess
+    std::shared_ptr<const FrameContext> context;
+    TileChangeMap changes; // As of this frame
+    
+    // Detect
+    MinecraftBot::StateHandle state;
+    
+    // Decide
+    std::chrono::steady_clock::time_point decisionTime;
+    MinecraftBot::ActionType action = MinecraftBot::ActionType::IDLE;
+    cv::Point2f target;
+    uint32_t targetId = 0;
+    bool pauseForPlayer = false;
+    std::vector<std::string> chatResponses;
+};
+
+// Frame processing split into stages that each run on their own thread and
+// hand frames on through bounded HandoffQueues, so a frame can be captured and
+// preprocessed while the one before it is still being decided on. A stage
+// function returns false to drop the frame; the first stage is the source
+// and fills an empty frame. The report shows each stage's rate and load.
+class FramePipeline {
+public:
+    enum class Backpressure {
+        DROP_OLDEST, // A full queue drops its oldest frame, the stage before it never waits
+        BLOCK        // The stage before a full queue waits, no frame is lost
+    };
+    
+    using StageFunction = std::function<bool(PipelineFrame& frame)>;
+    using ErrorHandler = std::function<void(const std::string& stage, std::exception_ptr error, int consecutiveErrors)>;
+    
+    struct StageStats {
+        std::string name;
+        uint64_t processed = 0;   // Frames passed on
+        uint64_t rejected = 0;    // Frames the stage function dropped
+        uint64_t dropped = 0;     // Frames dropped from the full input queue
+        uint64_t errors = 0;
+        double framesPerSecond = 0.0;
+        double busy = 0.0;        // Share of the run spent in the stage function
+        double queueFill = 0.0;   // Mean input queue length when the stage took a frame
+        size_t queueCapacity = 0; // 0 for the source
+        double meanMs = 0.0;
+        double p95Ms = 0.0;
+    };
+    
+    static const int SOURCE_IDLE_MS = 2;   // Pause after the source had no frame
+    static const int WAIT_TIMEOUT_MS = 50; // Longest wait, so every stage sees Stop
+    
+private:
+    struct Stage;
+    
+    std::vector<std::unique_ptr<Stage>> stages;
+    std::atomic<bool> running{false};
+    ErrorHandler errorHandler;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point stopTime;
+    
+public:
+    FramePipeline();
+    ~FramePipeline();
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+    
+    // Appends a stage; its input queue holds queueCapacity frames and fills
+    // up with the given backpressure (both unused for the first stage)
+    void AddStage(const std::string& name, StageFunction function, size_t queueCapacity = 2,
+                  Backpressure backpressure = Backpressure::DROP_OLDEST);
+    // Called on the stage's thread for exceptions of a stage function, with
+    // the stage's errors since its function last returned normally; the
+    // frame is dropped and the stage goes on
+    void SetErrorHandler(ErrorHandler handler) { errorHandler = std::move(handler); }
+    
+    void Start();
+    void Stop();
+    bool IsRunning() const { return running; }
+    
+    std::vector<StageStats> GetStats() const;
+    // Per-stage rates, loads and queues; the busiest stage is the bottleneck
+    void PrintReport() const;
+    
+private:
+    void RunStage(size_t index);
+    void PassOn(Stage& stage, Stage& next, PipelineFrame& frame);
+};
+
+// Hands numbered items through HandoffQueues of a few capacities, the
+// producer dropping the oldest on a full queue as a DROP_OLDEST stage does,
+// against a consumer taking them as fast as it can. Fails unless every item
+// was either taken or dropped exactly once, each side in order.
+int RunHandoffQueueStress(int itemCount);
+
+// Read/write memory mapping of a whole file (CreateFileMapping or mmap)
+class MappedFile {
+private:
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool writable = false;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+    
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool Create(const std::string& path, size_t fileSize);
+    bool OpenReadOnly(const std::string& path);
+    // Unmaps the file; writable files are truncated to finalSize when it is non-zero
+    void Close(size_t finalSize = 0);
+    
+    uint8_t* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+};
+
+// On-disk layout of session recordings. A session is a directory of chunk
+// files (chunk_00000.mcrec, ...), each starting with a ChunkHeader followed by
+// 8-byte aligned records: RecordHeader, blockCount RecordBlock entries, then
+// the frame payload (raw rows or the lossless QOI-style codec).
+namespace SessionFormat {
+    const uint64_t CHUNK_MAGIC = 0x3130304345524D4DULL; // "MMREC001"
+    const uint32_t RECORD_MAGIC = 0x4D415246;           // "FRAM"
+    const uint32_t VERSION = 1;
+    
+    enum Codec : uint8_t {
+        CODEC_RAW = 0,
+        CODEC_QOI = 1
+    };
+
+#pragma pack(push, 1)
+    struct ChunkHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t chunkIndex;
+        uint64_t recordCount;
+        uint64_t usedBytes;            // Header included, updated after every record
+        int64_t sessionStartWallUs;    // system_clock at session start
+        int64_t sessionStartSteadyUs;  // steady_clock at session start
+        uint8_t reserved[16];
+    };
+    
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t recordSize;           // Whole record including padding
+        uint64_t frameSequence;
+        int64_t captureTimeUs;         // steady_clock, compare with sessionStartSteadyUs
+        int32_t windowX, windowY, windowWidth, windowHeight;
+        float targetX, targetY;
+        uint8_t action;                // MinecraftBot::ActionType
+        uint8_t codec;
+        uint8_t channels;
+        uint8_t reserved;
+        uint16_t width, height;
+        uint32_t blockCount;
+        uint32_t payloadSize;
+    };
+    
+    struct RecordBlock {
+        int32_t x, y, width, height;
+    };
+#pragma pack(pop)
+}
+
+// Appends every processed frame and the decision taken on it to a chunked,
+// memory-mapped session archive. Record only queues the frame; a writer
+// thread encodes and writes it, and frames arriving while MAX_PENDING are
+// still waiting are dropped.
+class SessionRecorder {
+private:
+    struct PendingRecord {
+        MinecraftBot::StateHandle state;
+        MinecraftBot::ActionType action = MinecraftBot::ActionType::IDLE;
+        cv::Point2f target;
+    };
+    
+    std::string directory;
+    bool compressFrames;
+    size_t chunkSize;
+    uint32_t chunkIndex = 0;
+    MappedFile chunk;
+    size_t writeOffset = 0;
+    uint64_t recordCount = 0;
+    uint64_t totalRecords = 0;
+    uint64_t totalBytes = 0;
+    int64_t sessionStartWallUs = 0;
+    int64_t sessionStartSteadyUs = 0;
+    
+    std::thread writer;
+    std::mutex pendingMutex;
+    std::condition_variable pendingReady;
+    std::deque<PendingRecord> pending;
+    bool stopping = false;
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> droppedRecords{0};
+    
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 256ull * 1024 * 1024;
+    static const size_t MAX_PENDING = 8; // Frames waiting for the writer
+    
+    SessionRecorder(const std::string& outputDirectory, bool compress = true, size_t chunkBytes = DEFAULT_CHUNK_SIZE);
+    ~SessionRecorder();
+    
+    bool Open();
+    // Queues the frame for the writer; false once writing has failed
+    bool Record(MinecraftBot::StateHandle state, MinecraftBot::ActionType action, cv::Point2f target);
+    // Writes what is still queued, then closes the chunk
+    void Close();
+    
+    // Writer side counts, final after Close
+    uint64_t GetRecordCount() const { return totalRecords; }
+    uint64_t GetBytesWritten() const { return totalBytes; }
+    uint64_t GetDroppedRecords() const { return droppedRecords; }
+    
+private:
+    void WriterLoop();
+    bool Write(const MinecraftBot::GameState& state, MinecraftBot::ActionType action, cv::Point2f target);
+    bool OpenChunk(size_t bytes);
+    void FinishChunk();
+};
+
+// Maps a recorded session read-only and walks its records in place
+class SessionReader {
+public:
+    struct Record {
+        const SessionFormat::RecordHeader* header = nullptr;
+        const SessionFormat::RecordBlock* blocks = nullptr;
+        const uint8_t* payload = nullptr;
+    };
+    
+private:
+    std::vector<std::unique_ptr<MappedFile>> chunks;
+    size_t currentChunk = 0;
+    size_t currentOffset = 0;
+    
+public:
+    bool Open(const std::string& directory);
+    bool Next(Record& record);
+    void Rewind();
+    size_t GetChunkCount() const { return chunks.size(); }
+    const SessionFormat::ChunkHeader* GetChunkHeader(size_t index) const;
+    
+    static bool DecodeFrame(const Record& record, cv::Mat& frame);
+};
+
+// Prints record count, frame rate, actions and capture gaps of a recording
+int InspectRecording(const std::string& directory);
+
 // Video learning system
 class VideoLearner {
 private:
@@ -530,26 +2281,177 @@ size_t ObjectPool<T>::size() const {
     return pool.size();
 }
 
-// Template implementation for ThreadPool::enqueue
+// Template implementations for TripleBuffer
+template<typename T>
+void TripleBuffer<T>::Publish() {
+    // Hand the filled slot to the middle and take back whatever was there
+    uint8_t previous = middle.exchange(static_cast<uint8_t>(writeIndex | NEW_DATA), std::memory_order_acq_rel);
+    writeIndex = previous & INDEX_MASK;
+}
+
+template<typename T>
+bool TripleBuffer<T>::Update() {
+    if (!(middle.load(std::memory_order_acquire) & NEW_DATA)) {
+        return false;
+    }
+    
+    uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previous & INDEX_MASK;
+    return true;
+}
+
+// Template implementations for PoolTask
+template<typename F>
+struct PoolTask::InlineOps {
+    static void Invoke(void* storage) { (*static_cast<F*>(storage))(); }
+    static void Move(void* from, void* to) {
+        new (to) F(std::move(*static_cast<F*>(from)));
+        static_cast<F*>(from)->~F();
+    }
+    static void Destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+    static constexpr Ops table = { &Invoke, &Move, &Destroy };
+};
+
+template<typename F>
+struct PoolTask::HeapOps {
+    static void Invoke(void* storage) { (**static_cast<F**>(storage))(); }
+    static void Move(void* from, void* to) { new (to) F*(*static_cast<F**>(from)); }
+    static void Destroy(void* storage) { delete *static_cast<F**>(storage); }
+    static constexpr Ops table = { &Invoke, &Move, &Destroy };
+};
+
+template<typename F, typename>
+PoolTask::PoolTask(F&& f) {
+    using Callable = std::decay_t<F>;
+    
+    if constexpr (sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t) &&
+                  std::is_nothrow_move_constructible<Callable>::value) {
+        new (storage) Callable(std::forward<F>(f));
+        ops = &InlineOps<Callable>::table;
+    } else {
+        new (storage) Callable*(new Callable(std::forward<F>(f)));
+        ops = &HeapOps<Callable>::table;
+    }
+}
+
+// Template implementations for ThreadPool
+template<typename F>
+auto ThreadPool::enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+    using return_type = std::invoke_result_t<std::decay_t<F>&>;
+    
+    // The packaged task moves into the PoolTask; only the future's shared
+    // state is allocated
+    std::packaged_task<return_type()> task(std::forward<F>(f));
+    std::future<return_type> result = task.get_future();
+    
+    Submit([task = std::move(task)]() mutable { task(); });
+    return result;
+}
+
+template<typename Body>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, Body&& body) {
+    if (end <= begin) return;
+    
+    grain = std::max<size_t>(1, grain);
+    const size_t chunks = (end - begin + grain - 1) / grain;
+    std::atomic<size_t> next{0};
+    
+    auto runChunks = [&] {
+        for (size_t chunk = next++; chunk < chunks; chunk = next++) {
+            size_t first = begin + chunk * grain;
+            body(first, std::min(end, first + grain));
+        }
+    };
+    
+    // Helpers that start late find no chunk left and return at once
+    TaskGroup group(*this);
+    size_t helpers = std::min(chunks - 1, workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        group.run([&runChunks] { runChunks(); });
+    }
+    
+    try {
+        runChunks();
+    } catch (...) {
+        next = chunks; // The group's destructor waits for the helpers
+        throw;
+    }
+    group.wait();
+}
+
+// Template implementation for TaskGroup::run
 template<typename F>
-auto ThreadPool::enqueue(F&& f) -> std::future<typename std::result_of<F()>::type> {
-    using return_type = typename std::result_of<F()>::type;
+void TaskGroup::run(F&& f) {
+    pending.fetch_add(1, std::memory_order_relaxed);
     
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::forward<F>(f));
+    try {
+        pool.Submit([this, task = std::forward<F>(f)]() mutable {
+            try {
+                task();
+            } catch (...) {
+                Finish(std::current_exception());
+                return;
+            }
+            Finish(nullptr);
+        });
+    } catch (...) {
+        Finish(nullptr);
+        throw;
+    }
+}
+
+// Template implementations for HandoffQueue
+template<typename T>
+HandoffQueue<T>::HandoffQueue(size_t capacity)
+    : slots(new Slot[std::max<size_t>(2, capacity)]), capacity(std::max<size_t>(2, capacity)) {
+    for (size_t i = 0; i < this->capacity; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+typename HandoffQueue<T>::PushResult HandoffQueue<T>::TryPush(T& item) {
+    size_t index = head.load(std::memory_order_relaxed);
+    if (index - tail.load(std::memory_order_acquire) >= capacity) return PushResult::FULL;
     
-    std::future<return_type> result = task->get_future();
+    // Taken but still being moved out
+    Slot& slot = slots[index % capacity];
+    if (slot.sequence.load(std::memory_order_acquire) != index) return PushResult::BUSY;
     
-    {
-        std::unique_lock<std::mutex> lock(queueMutex);
+    slot.item = std::move(item);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+    return PushResult::PUSHED;
+}
+
+template<typename T>
+bool HandoffQueue<T>::Take(T& item, bool onlyIfFull) {
+    size_t index = tail.load(std::memory_order_relaxed);
+    while (true) {
+        // Only the producer drops and head is its own, so the claim below
+        // fails if the consumer made room after this check
+        if (onlyIfFull && head.load(std::memory_order_relaxed) - index < capacity) return false;
         
-        if (stop) {
-            throw std::runtime_error("enqueue on stopped ThreadPool");
+        Slot& slot = slots[index % capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            // Empty, unless the other side took the item at index meanwhile
+            size_t current = tail.load(std::memory_order_relaxed);
+            if (current == index) return false;
+            index = current;
+            continue;
         }
         
-        tasks.emplace([task]() { (*task)(); });
+        if (tail.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            item = std::move(slot.item);
+            slot.sequence.store(index + capacity, std::memory_order_release);
+            return true;
+        }
     }
-    
-    condition.notify_one();
-    return result;
+}
+
+template<typename T>
+size_t HandoffQueue<T>::Size() const {
+    size_t written = head.load(std::memory_order_acquire);
+    size_t read = tail.load(std::memory_order_acquire);
+    return written > read ? written - read : 0;
 }
\ No newline at end of file
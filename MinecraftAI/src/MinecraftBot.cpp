@@ -1,9 +1,28 @@
 #include "MinecraftAI.h"
 
+namespace {
+
+// Without a visible break the mining time estimate decides, with a margin
+// since the tool and speed behind it are only approximate
+const double BREAK_TIMEOUT_FACTOR = 2.0;
+
+} // namespace
+
 MinecraftBot::MinecraftBot(HumanizationEngine* h, SkyblockStats* s, PlayerDetector* pd, ChatHandler* ch) 
-    : humanizer(h), stats(s), playerDetector(pd), chatHandler(ch), minecraftWindow(nullptr) {}
+    : humanizer(h), stats(s), playerDetector(pd), chatHandler(ch), minecraftWindow(nullptr) {
+    // Table built with --build-block-lut; without it the default thresholds stay
+    blockClassifier.Load("block_colors.lut");
+    // Block textures (e.g. a resource pack's textures/block); they decide
+    // over the color classes wherever one matches
+    textureClassifier.LoadAtlas("block_textures");
+    // Item icons (e.g. a resource pack's textures/item) tell the held tool
+    hotbarReader.LoadIcons("item_icons");
+    // Same font atlas as the chat, for the scoreboard sidebar
+    sidebarReader.LoadFont("font/ascii.png");
+}
 
 bool MinecraftBot::FindMinecraftWindow() {
+#ifdef _WIN32
     minecraftWindow = FindWindowA(nullptr, "Minecraft");
     if (!minecraftWindow) {
         minecraftWindow = FindWindowA(nullptr, "Minecraft 1.8.9");
@@ -15,35 +34,91 @@ bool MinecraftBot::FindMinecraftWindow() {
         minecraftWindow = FindWindowA(nullptr, "Badlion Client");
     }
     
+    if (minecraftWindow && !frameSource) {
+        SetFrameSource(std::make_unique<WindowFrameSource>(minecraftWindow, UseGameAreaCapture()));
+    }
+    
     return minecraftWindow != nullptr;
+#elif defined(MINECRAFTAI_HAVE_XSHM)
+    if (frameSource) return true;
+    
+    // Linux Java clients are captured through MIT-SHM, there is no HWND here
+    auto source = std::make_unique<X11ShmFrameSource>();
+    if (!source->Open()) return false;
+    
+    frameSource = std::move(source);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MinecraftBot::SetFrameSource(std::unique_ptr<FrameSource> source) {
+    frameSource = std::move(source);
+    if (frameSource && !frameSource->Open()) {
+        std::cerr << "Failed to open frame source: " << frameSource->GetName() << std::endl;
+    }
+}
+
+bool MinecraftBot::StartCaptureThread(int intervalMs) {
+    if (!frameSource) return false;
+    
+    StopCaptureThread();
+    captureThread = std::make_unique<FrameCaptureThread>(frameSource.get(), intervalMs);
+    captureThread->Start();
+    
+    // Give the first grab a moment so the first processing pass has a frame
+    return captureThread->WaitForFirstFrame(1000);
+}
+
+void MinecraftBot::StopCaptureThread() {
+    if (captureThread) {
+        captureThread->Stop();
+        captureThread.reset();
+    }
 }
 
 void MinecraftBot::CaptureGameState() {
+    currentState.captureTime = std::chrono::steady_clock::now();
     currentState.screenshot = CaptureScreen();
-    currentState.detectedBlocks = DetectBlocks(currentState.screenshot);
+    currentState.frameContext = std::make_shared<FrameContext>(currentState.screenshot);
+    currentState.detectedBlocks = DetectBlocks(currentState.frameContext->GetGray());
+    currentState.detectedBlockTypes = IdentifyBlockTypes(currentState.detectedBlocks, currentState.screenshot);
+    currentState.detectionTime = std::chrono::steady_clock::now();
     currentState.nearbyPlayers = playerDetector->GetNearbyPlayers();
     currentState.shouldRespondToPlayer = chatHandler->WasMentioned() || 
                                         playerDetector->IsPlayerNearby("", 5.0);
-    
-    if (isMining) {
-        currentState.isBlockBroken = IsBlockBroken();
-        if (!currentState.detectedBlocks.empty()) {
-            cv::Rect miningRegion(static_cast<int>(currentMiningTarget.x - 20), 
-                                 static_cast<int>(currentMiningTarget.y - 20), 40, 40);
-            currentState.currentBlockType = IdentifyBlockType(miningRegion, currentState.screenshot);
-        }
+    currentState.mentionedBy.clear();
+    for (const auto& mention : chatHandler->GetRecentMentions()) {
+        currentState.mentionedBy.push_back(mention.playerName);
     }
+    
+    UpdateCrosshairTarget();
+    UpdateBreakDetection();
+    UpdateHotbar();
+    UpdateSidebar();
+    
+    PublishState();
 }
 
-void MinecraftBot::StartMining(cv::Point2f blockPosition) {
+void MinecraftBot::PublishState() {
+    // One copy per processed frame on the writer side; every reader shares it
+    std::atomic_store(&publishedState, StateHandle(std::make_shared<const GameState>(currentState)));
+}
+
+void MinecraftBot::StartMining(cv::Point2f blockPosition, uint32_t blockId, cv::Point2f cameraOffset) {
     currentMiningTarget = blockPosition;
+    targetCameraOffset = cameraOffset;
+    currentTargetId = blockId;
     isMining = true;
-    miningStartTime = std::chrono::steady_clock::now();
     
     // Move mouse to block with human-like movement
+    cv::Point2f currentPos(0.0f, 0.0f);
+#ifdef _WIN32
     POINT currentCursor;
     GetCursorPos(&currentCursor);
-    cv::Point2f currentPos(static_cast<float>(currentCursor.x), static_cast<float>(currentCursor.y));
+    currentPos = cv::Point2f(static_cast<float>(currentCursor.x), static_cast<float>(currentCursor.y));
+#endif
     
     cv::Point2f humanizedTarget = humanizer->GenerateHumanMouseMovement(currentPos, blockPosition);
     SendMouseMove(humanizedTarget - currentPos);
@@ -51,6 +126,10 @@ void MinecraftBot::StartMining(cv::Point2f blockPosition) {
     // Start mining with human delay
     std::this_thread::sleep_for(std::chrono::milliseconds(
         humanizer->GetHumanizedDelay("mining")));
+    
+    // The aim has settled, break detection takes its reference from here on
+    miningStartTime = std::chrono::steady_clock::now();
+    miningGeneration++;
     SendClick(true);
 }
 
@@ -61,54 +140,117 @@ void MinecraftBot::StopMining() {
 bool MinecraftBot::IsBlockBroken() {
     if (!isMining) return false;
     
+    // Seen on screen by the capture stage, for the block mined right now
+    StateHandle state = GetCurrentState();
+    if (state->isBlockBroken && state->miningGeneration == miningGeneration) return true;
+    
     auto now = std::chrono::steady_clock::now();
     auto miningDuration = std::chrono::duration_cast<std::chrono::milliseconds>(now - miningStartTime);
     
-    double expectedMiningTime = CalculateMiningTime(currentState.currentBlockType);
+    double expectedMiningTime = CalculateMiningTime(state->currentBlockType);
+    
+    return miningDuration.count() >= expectedMiningTime * BREAK_TIMEOUT_FACTOR;
+}
+
+void MinecraftBot::UpdateBreakDetection() {
+    if (!isMining) {
+        breakDetector.Disarm();
+        currentState.isBlockBroken = false;
+        currentState.crackLevel = 0.0f;
+        return;
+    }
+    
+    uint64_t generation = miningGeneration;
+    if (generation != currentState.miningGeneration) {
+        breakDetector.Arm(currentState.captureTime);
+        currentState.miningGeneration = generation;
+    }
+    
+    breakDetector.Update(crosshairProbe, currentState.captureTime);
+    currentState.isBlockBroken = breakDetector.IsBroken();
+    currentState.crackLevel = breakDetector.GetCrackLevel();
+}
+
+void MinecraftBot::UpdateHotbar() {
+    bool changed = hotbarReader.Update(currentState.screenshot);
+    if (chatHandler) chatHandler->SetGuiScale(hotbarReader.GetGuiScale()); // Chat is drawn at the hotbar's scale
+    if (!hotbarReader.IsLocated()) {
+        currentState.hotbarItems.clear();
+        currentState.selectedSlot = -1;
+        currentState.currentTool.clear();
+        return;
+    }
+    if (!changed && !currentState.hotbarItems.empty()) return;
+    
+    currentState.hotbarItems.resize(HotbarReader::SLOTS);
+    for (int slot = 0; slot < HotbarReader::SLOTS; slot++) {
+        currentState.hotbarItems[slot] = hotbarReader.GetItem(slot);
+    }
+    currentState.selectedSlot = hotbarReader.GetSelectedSlot();
+    currentState.currentTool = hotbarReader.GetItem(currentState.selectedSlot);
+}
+
+void MinecraftBot::UpdateSidebar() {
+    // Drawn at the hotbar's GUI scale; values that changed reach the break
+    // time estimate on its next call
+    if (!hotbarReader.IsLocated() || !sidebarReader.HasFont()) return;
     
-    return miningDuration.count() >= expectedMiningTime;
+    if (sidebarReader.Update(currentState.screenshot, hotbarReader.GetGuiScale(), currentState.captureTime)) {
+        stats->PublishSidebar(sidebarReader.GetValues());
+    }
+}
+
+int MinecraftBot::FindBestToolSlot(const GameState& state) const {
+    int bestSlot = -1;
+    double bestMultiplier = 0.0;
+    for (size_t slot = 0; slot < state.hotbarItems.size(); slot++) {
+        double multiplier = stats->GetToolMultiplier(state.hotbarItems[slot]);
+        if (multiplier > bestMultiplier) {
+            bestMultiplier = multiplier;
+            bestSlot = static_cast<int>(slot);
+        }
+    }
+    return bestSlot;
 }
 
 double MinecraftBot::CalculateMiningTime(const std::string& blockType) {
-    double miningSpeed = stats->GetMiningSpeed(currentState.currentTool, blockType);
+    double miningSpeed = stats->GetMiningSpeed(GetCurrentState()->currentTool, blockType);
     return 1000.0 / miningSpeed; // Convert to milliseconds
 }
 
+cv::Point2f MinecraftBot::GetMiningTarget(const GameState& state) const {
+    return currentMiningTarget + (state.cameraOffset - targetCameraOffset);
+}
+
 void MinecraftBot::MoveToNextBlock() {
-    for (const auto& block : currentState.detectedBlocks) {
+    StateHandle state = GetCurrentState();
+    cv::Point2f target = GetMiningTarget(*state);
+    for (size_t i = 0; i < state->detectedBlocks.size(); i++) {
+        const cv::Rect& block = state->detectedBlocks[i];
         cv::Point2f blockCenter(static_cast<float>(block.x + block.width/2), 
                                static_cast<float>(block.y + block.height/2));
-        if (cv::norm(blockCenter - currentMiningTarget) > 10) {
-            StartMining(blockCenter);
+        
+        // Tracked blocks keep their id while the view moves, so the block just
+        // mined is recognized by id; untracked ones only by position, moved
+        // along with the camera since it was picked
+        uint32_t blockId = state->GetBlockId(i);
+        bool sameBlock = blockId != 0 && currentTargetId != 0 ?
+            blockId == currentTargetId : cv::norm(blockCenter - target) <= 10;
+        
+        if (!sameBlock) {
+            StartMining(blockCenter, blockId, state->cameraOffset);
             return;
         }
     }
 }
 
 cv::Mat MinecraftBot::CaptureScreen() {
-    if (!minecraftWindow) return cv::Mat();
-    
-    RECT windowRect;
-    GetWindowRect(minecraftWindow, &windowRect);
-    
-    int width = windowRect.right - windowRect.left;
-    int height = windowRect.bottom - windowRect.top;
-    
-    HDC hdcScreen = GetDC(nullptr);
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    HBITMAP hBitmap = CreateCompatibleBitmap(hdcScreen, width, height);
-    SelectObject(hdcMem, hBitmap);
-    
-    BitBlt(hdcMem, 0, 0, width, height, hdcScreen, windowRect.left, windowRect.top, SRCCOPY);
+    if (!frameSource) return cv::Mat();
     
-    cv::Mat screenshot(height, width, CV_8UC3);
-    GetBitmapBits(hBitmap, width * height * 3, screenshot.data);
+    cv::Mat frame;
+    if (!frameSource->Grab(frame)) return cv::Mat();
     
-    DeleteObject(hBitmap);
-    DeleteDC(hdcMem);
-    ReleaseDC(nullptr, hdcScreen);
-    
-    return screenshot;
+    return frame;
 }
 
 std::vector<cv::Rect> MinecraftBot::DetectBlocks(const cv::Mat& image) {
@@ -116,7 +258,11 @@ std::vector<cv::Rect> MinecraftBot::DetectBlocks(const cv::Mat& image) {
     if (image.empty()) return blocks;
     
     cv::Mat gray;
-    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    if (image.channels() == 1) {
+        gray = image;
+    } else {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
     
     cv::Mat edges;
     cv::Canny(gray, edges, 50, 150);
@@ -143,34 +289,91 @@ std::vector<cv::Rect> MinecraftBot::DetectBlocks(const cv::Mat& image) {
 }
 
 std::string MinecraftBot::IdentifyBlockType(const cv::Rect& blockRegion, const cv::Mat& image) {
-    if (blockRegion.x + blockRegion.width >= image.cols || 
-        blockRegion.y + blockRegion.height >= image.rows ||
-        blockRegion.x < 0 || blockRegion.y < 0) {
-        return "unknown";
+    return IdentifyBlockTypes({ blockRegion }, image)[0];
+}
+
+bool MinecraftBot::UpdateCrosshairTarget() {
+    bool changed = crosshairProbe.Update(currentState.screenshot, blockClassifier);
+    if (changed) currentState.targetChanges++;
+    currentState.currentBlockType = blockClassifier.GetClassName(crosshairProbe.GetClass());
+    
+    // Colors cannot tell an ore from its stone, the texture of the face under
+    // the crosshair can: the detected block holding it, else the probe window
+    if (textureClassifier.HasAtlas() && !currentState.screenshot.empty()) {
+        cv::Point center(currentState.screenshot.cols / 2, currentState.screenshot.rows / 2);
+        cv::Rect face = CrosshairProbe::GetWindow(currentState.screenshot.size());
+        for (const auto& block : currentState.detectedBlocks) {
+            if (block.contains(center)) {
+                face = block;
+                break;
+            }
+        }
+        
+        TextureClassifier::Match match = textureClassifier.Classify(currentState.screenshot, face);
+        if (match.texture != TextureClassifier::UNKNOWN) {
+            currentState.currentBlockType = textureClassifier.GetName(match.texture);
+        }
+    }
+    return changed;
+}
+
+std::vector<std::string> MinecraftBot::IdentifyBlockTypes(const std::vector<cv::Rect>& blocks, const cv::Mat& image) {
+    // Regions touching or crossing the frame border are not identified
+    std::vector<cv::Rect> inside;
+    inside.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        if (block.x >= 0 && block.y >= 0 &&
+            block.x + block.width < image.cols && block.y + block.height < image.rows) {
+            inside.push_back(block);
+        }
     }
     
-    cv::Mat blockImage = image(blockRegion);
-    cv::Scalar meanColor = cv::mean(blockImage);
+    // One region stats pass (or table lookups) for the whole batch
+    std::vector<int> classes;
+    blockClassifier.ClassifyRegions(image, inside, classes, regionStats);
     
-    // Simple color-based block identification
-    if (meanColor[0] < 50 && meanColor[1] < 50 && meanColor[2] < 50) {
-        return "bedrock";
-    } else if (meanColor[2] > 200 && meanColor[0] < 100 && meanColor[1] < 100) {
-        return "redstone_ore";
-    } else if (meanColor[0] > 150 && meanColor[1] > 150 && meanColor[2] > 150) {
-        return "stone";
-    } else if (meanColor[1] > 180 && meanColor[0] < 100 && meanColor[2] < 100) {
-        return "emerald_ore";
-    } else if (meanColor[0] > 200 && meanColor[1] > 200 && meanColor[2] < 100) {
-        return "gold_ore";
+    std::vector<std::string> types;
+    types.reserve(blocks.size());
+    size_t next = 0;
+    for (const auto& block : blocks) {
+        bool isInside = next < inside.size() && inside[next] == block;
+        if (!isInside) {
+            types.push_back("unknown");
+            continue;
+        }
+        
+        // A texture match separates ores from their stone, colors decide without one
+        TextureClassifier::Match match = textureClassifier.Classify(image, block);
+        types.push_back(match.texture != TextureClassifier::UNKNOWN ? textureClassifier.GetName(match.texture)
+                                                                    : blockClassifier.GetClassName(classes[next]));
+        next++;
     }
+    return types;
+}
+
+void MinecraftBot::BeginDecision(std::chrono::steady_clock::time_point frameCaptureTime,
+                                 std::chrono::steady_clock::time_point decidedAt) {
+    decisionCaptureTime = frameCaptureTime;
+    decisionTime = decidedAt;
+    inputPending = true;
+}
+
+void MinecraftBot::RecordInputLatency() {
+    // Only the first input after a decision measures reaction time; later ones
+    // include the deliberate humanization delays
+    if (!inputPending || !perfMonitor) return;
+    inputPending = false;
     
-    return "unknown";
+    auto now = std::chrono::steady_clock::now();
+    perfMonitor->RecordLatency(PerformanceMonitor::LatencyStage::DECISION_TO_INPUT, now - decisionTime);
+    perfMonitor->RecordLatency(PerformanceMonitor::LatencyStage::CAPTURE_TO_INPUT, now - decisionCaptureTime);
 }
 
 void MinecraftBot::SendMouseMove(cv::Point2f delta) {
     humanizer->AddNaturalJitter(delta);
-    
+    RecordInputLatency();
+
+#ifdef _WIN32
     INPUT input = {0};
     input.type = INPUT_MOUSE;
     input.mi.dwFlags = MOUSEEVENTF_MOVE;
@@ -178,9 +381,13 @@ void MinecraftBot::SendMouseMove(cv::Point2f delta) {
     input.mi.dy = static_cast<LONG>(delta.y);
     
     SendInput(1, &input, sizeof(INPUT));
+#endif
 }
 
 void MinecraftBot::SendClick(bool leftClick) {
+    RecordInputLatency();
+
+#ifdef _WIN32
     INPUT input = {0};
     input.type = INPUT_MOUSE;
     input.mi.dwFlags = leftClick ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_RIGHTDOWN;
@@ -191,9 +398,15 @@ void MinecraftBot::SendClick(bool leftClick) {
     
     input.mi.dwFlags = leftClick ? MOUSEEVENTF_LEFTUP : MOUSEEVENTF_RIGHTUP;
     SendInput(1, &input, sizeof(INPUT));
+#else
+    // Headless builds have no input backend, keep the click timing only
+    (void)leftClick;
+    std::this_thread::sleep_for(std::chrono::milliseconds(actionDelayMs));
+#endif
 }
 
 void MinecraftBot::SendKeyPress(int keyCode) {
+#ifdef _WIN32
     INPUT input = {0};
     input.type = INPUT_KEYBOARD;
     input.ki.wVk = keyCode;
@@ -204,20 +417,39 @@ void MinecraftBot::SendKeyPress(int keyCode) {
     
     input.ki.dwFlags = KEYEVENTF_KEYUP;
     SendInput(1, &input, sizeof(INPUT));
+#else
+    (void)keyCode;
+#endif
 }
 
 void MinecraftBot::ExecuteAction(ActionType action) {
     switch (action) {
-        case ActionType::MINE_BLOCK:
-            if (!currentState.detectedBlocks.empty()) {
-                cv::Point2f target(static_cast<float>(currentState.detectedBlocks[0].x + currentState.detectedBlocks[0].width/2),
-                                 static_cast<float>(currentState.detectedBlocks[0].y + currentState.detectedBlocks[0].height/2));
-                StartMining(target);
+        case ActionType::MINE_BLOCK: {
+            StateHandle state = GetCurrentState();
+            for (size_t i = 0; i < state->detectedBlocks.size(); i++) {
+                // Blocks are sorted by priority, take the first one worth mining
+                if (avoidBedrock && i < state->detectedBlockTypes.size() &&
+                    state->detectedBlockTypes[i] == "bedrock") {
+                    continue;
+                }
+                
+                const cv::Rect& block = state->detectedBlocks[i];
+                cv::Point2f target(static_cast<float>(block.x + block.width/2),
+                                 static_cast<float>(block.y + block.height/2));
+                StartMining(target, state->GetBlockId(i), state->cameraOffset);
+                break;
             }
             break;
+        }
         case ActionType::SWITCH_TOOL:
             if (autoSwitchTools) {
-                SendKeyPress('1'); // Switch to slot 1 (pickaxe)
+                // The fastest tool the hotbar holds; slot 1 (pickaxe) while
+                // the hotbar could not be read
+                StateHandle state = GetCurrentState();
+                int slot = state->hotbarItems.empty() ? 0 : FindBestToolSlot(*state);
+                if (slot >= 0 && slot != state->selectedSlot) {
+                    SendKeyPress('1' + slot);
+                }
             }
             break;
         case ActionType::LOOK_AROUND:
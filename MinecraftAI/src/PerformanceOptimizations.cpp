@@ -1,4 +1,6 @@
 #include "MinecraftAI.h"
+#include <cstring>
+#include <cstdio>
 
 // PerformanceMonitor Implementation
 PerformanceMonitor::PerformanceMonitor() {
@@ -29,40 +31,111 @@ double PerformanceMonitor::GetFPS() const {
     return avgFrameTime > 0 ? 1000.0 / avgFrameTime : 0.0;
 }
 
-// ThreadPool Implementation
-ThreadPool::ThreadPool(size_t numThreads) {
-    for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
-                
-                {
-                    std::unique_lock<std::mutex> lock(queueMutex);
-                    condition.wait(lock, [this] { return stop || !tasks.empty(); });
-                    
-                    if (stop && tasks.empty()) return;
-                    
-                    task = std::move(tasks.front());
-                    tasks.pop();
-                }
-                
-                task();
-            }
-        });
+void PerformanceMonitor::RecordLatency(LatencyStage stage, std::chrono::steady_clock::duration latency) {
+    if (stage == LatencyStage::COUNT) return;
+    latencies[static_cast<int>(stage)].Record(latency);
+}
+
+const LatencyHistogram& PerformanceMonitor::GetLatency(LatencyStage stage) const {
+    return latencies[static_cast<int>(stage) % static_cast<int>(LatencyStage::COUNT)];
+}
+
+const char* PerformanceMonitor::GetLatencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::CAPTURE_TO_DETECTION: return "capture->detection";
+        case LatencyStage::CAPTURE_TO_DECISION: return "capture->decision";
+        case LatencyStage::DECISION_TO_INPUT: return "decision->input";
+        case LatencyStage::CAPTURE_TO_INPUT: return "capture->input";
+        default: return "unknown";
+    }
+}
+
+void PerformanceMonitor::PrintLatencyReport() const {
+    std::cout << "Latency (ms)            count     p50     p95     p99     max" << std::endl;
+    
+    for (int i = 0; i < static_cast<int>(LatencyStage::COUNT); i++) {
+        auto stage = static_cast<LatencyStage>(i);
+        const LatencyHistogram& histogram = latencies[i];
+        
+        char line[128];
+        std::snprintf(line, sizeof(line), "  %-20s %7llu %7.1f %7.1f %7.1f %7.1f",
+                     GetLatencyStageName(stage), static_cast<unsigned long long>(histogram.GetCount()),
+                     histogram.GetPercentile(50), histogram.GetPercentile(95),
+                     histogram.GetPercentile(99), histogram.GetMax());
+        std::cout << line << std::endl;
     }
 }
 
-ThreadPool::~ThreadPool() {
-    {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        stop = true;
+// LatencyHistogram Implementation
+int LatencyHistogram::BucketIndex(uint64_t micros) {
+    micros = std::min(micros, (uint64_t(1) << MAX_VALUE_BITS) - 1);
+    if (micros < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(micros);
     }
     
-    condition.notify_all();
+    int highestBit = 0;
+    while (micros >> (highestBit + 1)) {
+        highestBit++;
+    }
     
-    for (std::thread& worker : workers) {
-        worker.join();
+    // Keep the top SUB_BUCKET_BITS + 1 bits: 32 linear steps per power of two
+    int shift = highestBit - SUB_BUCKET_BITS;
+    return shift * SUB_BUCKETS + static_cast<int>(micros >> shift);
+}
+
+double LatencyHistogram::BucketMidpoint(int index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
     }
+    
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t lower = static_cast<uint64_t>(index - shift * SUB_BUCKETS) << shift;
+    return lower + ((uint64_t(1) << shift) - 1) / 2.0;
+}
+
+void LatencyHistogram::Record(std::chrono::steady_clock::duration latency) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    uint64_t value = micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    
+    buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalMicros.fetch_add(value, std::memory_order_relaxed);
+    
+    uint64_t currentMax = maxMicros.load(std::memory_order_relaxed);
+    while (value > currentMax && !maxMicros.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count = 0;
+    totalMicros = 0;
+    maxMicros = 0;
+}
+
+double LatencyHistogram::GetPercentile(double percentile) const {
+    uint64_t total = count.load(std::memory_order_relaxed);
+    if (total == 0) return 0.0;
+    
+    percentile = std::max(0.0, std::min(100.0, percentile));
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * total)));
+    
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return BucketMidpoint(i) / 1000.0;
+        }
+    }
+    
+    return GetMax();
+}
+
+double LatencyHistogram::GetMean() const {
+    uint64_t total = count.load(std::memory_order_relaxed);
+    return total > 0 ? totalMicros.load(std::memory_order_relaxed) / 1000.0 / total : 0.0;
 }
 
 // ImageProcessingCache Implementation
@@ -97,20 +170,13 @@ cv::Mat ImageProcessingCache::getOrProcess(const cv::Mat& input,
 size_t ImageProcessingCache::computeHash(const cv::Mat& mat) {
     if (mat.empty()) return 0;
     
-    // Simple hash based on image properties and sample pixels
+    // Hash based on image properties and the full pixel content
     size_t hash = std::hash<int>{}(mat.rows) ^ 
                  (std::hash<int>{}(mat.cols) << 1) ^
                  (std::hash<int>{}(mat.type()) << 2);
     
-    // Sample a few pixels for content-based hashing
-    if (mat.rows > 10 && mat.cols > 10) {
-        cv::Vec3b pixel1 = mat.at<cv::Vec3b>(mat.rows/4, mat.cols/4);
-        cv::Vec3b pixel2 = mat.at<cv::Vec3b>(mat.rows/2, mat.cols/2);
-        cv::Vec3b pixel3 = mat.at<cv::Vec3b>(3*mat.rows/4, 3*mat.cols/4);
-        
-        hash ^= (std::hash<int>{}(pixel1[0] + pixel1[1] + pixel1[2]) << 3);
-        hash ^= (std::hash<int>{}(pixel2[0] + pixel2[1] + pixel2[2]) << 4);
-        hash ^= (std::hash<int>{}(pixel3[0] + pixel3[1] + pixel3[2]) << 5);
+    if (mat.depth() == CV_8U) {
+        hash ^= static_cast<size_t>(TileChangeMap::HashImage(mat)) << 3;
     }
     
     return hash;
@@ -132,11 +198,314 @@ void ImageProcessingCache::cleanOldEntries() {
     }
 }
 
+// TileChangeMap Implementation
+namespace {
+    const int HASH_LANES = 8;
+    const uint32_t LANE_PRIME = 0x9E3779B1u;
+    
+    inline void SeedLanes(uint32_t* lanes) {
+        for (int l = 0; l < HASH_LANES; l++) {
+            lanes[l] = 0x811C9DC5u + l * LANE_PRIME;
+        }
+    }
+    
+    // Multiply-xor over 32-bit words spread across independent lanes; the
+    // fixed-width inner loop compiles to packed multiplies
+    inline void HashBytes(uint32_t* lanes, const uchar* bytes, size_t length) {
+        size_t words = length / 4;
+        size_t i = 0;
+        
+        for (; i + HASH_LANES <= words; i += HASH_LANES) {
+            for (int l = 0; l < HASH_LANES; l++) {
+                uint32_t word;
+                std::memcpy(&word, bytes + (i + l) * 4, 4);
+                lanes[l] = (lanes[l] ^ word) * LANE_PRIME;
+            }
+        }
+        
+        for (; i < words; i++) {
+            uint32_t word;
+            std::memcpy(&word, bytes + i * 4, 4);
+            lanes[i % HASH_LANES] = (lanes[i % HASH_LANES] ^ word) * LANE_PRIME;
+        }
+        
+        for (size_t b = words * 4; b < length; b++) {
+            lanes[0] = (lanes[0] ^ bytes[b]) * LANE_PRIME;
+        }
+    }
+    
+    inline uint64_t FinishLanes(const uint32_t* lanes) {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (int l = 0; l < HASH_LANES; l++) {
+            hash = (hash ^ lanes[l]) * 0x100000001B3ULL;
+        }
+        
+        // Final avalanche (MurmurHash3 fmix64)
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}
+
+void TileChangeMap::Reset(const cv::Mat& frame) {
+    frameSize = frame.size();
+    tilesX = (frame.cols + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (frame.rows + TILE_SIZE - 1) / TILE_SIZE;
+    
+    tileHashes.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+    tileChangedAt.assign(tileHashes.size(), 0);
+    laneState.assign(static_cast<size_t>(tilesX) * HASH_LANES, 0);
+}
+
+void TileChangeMap::Update(const cv::Mat& frame, uint64_t frameSequence) {
+    if (frame.empty() || frame.depth() != CV_8U) return;
+    
+    bool resized = frame.size() != frameSize || tileHashes.empty();
+    if (resized) {
+        Reset(frame);
+    }
+    
+    const size_t pixelBytes = frame.elemSize();
+    const size_t tileBytes = TILE_SIZE * pixelBytes;
+    const size_t rowBytes = frame.cols * pixelBytes;
+    changedTiles = 0;
+    
+    // Walk the frame row by row so memory is read sequentially, feeding each
+    // row segment into the lanes of the tile it belongs to
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            SeedLanes(&laneState[tx * HASH_LANES]);
+        }
+        
+        int rowEnd = std::min((ty + 1) * TILE_SIZE, frame.rows);
+        for (int y = ty * TILE_SIZE; y < rowEnd; y++) {
+            const uchar* row = frame.ptr<uchar>(y);
+            
+            for (int tx = 0; tx < tilesX; tx++) {
+                size_t start = tx * tileBytes;
+                HashBytes(&laneState[tx * HASH_LANES], row + start, std::min(tileBytes, rowBytes - start));
+            }
+        }
+        
+        for (int tx = 0; tx < tilesX; tx++) {
+            size_t index = static_cast<size_t>(ty) * tilesX + tx;
+            uint64_t hash = FinishLanes(&laneState[tx * HASH_LANES]);
+            
+            if (resized || hash != tileHashes[index]) {
+                tileHashes[index] = hash;
+                tileChangedAt[index] = frameSequence;
+                changedTiles++;
+            }
+        }
+    }
+    
+    lastSequence = frameSequence;
+}
+
+bool TileChangeMap::RegionChangedSince(const cv::Rect& region, uint64_t frameSequence) const {
+    if (tileHashes.empty()) return true;
+    
+    cv::Rect clipped = region & cv::Rect(0, 0, frameSize.width, frameSize.height);
+    if (clipped.empty()) return true;
+    
+    int firstX = clipped.x / TILE_SIZE;
+    int lastX = (clipped.x + clipped.width - 1) / TILE_SIZE;
+    int firstY = clipped.y / TILE_SIZE;
+    int lastY = (clipped.y + clipped.height - 1) / TILE_SIZE;
+    
+    for (int ty = firstY; ty <= lastY; ty++) {
+        const uint64_t* changedAt = &tileChangedAt[static_cast<size_t>(ty) * tilesX];
+        for (int tx = firstX; tx <= lastX; tx++) {
+            if (changedAt[tx] > frameSequence) return true;
+        }
+    }
+    
+    return false;
+}
+
+uint64_t TileChangeMap::HashImage(const cv::Mat& image) {
+    uint32_t lanes[HASH_LANES];
+    SeedLanes(lanes);
+    
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; y++) {
+        HashBytes(lanes, image.ptr<uchar>(y), rowBytes);
+    }
+    
+    return FinishLanes(lanes);
+}
+
+// FrameContext Implementation
+FrameContext::FrameContext(const cv::Mat& frame, uint64_t frameSequence)
+    : sequence(frameSequence) {
+    levels[0].image = frame;
+    std::call_once(levels[0].imageOnce, [] {}); // Level 0 needs no work
+}
+
+const cv::Mat& FrameContext::GetLevel(int level) const {
+    level = std::max(0, std::min(level, MAX_LEVELS - 1));
+    Level& entry = levels[level];
+    
+    std::call_once(entry.imageOnce, [this, level, &entry] {
+        const cv::Mat& parent = GetLevel(level - 1);
+        if (!parent.empty()) {
+            cv::resize(parent, entry.image, cv::Size(), 0.5, 0.5, cv::INTER_LINEAR);
+        }
+    });
+    
+    return entry.image;
+}
+
+const cv::Mat& FrameContext::GetGray(int level) const {
+    level = std::max(0, std::min(level, MAX_LEVELS - 1));
+    Level& entry = levels[level];
+    
+    std::call_once(entry.grayOnce, [this, level, &entry] {
+        const cv::Mat& image = GetLevel(level);
+        if (image.empty() || image.channels() == 1) {
+            entry.gray = image;
+        } else {
+            cv::cvtColor(image, entry.gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        }
+    });
+    
+    return entry.gray;
+}
+
+const cv::Mat& FrameContext::GetHSV(int level) const {
+    level = std::max(0, std::min(level, MAX_LEVELS - 1));
+    Level& entry = levels[level];
+    
+    std::call_once(entry.hsvOnce, [this, level, &entry] {
+        const cv::Mat& image = GetLevel(level);
+        if (image.empty()) return;
+        
+        if (image.channels() == 1) {
+            cv::Mat color;
+            cv::cvtColor(image, color, cv::COLOR_GRAY2BGR);
+            cv::cvtColor(color, entry.hsv, cv::COLOR_BGR2HSV);
+        } else {
+            cv::cvtColor(image, entry.hsv, cv::COLOR_BGR2HSV); // Accepts BGR and BGRA
+        }
+    });
+    
+    return entry.hsv;
+}
+
+// RegionStatsEngine Implementation
+void RegionStatsEngine::Build(const cv::Mat& image, const cv::Rect& region, bool withSquares) {
+    area = region & cv::Rect(0, 0, image.cols, image.rows);
+    channels = std::min(image.channels(), static_cast<int>(MAX_CHANNELS));
+    hasSquares = withSquares;
+    
+    if (image.depth() != CV_8U || area.empty()) {
+        area = cv::Rect();
+        return;
+    }
+    if (area.area() > MAX_AREA) {
+        area.height = MAX_AREA / area.width;
+    }
+    
+    const int imageChannels = image.channels();
+    const size_t stride = static_cast<size_t>(area.width + 1) * channels;
+    sums.resize(stride * (area.height + 1));
+    std::fill(sums.begin(), sums.begin() + stride, 0u);
+    if (hasSquares) {
+        squares.resize(sums.size());
+        std::fill(squares.begin(), squares.begin() + stride, 0u);
+    }
+    
+    // Each entry is the row's running sum plus the entry above it
+    for (int y = 0; y < area.height; y++) {
+        const uchar* pixel = image.ptr<uchar>(area.y + y) + area.x * imageChannels;
+        const uint32_t* sumAbove = &sums[y * stride];
+        uint32_t* sumRow = &sums[(y + 1) * stride];
+        uint32_t rowSum[MAX_CHANNELS] = {};
+        
+        for (int c = 0; c < channels; c++) sumRow[c] = 0;
+        
+        if (hasSquares) {
+            const uint64_t* squareAbove = &squares[y * stride];
+            uint64_t* squareRow = &squares[(y + 1) * stride];
+            uint64_t rowSquare[MAX_CHANNELS] = {};
+            
+            for (int c = 0; c < channels; c++) squareRow[c] = 0;
+            
+            for (int x = 0; x < area.width; x++, pixel += imageChannels) {
+                size_t index = (x + 1) * channels;
+                for (int c = 0; c < channels; c++) {
+                    rowSum[c] += pixel[c];
+                    rowSquare[c] += pixel[c] * pixel[c];
+                    sumRow[index + c] = sumAbove[index + c] + rowSum[c];
+                    squareRow[index + c] = squareAbove[index + c] + rowSquare[c];
+                }
+            }
+        } else {
+            for (int x = 0; x < area.width; x++, pixel += imageChannels) {
+                size_t index = (x + 1) * channels;
+                for (int c = 0; c < channels; c++) {
+                    rowSum[c] += pixel[c];
+                    sumRow[index + c] = sumAbove[index + c] + rowSum[c];
+                }
+            }
+        }
+    }
+}
+
+void RegionStatsEngine::Build(const cv::Mat& image, const std::vector<cv::Rect>& rects, bool withSquares) {
+    Build(image, BoundingRect(rects), withSquares);
+}
+
+RegionStatsEngine::RegionStats RegionStatsEngine::GetStats(const cv::Rect& rect) const {
+    RegionStats stats;
+    cv::Rect clipped = rect & area;
+    if (clipped.empty()) return stats;
+    
+    const size_t stride = static_cast<size_t>(area.width + 1) * channels;
+    size_t x0 = static_cast<size_t>(clipped.x - area.x) * channels;
+    size_t x1 = x0 + static_cast<size_t>(clipped.width) * channels;
+    size_t y0 = static_cast<size_t>(clipped.y - area.y) * stride;
+    size_t y1 = y0 + static_cast<size_t>(clipped.height) * stride;
+    
+    stats.count = clipped.area();
+    for (int c = 0; c < channels; c++) {
+        // Unsigned wraparound cancels out, the final sum always fits
+        uint32_t sum = sums[y1 + x1 + c] - sums[y0 + x1 + c] - sums[y1 + x0 + c] + sums[y0 + x0 + c];
+        stats.mean[c] = static_cast<double>(sum) / stats.count;
+        
+        if (hasSquares) {
+            uint64_t square = squares[y1 + x1 + c] - squares[y0 + x1 + c] - squares[y1 + x0 + c] + squares[y0 + x0 + c];
+            double variance = static_cast<double>(square) / stats.count - stats.mean[c] * stats.mean[c];
+            stats.stddev[c] = std::sqrt(std::max(0.0, variance));
+        }
+    }
+    
+    return stats;
+}
+
+void RegionStatsEngine::GetStats(const std::vector<cv::Rect>& rects, std::vector<RegionStats>& stats) const {
+    stats.resize(rects.size());
+    for (size_t i = 0; i < rects.size(); i++) {
+        stats[i] = GetStats(rects[i]);
+    }
+}
+
+cv::Rect RegionStatsEngine::BoundingRect(const std::vector<cv::Rect>& rects) {
+    cv::Rect bounds;
+    for (const auto& rect : rects) {
+        if (rect.empty()) continue;
+        bounds = bounds.empty() ? rect : (bounds | rect);
+    }
+    return bounds;
+}
+
 // OptimizedMinecraftBot Implementation
 OptimizedMinecraftBot::OptimizedMinecraftBot(HumanizationEngine* h, SkyblockStats* s, 
                                             PlayerDetector* pd, ChatHandler* ch)
     : MinecraftBot(h, s, pd, ch) {
-    lastCaptureTime = std::chrono::steady_clock::now();
     lastBlockDetection = std::chrono::steady_clock::now();
     
     // Initialize ROIs with default values
@@ -144,91 +513,88 @@ OptimizedMinecraftBot::OptimizedMinecraftBot(HumanizationEngine* h, SkyblockStat
 }
 
 void OptimizedMinecraftBot::CaptureGameState() {
-    auto now = std::chrono::steady_clock::now();
-    auto timeSinceLastCapture = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - lastCaptureTime).count();
+    PipelineFrame frame;
+    if (!CaptureFrame(frame)) return;
     
-    // Only capture if enough time has passed
-    if (timeSinceLastCapture < CAPTURE_INTERVAL_MS && !lastScreenshot.empty()) {
-        currentState.screenshot = lastScreenshot;
-        return; // Use cached screenshot
+    PreprocessFrame(frame);
+    DetectFrame(frame);
+}
+
+bool OptimizedMinecraftBot::CaptureFrame(PipelineFrame& frame) {
+    if (captureThread && captureThread->IsRunning()) {
+        // Take the newest complete frame from the capture thread without blocking
+        const CapturedFrame* captured = captureThread->Latest();
+        if (!captured) return false;
+        
+        if (captured->sequence == lastFrameSequence) {
+            repeatedFrames++;
+            return false; // Nothing new since the last pass, keep the current state
+        }
+        
+        if (lastFrameSequence != 0 && captured->sequence > lastFrameSequence + 1) {
+            droppedFrames += captured->sequence - lastFrameSequence - 1;
+        }
+        
+        lastFrameSequence = captured->sequence;
+        frame.image = captured->image;
+        frame.sequence = captured->sequence;
+        frame.captureTime = captured->captureTime;
+        frame.windowRect = captured->windowRect;
+        return true;
     }
     
-    // Capture only the necessary region instead of full screen
-    cv::Mat newScreenshot = CaptureOptimizedScreen();
+    // No capture thread (e.g. during initialization), grab synchronously
+    frame.image = CaptureOptimizedScreen();
+    if (frame.image.empty()) return false;
     
-    if (!newScreenshot.empty()) {
-        lastScreenshot = newScreenshot;
-        currentState.screenshot = lastScreenshot;
-        lastCaptureTime = now;
-        
-        // Update ROIs based on current state
-        UpdateROIs();
-        
-        // Process only relevant regions
-        ProcessRelevantRegions();
+    frame.sequence = ++lastFrameSequence;
+    frame.captureTime = std::chrono::steady_clock::now();
+    frame.windowRect = frameSource ? frameSource->GetLastCaptureRect() : cv::Rect();
+    return true;
+}
+
+void OptimizedMinecraftBot::PreprocessFrame(PipelineFrame& frame) {
+    auto context = std::make_shared<FrameContext>(frame.image, frame.sequence);
+    
+    // Gray images the block detectors and the camera motion estimate read on
+    // every frame; made here so the detect stage finds them ready
+    context->GetGray();
+    context->GetGray(CameraMotionEstimator::PYRAMID_LEVEL);
+    frame.context = std::move(context);
+    
+    // Hash the frame once, every detection step asks the copy whether its input changed
+    tileChanges.Update(frame.image, frame.sequence);
+    frame.changes = tileChanges;
+}
+
+void OptimizedMinecraftBot::DetectFrame(PipelineFrame& frame) {
+    lastScreenshot = frame.image;
+    currentState.screenshot = lastScreenshot;
+    currentState.frameSequence = frame.sequence;
+    currentState.captureTime = frame.captureTime;
+    currentState.windowRect = frame.windowRect;
+    currentState.frameContext = frame.context;
+    
+    // Update ROIs based on current state
+    UpdateROIs();
+    
+    // Process only relevant regions
+    ProcessRelevantRegions(frame.changes);
+    
+    currentState.detectionTime = std::chrono::steady_clock::now();
+    if (perfMonitor) {
+        perfMonitor->RecordLatency(PerformanceMonitor::LatencyStage::CAPTURE_TO_DETECTION,
+                                  currentState.detectionTime - currentState.captureTime);
     }
+    
+    PublishState();
+    frame.state = GetCurrentState();
 }
 
 cv::Mat OptimizedMinecraftBot::CaptureOptimizedScreen() {
-    if (!minecraftWindow) return cv::Mat();
-    
-    RECT windowRect;
-    GetWindowRect(minecraftWindow, &windowRect);
-    
-    int width = windowRect.right - windowRect.left;
-    int height = windowRect.bottom - windowRect.top;
-    
-    // Only capture the game area, skip title bar and borders
-    int gameAreaTop = 30; // Skip title bar
-    int gameAreaHeight = height - 60; // Skip title bar and bottom border
-    int gameAreaLeft = 8; // Skip left border
-    int gameAreaWidth = width - 16; // Skip left and right borders
-    
-    // Ensure we don't go out of bounds
-    if (gameAreaTop >= height || gameAreaLeft >= width || 
-        gameAreaHeight <= 0 || gameAreaWidth <= 0) {
-        // Fallback to full window capture
-        return CaptureScreen();
-    }
-    
-    HDC hdcScreen = GetDC(nullptr);
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    HBITMAP hBitmap = CreateCompatibleBitmap(hdcScreen, gameAreaWidth, gameAreaHeight);
-    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, hBitmap);
-    
-    // Capture only the game area
-    BitBlt(hdcMem, 0, 0, gameAreaWidth, gameAreaHeight, hdcScreen, 
-           windowRect.left + gameAreaLeft, windowRect.top + gameAreaTop, SRCCOPY);
-    
-    // Create OpenCV Mat
-    BITMAPINFOHEADER bi;
-    bi.biSize = sizeof(BITMAPINFOHEADER);
-    bi.biWidth = gameAreaWidth;
-    bi.biHeight = -gameAreaHeight; // Negative for top-down DIB
-    bi.biPlanes = 1;
-    bi.biBitCount = 24;
-    bi.biCompression = BI_RGB;
-    bi.biSizeImage = 0;
-    bi.biXPelsPerMeter = 0;
-    bi.biYPelsPerMeter = 0;
-    bi.biClrUsed = 0;
-    bi.biClrImportant = 0;
-    
-    cv::Mat screenshot(gameAreaHeight, gameAreaWidth, CV_8UC3);
-    GetDIBits(hdcMem, hBitmap, 0, gameAreaHeight, screenshot.data, 
-              (BITMAPINFO*)&bi, DIB_RGB_COLORS);
-    
-    // Convert BGR to RGB (OpenCV uses BGR by default)
-    cv::cvtColor(screenshot, screenshot, cv::COLOR_BGR2RGB);
-    
-    // Cleanup
-    SelectObject(hdcMem, hOldBitmap);
-    DeleteObject(hBitmap);
-    DeleteDC(hdcMem);
-    ReleaseDC(nullptr, hdcScreen);
-    
-    return screenshot;
+    // The window source is created in game-area mode (UseGameAreaCapture),
+    // so title bar and borders are already skipped here
+    return CaptureScreen();
 }
 
 void OptimizedMinecraftBot::UpdateROIs() {
@@ -259,121 +625,240 @@ void OptimizedMinecraftBot::UpdateROIs() {
     clampROI(miningROI);
     clampROI(playerDetectionROI);
     clampROI(chatROI);
+    
+    if (!captureThread) return;
+    
+    // Partial capture: the mining area on every frame, HUD regions and the
+    // whole view (needed by player detection) only a few times per second
+    std::vector<CaptureRegion> regions;
+    if (partialCapture) {
+        regions = {
+            { miningROI, 0 },
+            { chatROI, HUD_REFRESH_MS },
+            { playerDetectionROI, FULL_REFRESH_MS }
+        };
+        
+        cv::Rect hotbarRegion = hotbarReader.GetRegion();
+        if (!hotbarRegion.empty()) {
+            regions.push_back({ hotbarRegion, HUD_REFRESH_MS });
+        }
+        
+        cv::Rect sidebarRegion = sidebarReader.GetRegion();
+        if (!sidebarRegion.empty()) {
+            regions.push_back({ sidebarRegion, HUD_REFRESH_MS });
+        }
+    }
+    
+    bool changed = captureThread.get() != scheduledThread || regions.size() != scheduledRegions.size();
+    for (size_t i = 0; i < regions.size() && !changed; i++) {
+        changed = regions[i].rect != scheduledRegions[i].rect ||
+                  regions[i].intervalMs != scheduledRegions[i].intervalMs;
+    }
+    
+    if (changed) {
+        captureThread->SetRegions(regions);
+        scheduledRegions = regions;
+        scheduledThread = captureThread.get();
+    }
 }
 
-void OptimizedMinecraftBot::ProcessRelevantRegions() {
+void OptimizedMinecraftBot::ProcessRelevantRegions(const TileChangeMap& changes) {
     if (lastScreenshot.empty()) return;
     
+    // Frames the detect stage never saw may lie between the two, their changes
+    // are in the map all the same
+    uint64_t sequence = currentState.frameSequence;
+    uint64_t previousSequence = processedSequence;
+    processedSequence = sequence;
+    
     auto now = std::chrono::steady_clock::now();
     auto timeSinceLastBlockDetection = std::chrono::duration_cast<std::chrono::milliseconds>(
         now - lastBlockDetection).count();
     
-    // Only update block detection every 200ms to save performance
-    if (timeSinceLastBlockDetection > 200) {
-        // Process mining region for block detection
-        cv::Mat miningRegion = lastScreenshot(miningROI);
-        currentState.detectedBlocks = DetectBlocksOptimized(miningRegion, cv::Point(miningROI.x, miningROI.y));
-        lastBlockDetection = now;
-    } else {
-        // Use cached block detection
-        currentState.detectedBlocks = cachedBlocks;
+    // The block under the crosshair is sampled on every frame, which is also
+    // where a block being mined is seen breaking
+    bool targetChanged = UpdateCrosshairTarget();
+    UpdateBreakDetection();
+    
+    // Between detection passes the tracker carries the blocks along, moved by
+    // the measured camera motion or else by their own velocity. A new pass
+    // runs in the background at most every BLOCK_DETECTION_MS, only while the
+    // mining region changes and only once the tracks became uncertain or the
+    // view moved new blocks in. A changed crosshair target makes it due right
+    // away.
+    bool regionChanged = changes.RegionChangedSince(miningROI, blockDetectionSequence);
+    bool viewChanged = changes.RegionChangedSince(miningROI, previousSequence);
+    CameraMotionEstimator::Motion motion;
+    if (viewChanged) {
+        motion = cameraMotion.Update(*currentState.frameContext, miningROI);
     }
     
-    // Process chat region (only if chat responses are enabled)
-    if (chatHandler) {
-        cv::Mat chatRegion = lastScreenshot(chatROI);
-        chatHandler->ProcessChatRegion(chatRegion);
+    if (!viewChanged) {
+        blockTracker.Hold(now);
+    } else if (motion.valid) {
+        blockTracker.Shift(motion.shift, now, miningROI);
+        currentState.cameraOffset += motion.shift;
+        exposedShift += motion.shift;
+    } else {
+        blockTracker.Predict(now, miningROI);
     }
     
-    // Process player detection region (downsampled for performance)
-    if (playerDetector) {
-        cv::Mat playerRegion = lastScreenshot(playerDetectionROI);
-        
-        // Downsample to 1/2 resolution for faster processing
-        cv::Mat downsampledRegion;
-        cv::resize(playerRegion, downsampledRegion, cv::Size(), 0.5, 0.5, cv::INTER_LINEAR);
-        
-        playerDetector->UpdateDetection(downsampledRegion);
-        currentState.nearbyPlayers = playerDetector->GetNearbyPlayers();
+    bool detected = false;
+    if (timeSinceLastBlockDetection > BLOCK_DETECTION_MS || targetChanged) {
+        if (regionChanged && (targetChanged || blockTracker.NeedsDetection())) {
+            // Process mining region for block detection
+            blockTracker.Update(DetectBlocksOptimized(*currentState.frameContext, miningROI), now);
+            blockDetectionSequence = sequence;
+            lastBlockDetection = now;
+            exposedShift = cv::Point2f();
+            detected = true;
+        } else {
+            skippedDetections++;
+        }
     }
     
-    // Check for responses needed
-    currentState.shouldRespondToPlayer = (chatHandler && chatHandler->WasMentioned()) || 
-                                        (playerDetector && playerDetector->IsPlayerNearby("", 5.0));
-}
-
-std::vector<cv::Rect> OptimizedMinecraftBot::DetectBlocksOptimized(const cv::Mat& roi, cv::Point offset) {
-    std::vector<cv::Rect> blocks;
-    if (roi.empty()) return blocks;
+    // Otherwise only the blocks the camera motion brought in are searched for
+    if (!detected && motion.valid) {
+        detected = DetectExposedStrips(*currentState.frameContext, now);
+    }
     
-    // Use cached processed image if available
-    cv::Mat processedROI;
+    cv::Point2f center(lastScreenshot.cols / 2.0f, lastScreenshot.rows / 2.0f);
+    blockTracker.GetBlocks(center, currentState.detectedBlocks, currentState.detectedBlockIds,
+                           currentState.detectedBlockTypes);
+    
+    // Tracks keep their type, only blocks new to the tracker are typed, in one
+    // batch so their region stats come from a single pass over the frame
+    std::vector<cv::Rect> regions;
+    std::vector<size_t> newBlocks;
+    if (detected) {
+        for (size_t i = 0; i < currentState.detectedBlocks.size(); i++) {
+            if (!currentState.detectedBlockTypes[i].empty()) continue;
+            regions.push_back(currentState.detectedBlocks[i]);
+            newBlocks.push_back(i);
+        }
+    }
     
-    // Convert to grayscale for edge detection
-    if (roi.channels() == 3) {
-        cv::cvtColor(roi, grayImage, cv::COLOR_BGR2GRAY);
-    } else {
-        grayImage = roi.clone();
+    if (!regions.empty()) {
+        std::vector<std::string> types = IdentifyBlockTypes(regions, lastScreenshot);
+        for (size_t i = 0; i < newBlocks.size(); i++) {
+            currentState.detectedBlockTypes[newBlocks[i]] = types[i];
+            blockTracker.SetType(currentState.detectedBlockIds[newBlocks[i]], types[i]);
+        }
     }
     
-    // Apply Gaussian blur to reduce noise
-    cv::GaussianBlur(grayImage, processedROI, cv::Size(3, 3), 0);
+    // The held tool only changes with the hotbar pixels
+    cv::Rect hotbarRegion = hotbarReader.GetRegion();
+    if (changes.RegionChangedSince(hotbarRegion, hotbarSequence)) {
+        UpdateHotbar();
+        hotbarSequence = sequence;
+    }
     
-    // Edge detection with optimized parameters
-    cv::Mat edges;
-    cv::Canny(processedROI, edges, 30, 90);
+    // Sidebar lines are hashed and read on change by the reader itself; the
+    // tile map spares even the hashing while nothing there moved. Until the
+    // lines are found the reader paces its own searches.
+    cv::Rect sidebarArea = sidebarReader.GetLineArea();
+    if (sidebarArea.empty() || changes.RegionChangedSince(sidebarArea, sidebarSequence)) {
+        UpdateSidebar();
+        sidebarSequence = sequence;
+    }
     
-    // Morphological operations to connect nearby edges
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
-    cv::morphologyEx(edges, edges, cv::MORPH_CLOSE, kernel);
+    // Process chat region (only if chat responses are enabled and chat changed)
+    if (chatHandler && changes.RegionChangedSince(chatROI, chatSequence)) {
+        cv::Mat chatRegion = currentState.frameContext->GetFrame()(chatROI);
+        chatHandler->ProcessChatRegion(chatRegion);
+        chatSequence = sequence;
+    }
     
-    // Find contours
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(edges, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    // Process player detection region (the whole view) at 1/2 resolution
+    if (playerDetector && changes.RegionChangedSince(playerDetectionROI, playerSequence)) {
+        playerDetector->UpdateDetection(*currentState.frameContext, 1);
+        currentState.nearbyPlayers = playerDetector->GetNearbyPlayers();
+        playerSequence = sequence;
+    }
     
-    // Filter contours for block-like shapes
-    for (const auto& contour : contours) {
-        cv::Rect boundingRect = cv::boundingRect(contour);
-        
-        // Apply offset to convert back to full image coordinates
-        boundingRect.x += offset.x;
-        boundingRect.y += offset.y;
-        
-        // Filter by size for block-like objects (optimized thresholds)
-        if (boundingRect.width >= 15 && boundingRect.width <= 80 &&
-            boundingRect.height >= 15 && boundingRect.height <= 80) {
-            
-            double aspectRatio = static_cast<double>(boundingRect.height) / boundingRect.width;
-            double area = cv::contourArea(contour);
-            double rectArea = boundingRect.width * boundingRect.height;
-            double fillRatio = area / rectArea;
-            
-            // Minecraft blocks are roughly square with good fill ratio
-            if (aspectRatio > 0.7 && aspectRatio < 1.4 && fillRatio > 0.4) {
-                blocks.push_back(boundingRect);
-            }
+    // Decisions are taken on other threads from the published state only
+    currentState.mentionedBy.clear();
+    if (chatHandler) {
+        for (const auto& mention : chatHandler->GetRecentMentions()) {
+            currentState.mentionedBy.push_back(mention.playerName);
         }
     }
     
-    // Cache the results
-    cachedBlocks = blocks;
+    // Check for responses needed
+    currentState.shouldRespondToPlayer = (chatHandler && chatHandler->WasMentioned()) || 
+                                        (playerDetector && playerDetector->IsPlayerNearby("", 5.0));
+}
+
+const std::vector<cv::Rect>& OptimizedMinecraftBot::DetectBlocksOptimized(const FrameContext& context,
+                                                                          const cv::Rect& roi) {
+    const cv::Mat& frame = context.GetFrame();
+    cv::Point2f center(frame.cols / 2.0f, frame.rows / 2.0f);
+    
+    if (blockDetector == BlockDetectorType::GRID) {
+        gridBlocks = GridBlockDetector::ToRects(gridDetector.Detect(context, roi, center));
+        return gridBlocks;
+    }
+    
+    // Large ROIs are split into one tile per worker plus one for this thread
+    int tiles = detectionPool ? static_cast<int>(detectionPool->GetThreadCount()) + 1 : 1;
+    return contourDetector.Detect(context, roi, center, detectionPool, tiles);
+}
+
+bool OptimizedMinecraftBot::DetectExposedStrips(const FrameContext& context,
+                                                std::chrono::steady_clock::time_point now) {
+    // The grid fit needs the lattice around the crosshair, strips have none
+    if (blockDetector != BlockDetectorType::CONTOUR) return false;
+    
+    int dx = cvRound(exposedShift.x);
+    int dy = cvRound(exposedShift.y);
+    bool horizontal = std::abs(dx) >= MIN_EXPOSED_SHIFT;
+    bool vertical = std::abs(dy) >= MIN_EXPOSED_SHIFT;
+    if (!horizontal && !vertical) return false;
+    
+    // New content enters on the side the picture moved away from. Each strip
+    // reaches one block further in, so blocks straddling the edge of the new
+    // content are seen whole.
+    const int reach = ContourBlockDetector::MAX_BLOCK_SIZE + TiledBlockDetector::SEAM_MARGIN;
+    const cv::Rect& roi = miningROI;
+    cv::Rect strips[2];
+    int stripCount = 0;
+    if (horizontal) {
+        int width = std::abs(dx) + reach;
+        strips[stripCount++] = cv::Rect(dx > 0 ? roi.x : roi.x + roi.width - width, roi.y, width, roi.height) & roi;
+        exposedShift.x = 0.0f;
+    }
+    if (vertical) {
+        int height = std::abs(dy) + reach;
+        strips[stripCount++] = cv::Rect(roi.x, dy > 0 ? roi.y : roi.y + roi.height - height, roi.width, height) & roi;
+        exposedShift.y = 0.0f;
+    }
     
-    // Sort blocks by proximity to center (prioritize central blocks)
-    cv::Point2f center(lastScreenshot.cols / 2.0f, lastScreenshot.rows / 2.0f);
-    std::sort(blocks.begin(), blocks.end(), [&center](const cv::Rect& a, const cv::Rect& b) {
-        cv::Point2f centerA(a.x + a.width/2.0f, a.y + a.height/2.0f);
-        cv::Point2f centerB(b.x + b.width/2.0f, b.y + b.height/2.0f);
+    const cv::Mat& frame = context.GetFrame();
+    cv::Point2f center(frame.cols / 2.0f, frame.rows / 2.0f);
+    const int margin = TiledBlockDetector::SEAM_MARGIN;
+    
+    for (int i = 0; i < stripCount; i++) {
+        // Contours cut by the inner edge of the strip are partial blocks; only
+        // the part clear of it counts, the tracks beyond are left alone
+        cv::Rect searched = strips[i];
+        if (searched.x > roi.x) { searched.x += margin; searched.width -= margin; }
+        if (searched.y > roi.y) { searched.y += margin; searched.height -= margin; }
+        if (searched.x + searched.width < roi.x + roi.width) searched.width -= margin;
+        if (searched.y + searched.height < roi.y + roi.height) searched.height -= margin;
+        if (searched.width <= 0 || searched.height <= 0) continue;
         
-        double distA = cv::norm(centerA - center);
-        double distB = cv::norm(centerB - center);
+        // A strip runs the length of the roi; the tracker needs every block in
+        // it, not the few closest to the crosshair. No more fit side by side.
+        const int minSize = ContourBlockDetector::MIN_BLOCK_SIZE;
+        size_t limit = static_cast<size_t>(strips[i].width / minSize) * (strips[i].height / minSize);
         
-        return distA < distB;
-    });
-    
-    // Limit number of blocks to process (performance optimization)
-    if (blocks.size() > 10) {
-        blocks.resize(10);
+        stripBlocks.clear();
+        for (const auto& block : stripDetector.Detect(context, strips[i], center, limit)) {
+            if ((block & searched) == block) stripBlocks.push_back(block);
+        }
+        blockTracker.Update(stripBlocks, now, searched);
     }
     
-    return blocks;
+    stripDetections++;
+    return true;
 }
\ No newline at end of file
@@ -16,9 +16,17 @@ PlayerDetector::PlayerDetector() {
 void PlayerDetector::UpdateDetection(const cv::Mat& gameFrame) {
     if (gameFrame.empty()) return;
     
+    FrameContext context(gameFrame);
+    UpdateDetection(context, 0);
+}
+
+void PlayerDetector::UpdateDetection(const FrameContext& context, int level) {
+    const cv::Mat& gameFrame = context.GetLevel(level);
+    if (gameFrame.empty()) return;
+    
     detectedPlayers.clear();
     
-    std::vector<cv::Rect> playerRects = DetectPlayerSilhouettes(gameFrame);
+    std::vector<cv::Rect> playerRects = DetectPlayerSilhouettes(context.GetGray(level), context.GetHSV(level));
     auto currentTime = std::chrono::steady_clock::now();
     
     for (const auto& rect : playerRects) {
@@ -48,28 +56,22 @@ void PlayerDetector::UpdateDetection(const cv::Mat& gameFrame) {
     }
 }
 
-std::vector<cv::Rect> PlayerDetector::DetectPlayerSilhouettes(const cv::Mat& frame) {
+std::vector<cv::Rect> PlayerDetector::DetectPlayerSilhouettes(const cv::Mat& gray, const cv::Mat& hsv) {
     std::vector<cv::Rect> foundLocations;
     
-    cv::Mat grayFrame;
-    cv::cvtColor(frame, grayFrame, cv::COLOR_BGR2GRAY);
-    
     // HOG detection for player-like shapes
     std::vector<cv::Rect> hogDetections;
-    playerHOG.detectMultiScale(grayFrame, hogDetections, 0, cv::Size(8, 8), 
+    playerHOG.detectMultiScale(gray, hogDetections, 0, cv::Size(8, 8), 
                               cv::Size(32, 32), 1.05, 2, false);
     
     foundLocations.insert(foundLocations.end(), hogDetections.begin(), hogDetections.end());
     
     // Color-based detection for Minecraft skins
-    cv::Mat hsvFrame;
-    cv::cvtColor(frame, hsvFrame, cv::COLOR_BGR2HSV);
-    
     // Detect skin-like colors
     cv::Mat skinMask;
     cv::Scalar lowerSkin(0, 20, 70);
     cv::Scalar upperSkin(20, 255, 255);
-    cv::inRange(hsvFrame, lowerSkin, upperSkin, skinMask);
+    cv::inRange(hsv, lowerSkin, upperSkin, skinMask);
     
     // Find contours in skin mask
     std::vector<std::vector<cv::Point>> contours;
@@ -0,0 +1,155 @@
+#include "MinecraftAI.h"
+
+#ifdef _WIN32
+// ScreenCaptureContext Implementation
+ScreenCaptureContext::~ScreenCaptureContext() {
+    Release();
+}
+
+cv::Mat ScreenCaptureContext::Capture(int screenX, int screenY, int width, int height) {
+    if (width <= 0 || height <= 0) return cv::Mat();
+    
+    if (!screenDC) {
+        screenDC = GetDC(nullptr);
+        if (!screenDC) return cv::Mat();
+    }
+    
+    if (!memoryDC) {
+        memoryDC = CreateCompatibleDC(screenDC);
+        if (!memoryDC) return cv::Mat();
+    }
+    
+    // Only rebuild the DIB sections when the capture size changes
+    if (bufferSize.width != width || bufferSize.height != height) {
+        if (!EnsureBuffers(width, height)) return cv::Mat();
+    }
+    
+    DibBuffer& buffer = buffers[nextBuffer];
+    nextBuffer = (nextBuffer + 1) % BUFFER_COUNT;
+    
+    HGDIOBJ previous = SelectObject(memoryDC, buffer.bitmap);
+    if (!defaultBitmap) {
+        defaultBitmap = previous;
+    }
+    
+    if (!BitBlt(memoryDC, 0, 0, width, height, screenDC, screenX, screenY, SRCCOPY)) {
+        return cv::Mat();
+    }
+    
+    // Make sure GDI has finished writing before the pixels are read
+    GdiFlush();
+    
+    return buffer.view;
+}
+
+bool ScreenCaptureContext::CaptureRegions(int screenX, int screenY, const std::vector<cv::Rect>& regions, cv::Mat& target) {
+    if (target.empty() || target.type() != CV_8UC4) return false;
+    
+    if (!screenDC) {
+        screenDC = GetDC(nullptr);
+        if (!screenDC) return false;
+    }
+    
+    if (!memoryDC) {
+        memoryDC = CreateCompatibleDC(screenDC);
+        if (!memoryDC) return false;
+    }
+    
+    if (bufferSize.width != target.cols || bufferSize.height != target.rows) {
+        if (!EnsureBuffers(target.cols, target.rows)) return false;
+    }
+    
+    DibBuffer& buffer = buffers[nextBuffer];
+    nextBuffer = (nextBuffer + 1) % BUFFER_COUNT;
+    
+    HGDIOBJ previous = SelectObject(memoryDC, buffer.bitmap);
+    if (!defaultBitmap) {
+        defaultBitmap = previous;
+    }
+    
+    // BitBlt cost scales with the area, so only the requested rectangles are read
+    cv::Rect bounds(0, 0, target.cols, target.rows);
+    for (const auto& region : regions) {
+        cv::Rect rect = region & bounds;
+        if (rect.empty()) continue;
+        
+        if (!BitBlt(memoryDC, rect.x, rect.y, rect.width, rect.height,
+                    screenDC, screenX + rect.x, screenY + rect.y, SRCCOPY)) {
+            return false;
+        }
+    }
+    
+    GdiFlush();
+    
+    for (const auto& region : regions) {
+        cv::Rect rect = region & bounds;
+        if (!rect.empty()) {
+            buffer.view(rect).copyTo(target(rect));
+        }
+    }
+    
+    return true;
+}
+
+bool ScreenCaptureContext::EnsureBuffers(int width, int height) {
+    ReleaseBuffers();
+    
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Negative for top-down DIB
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;    // 32-bit rows are always DWORD aligned
+    bmi.bmiHeader.biCompression = BI_RGB;
+    
+    for (int i = 0; i < BUFFER_COUNT; i++) {
+        DibBuffer& buffer = buffers[i];
+        buffer.bitmap = CreateDIBSection(screenDC, &bmi, DIB_RGB_COLORS, &buffer.bits, nullptr, 0);
+        
+        if (!buffer.bitmap || !buffer.bits) {
+            ReleaseBuffers();
+            return false;
+        }
+        
+        // Wrap the DIB memory directly, GDI already stores pixels as BGRA
+        buffer.view = cv::Mat(height, width, CV_8UC4, buffer.bits, static_cast<size_t>(width) * 4);
+    }
+    
+    bufferSize = cv::Size(width, height);
+    nextBuffer = 0;
+    return true;
+}
+
+void ScreenCaptureContext::ReleaseBuffers() {
+    // Deselect our bitmaps before deleting them
+    if (memoryDC && defaultBitmap) {
+        SelectObject(memoryDC, defaultBitmap);
+        defaultBitmap = nullptr;
+    }
+    
+    for (auto& buffer : buffers) {
+        buffer.view.release();
+        if (buffer.bitmap) {
+            DeleteObject(buffer.bitmap);
+        }
+        buffer.bitmap = nullptr;
+        buffer.bits = nullptr;
+    }
+    
+    bufferSize = cv::Size();
+}
+
+void ScreenCaptureContext::Release() {
+    ReleaseBuffers();
+    
+    if (memoryDC) {
+        DeleteDC(memoryDC);
+        memoryDC = nullptr;
+    }
+    
+    if (screenDC) {
+        ReleaseDC(nullptr, screenDC);
+        screenDC = nullptr;
+    }
+}
+#endif
@@ -0,0 +1,638 @@
+#include "MinecraftAI.h"
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace SessionFormat;
+
+// MappedFile Implementation
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Create(const std::string& path, size_t fileSize) {
+    Close();
+    if (fileSize == 0) return false;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+    
+    ULARGE_INTEGER mappingSize;
+    mappingSize.QuadPart = fileSize;
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+                                       mappingSize.HighPart, mappingSize.LowPart, nullptr);
+    if (!mappingHandle) {
+        Close();
+        return false;
+    }
+    
+    data = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, fileSize));
+#else
+    fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) return false;
+    
+    if (ftruncate(fileDescriptor, static_cast<off_t>(fileSize)) != 0) {
+        Close();
+        return false;
+    }
+    
+    void* mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    data = mapping == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mapping);
+#endif
+    
+    if (!data) {
+        Close();
+        return false;
+    }
+    
+    size = fileSize;
+    writable = true;
+    return true;
+}
+
+bool MappedFile::OpenReadOnly(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+        Close();
+        return false;
+    }
+    
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        Close();
+        return false;
+    }
+    
+    data = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) return false;
+    
+    struct stat fileInfo;
+    if (fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0) {
+        Close();
+        return false;
+    }
+    
+    size = static_cast<size_t>(fileInfo.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    data = mapping == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mapping);
+    if (data) {
+        madvise(data, size, MADV_SEQUENTIAL); // Records are scanned front to back
+    }
+#endif
+    
+    if (!data) {
+        Close();
+        return false;
+    }
+    
+    writable = false;
+    return true;
+}
+
+void MappedFile::Close(size_t finalSize) {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        if (writable && finalSize > 0) {
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(finalSize);
+            SetFilePointerEx(fileHandle, end, nullptr, FILE_BEGIN);
+            SetEndOfFile(fileHandle);
+        }
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (data) {
+        munmap(data, size);
+    }
+    if (fileDescriptor >= 0) {
+        if (writable && finalSize > 0 && ftruncate(fileDescriptor, static_cast<off_t>(finalSize)) != 0) {
+            std::cerr << "Failed to truncate mapped file" << std::endl;
+        }
+        close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    
+    data = nullptr;
+    size = 0;
+    writable = false;
+}
+
+namespace {
+    inline size_t AlignRecord(size_t bytes) {
+        return (bytes + 7) & ~static_cast<size_t>(7);
+    }
+    
+    inline int64_t ToMicroseconds(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    }
+    
+    // Lossless QOI-style codec over the BGR channels (alpha carries no data in
+    // captures). Single pass, no entropy coding, a few ns per pixel; worst case
+    // is 4 bytes per pixel, static game views usually shrink several times.
+    const uint8_t QOI_OP_INDEX = 0x00;
+    const uint8_t QOI_OP_DIFF = 0x40;
+    const uint8_t QOI_OP_LUMA = 0x80;
+    const uint8_t QOI_OP_RUN = 0xC0;
+    const uint8_t QOI_OP_RGB = 0xFE;
+    const uint8_t QOI_MASK = 0xC0;
+    
+    inline int QoiHash(uint8_t b, uint8_t g, uint8_t r) {
+        return (r * 3 + g * 5 + b * 7) % 64;
+    }
+    
+    size_t MaxEncodedSize(const cv::Mat& image) {
+        return static_cast<size_t>(image.cols) * image.rows * 4;
+    }
+    
+    size_t EncodeQoi(const cv::Mat& image, uint8_t* out) {
+        uint8_t index[64][3] = {};
+        uint8_t pb = 0, pg = 0, pr = 0;
+        int run = 0;
+        size_t pos = 0;
+        const int channels = image.channels();
+        
+        for (int y = 0; y < image.rows; y++) {
+            const uint8_t* pixel = image.ptr<uint8_t>(y);
+            
+            for (int x = 0; x < image.cols; x++, pixel += channels) {
+                uint8_t b = pixel[0], g = pixel[1], r = pixel[2];
+                
+                if (b == pb && g == pg && r == pr) {
+                    if (++run == 62) {
+                        out[pos++] = static_cast<uint8_t>(QOI_OP_RUN | (run - 1));
+                        run = 0;
+                    }
+                    continue;
+                }
+                
+                if (run > 0) {
+                    out[pos++] = static_cast<uint8_t>(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                
+                int hash = QoiHash(b, g, r);
+                if (index[hash][0] == b && index[hash][1] == g && index[hash][2] == r) {
+                    out[pos++] = static_cast<uint8_t>(QOI_OP_INDEX | hash);
+                } else {
+                    index[hash][0] = b;
+                    index[hash][1] = g;
+                    index[hash][2] = r;
+                    
+                    int vr = static_cast<int8_t>(r - pr);
+                    int vg = static_cast<int8_t>(g - pg);
+                    int vb = static_cast<int8_t>(b - pb);
+                    int vgr = vr - vg;
+                    int vgb = vb - vg;
+                    
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                        out[pos++] = static_cast<uint8_t>(QOI_OP_DIFF | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+                    } else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                        out[pos++] = static_cast<uint8_t>(QOI_OP_LUMA | (vg + 32));
+                        out[pos++] = static_cast<uint8_t>(((vgr + 8) << 4) | (vgb + 8));
+                    } else {
+                        out[pos++] = QOI_OP_RGB;
+                        out[pos++] = r;
+                        out[pos++] = g;
+                        out[pos++] = b;
+                    }
+                }
+                
+                pb = b;
+                pg = g;
+                pr = r;
+            }
+        }
+        
+        if (run > 0) {
+            out[pos++] = static_cast<uint8_t>(QOI_OP_RUN | (run - 1));
+        }
+        
+        return pos;
+    }
+    
+    bool DecodeQoi(const uint8_t* in, size_t size, cv::Mat& image) {
+        uint8_t index[64][3] = {};
+        uint8_t b = 0, g = 0, r = 0;
+        int run = 0;
+        size_t pos = 0;
+        
+        for (int y = 0; y < image.rows; y++) {
+            uint8_t* pixel = image.ptr<uint8_t>(y);
+            
+            for (int x = 0; x < image.cols; x++, pixel += 3) {
+                if (run > 0) {
+                    run--;
+                } else {
+                    if (pos >= size) return false;
+                    uint8_t op = in[pos++];
+                    
+                    if (op == QOI_OP_RGB) {
+                        if (pos + 3 > size) return false;
+                        r = in[pos++];
+                        g = in[pos++];
+                        b = in[pos++];
+                    } else if ((op & QOI_MASK) == QOI_OP_INDEX) {
+                        b = index[op][0];
+                        g = index[op][1];
+                        r = index[op][2];
+                    } else if ((op & QOI_MASK) == QOI_OP_DIFF) {
+                        r = static_cast<uint8_t>(r + ((op >> 4) & 0x03) - 2);
+                        g = static_cast<uint8_t>(g + ((op >> 2) & 0x03) - 2);
+                        b = static_cast<uint8_t>(b + (op & 0x03) - 2);
+                    } else if ((op & QOI_MASK) == QOI_OP_LUMA) {
+                        if (pos >= size) return false;
+                        uint8_t second = in[pos++];
+                        int vg = (op & 0x3F) - 32;
+                        r = static_cast<uint8_t>(r + vg - 8 + ((second >> 4) & 0x0F));
+                        g = static_cast<uint8_t>(g + vg);
+                        b = static_cast<uint8_t>(b + vg - 8 + (second & 0x0F));
+                    } else {
+                        run = op & 0x3F; // This pixel repeats the previous one, run more follow
+                    }
+                    
+                    int hash = QoiHash(b, g, r);
+                    index[hash][0] = b;
+                    index[hash][1] = g;
+                    index[hash][2] = r;
+                }
+                
+                pixel[0] = b;
+                pixel[1] = g;
+                pixel[2] = r;
+            }
+        }
+        
+        return true;
+    }
+}
+
+// SessionRecorder Implementation
+SessionRecorder::SessionRecorder(const std::string& outputDirectory, bool compress, size_t chunkBytes)
+    : directory(outputDirectory), compressFrames(compress), chunkSize(chunkBytes) {}
+
+SessionRecorder::~SessionRecorder() {
+    Close();
+}
+
+bool SessionRecorder::Open() {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create recording directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    
+    sessionStartWallUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    sessionStartSteadyUs = ToMicroseconds(std::chrono::steady_clock::now());
+    chunkIndex = 0;
+    totalRecords = 0;
+    totalBytes = 0;
+    droppedRecords = 0;
+    failed = false;
+    stopping = false;
+    
+    if (!OpenChunk(chunkSize)) return false;
+    
+    writer = std::thread(&SessionRecorder::WriterLoop, this);
+    return true;
+}
+
+bool SessionRecorder::OpenChunk(size_t bytes) {
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "chunk_%05u.mcrec", chunkIndex);
+    std::string path = (std::filesystem::path(directory) / fileName).string();
+    
+    if (!chunk.Create(path, bytes)) {
+        std::cerr << "Failed to map recording chunk: " << path << std::endl;
+        return false;
+    }
+    
+    auto* header = reinterpret_cast<ChunkHeader*>(chunk.Data());
+    std::memset(header, 0, sizeof(ChunkHeader));
+    header->magic = CHUNK_MAGIC;
+    header->version = VERSION;
+    header->chunkIndex = chunkIndex;
+    header->sessionStartWallUs = sessionStartWallUs;
+    header->sessionStartSteadyUs = sessionStartSteadyUs;
+    header->usedBytes = sizeof(ChunkHeader);
+    
+    writeOffset = sizeof(ChunkHeader);
+    recordCount = 0;
+    return true;
+}
+
+void SessionRecorder::FinishChunk() {
+    if (!chunk.IsOpen()) return;
+    
+    // Drop the unused preallocated tail
+    chunk.Close(writeOffset);
+    chunkIndex++;
+}
+
+bool SessionRecorder::Record(MinecraftBot::StateHandle state, MinecraftBot::ActionType action, cv::Point2f target) {
+    if (failed) return false;
+    if (!state) return true;
+    
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (!writer.joinable() || stopping) return false;
+        
+        // Encoding must not hold up the caller; a slow disk costs frames instead
+        if (pending.size() >= MAX_PENDING) {
+            droppedRecords++;
+            return true;
+        }
+        pending.push_back({ std::move(state), action, target });
+    }
+    pendingReady.notify_one();
+    return true;
+}
+
+void SessionRecorder::WriterLoop() {
+    while (true) {
+        PendingRecord record;
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingReady.wait(lock, [this] { return !pending.empty() || stopping; });
+            if (pending.empty()) return;
+            
+            record = std::move(pending.front());
+            pending.pop_front();
+        }
+        
+        // After a failure the rest is discarded; Record reports it
+        if (!failed && !Write(*record.state, record.action, record.target)) {
+            failed = true;
+        }
+    }
+}
+
+bool SessionRecorder::Write(const MinecraftBot::GameState& state, MinecraftBot::ActionType action, cv::Point2f target) {
+    if (!chunk.IsOpen()) return false;
+    
+    const cv::Mat& image = state.screenshot;
+    bool hasFrame = !image.empty() && image.depth() == CV_8U &&
+                    (image.channels() == 3 || image.channels() == 4) &&
+                    image.cols <= 0xFFFF && image.rows <= 0xFFFF;
+    
+    uint8_t codec = compressFrames ? CODEC_QOI : CODEC_RAW;
+    size_t rowBytes = hasFrame ? static_cast<size_t>(image.cols) * image.channels() : 0;
+    size_t maxPayload = !hasFrame ? 0 : (codec == CODEC_QOI ? MaxEncodedSize(image) : rowBytes * image.rows);
+    size_t blockBytes = state.detectedBlocks.size() * sizeof(RecordBlock);
+    size_t maxRecord = AlignRecord(sizeof(RecordHeader) + blockBytes + maxPayload);
+    
+    // Roll over to a new chunk when the worst case no longer fits
+    if (writeOffset + maxRecord > chunk.Size()) {
+        FinishChunk();
+        if (!OpenChunk(std::max(chunkSize, maxRecord + sizeof(ChunkHeader)))) return false;
+    }
+    
+    uint8_t* base = chunk.Data() + writeOffset;
+    auto* header = reinterpret_cast<RecordHeader*>(base);
+    auto* blocks = reinterpret_cast<RecordBlock*>(base + sizeof(RecordHeader));
+    uint8_t* payload = base + sizeof(RecordHeader) + blockBytes;
+    
+    for (size_t i = 0; i < state.detectedBlocks.size(); i++) {
+        const cv::Rect& block = state.detectedBlocks[i];
+        blocks[i] = { block.x, block.y, block.width, block.height };
+    }
+    
+    // Frames are encoded straight into the mapping, no staging buffer
+    size_t payloadSize = 0;
+    if (hasFrame) {
+        if (codec == CODEC_QOI) {
+            payloadSize = EncodeQoi(image, payload);
+        } else {
+            for (int y = 0; y < image.rows; y++) {
+                std::memcpy(payload + y * rowBytes, image.ptr<uint8_t>(y), rowBytes);
+            }
+            payloadSize = rowBytes * image.rows;
+        }
+    }
+    
+    size_t recordSize = AlignRecord(sizeof(RecordHeader) + blockBytes + payloadSize);
+    
+    header->magic = RECORD_MAGIC;
+    header->recordSize = static_cast<uint32_t>(recordSize);
+    header->frameSequence = state.frameSequence;
+    header->captureTimeUs = ToMicroseconds(state.captureTime);
+    header->windowX = state.windowRect.x;
+    header->windowY = state.windowRect.y;
+    header->windowWidth = state.windowRect.width;
+    header->windowHeight = state.windowRect.height;
+    header->targetX = target.x;
+    header->targetY = target.y;
+    header->action = static_cast<uint8_t>(action);
+    header->codec = hasFrame ? codec : static_cast<uint8_t>(CODEC_RAW);
+    header->channels = static_cast<uint8_t>(hasFrame ? (codec == CODEC_QOI ? 3 : image.channels()) : 0);
+    header->reserved = 0;
+    header->width = static_cast<uint16_t>(hasFrame ? image.cols : 0);
+    header->height = static_cast<uint16_t>(hasFrame ? image.rows : 0);
+    header->blockCount = static_cast<uint32_t>(state.detectedBlocks.size());
+    header->payloadSize = static_cast<uint32_t>(payloadSize);
+    
+    writeOffset += recordSize;
+    recordCount++;
+    totalRecords++;
+    totalBytes += recordSize;
+    
+    // Keep the chunk header current so a crashed session stays readable
+    auto* chunkHeader = reinterpret_cast<ChunkHeader*>(chunk.Data());
+    chunkHeader->recordCount = recordCount;
+    chunkHeader->usedBytes = writeOffset;
+    
+    return true;
+}
+
+void SessionRecorder::Close() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingReady.notify_one();
+    if (writer.joinable()) writer.join();
+    
+    if (!chunk.IsOpen()) return;
+    
+    FinishChunk();
+    std::cout << "Recorded " << totalRecords << " frames (" << totalBytes / (1024 * 1024)
+             << " MiB) to " << directory;
+    if (droppedRecords > 0) std::cout << ", " << droppedRecords << " dropped while the writer was busy";
+    std::cout << std::endl;
+}
+
+// SessionReader Implementation
+bool SessionReader::Open(const std::string& directory) {
+    chunks.clear();
+    Rewind();
+    
+    std::vector<std::string> chunkPaths;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".mcrec") {
+            chunkPaths.push_back(entry.path().string());
+        }
+    }
+    std::sort(chunkPaths.begin(), chunkPaths.end());
+    
+    for (const auto& path : chunkPaths) {
+        auto file = std::make_unique<MappedFile>();
+        if (!file->OpenReadOnly(path) || file->Size() < sizeof(ChunkHeader)) {
+            std::cerr << "Skipping unreadable chunk: " << path << std::endl;
+            continue;
+        }
+        
+        auto* header = reinterpret_cast<const ChunkHeader*>(file->Data());
+        if (header->magic != CHUNK_MAGIC || header->version != VERSION) {
+            std::cerr << "Skipping chunk with unknown format: " << path << std::endl;
+            continue;
+        }
+        
+        chunks.push_back(std::move(file));
+    }
+    
+    return !chunks.empty();
+}
+
+void SessionReader::Rewind() {
+    currentChunk = 0;
+    currentOffset = sizeof(ChunkHeader);
+}
+
+const ChunkHeader* SessionReader::GetChunkHeader(size_t index) const {
+    if (index >= chunks.size()) return nullptr;
+    return reinterpret_cast<const ChunkHeader*>(chunks[index]->Data());
+}
+
+bool SessionReader::Next(Record& record) {
+    while (currentChunk < chunks.size()) {
+        const MappedFile& file = *chunks[currentChunk];
+        const ChunkHeader* chunkHeader = GetChunkHeader(currentChunk);
+        size_t usedBytes = std::min(static_cast<size_t>(chunkHeader->usedBytes), file.Size());
+        
+        if (currentOffset + sizeof(RecordHeader) <= usedBytes) {
+            const uint8_t* base = file.Data() + currentOffset;
+            auto* header = reinterpret_cast<const RecordHeader*>(base);
+            
+            if (header->magic == RECORD_MAGIC && header->recordSize >= sizeof(RecordHeader) &&
+                currentOffset + header->recordSize <= usedBytes) {
+                record.header = header;
+                record.blocks = reinterpret_cast<const RecordBlock*>(base + sizeof(RecordHeader));
+                record.payload = base + sizeof(RecordHeader) + header->blockCount * sizeof(RecordBlock);
+                currentOffset += header->recordSize;
+                return true;
+            }
+        }
+        
+        // End of chunk (or a torn record at the end of a crashed session)
+        currentChunk++;
+        currentOffset = sizeof(ChunkHeader);
+    }
+    
+    return false;
+}
+
+bool SessionReader::DecodeFrame(const Record& record, cv::Mat& frame) {
+    const RecordHeader* header = record.header;
+    if (!header || header->width == 0 || header->height == 0) return false;
+    
+    if (header->codec == CODEC_RAW) {
+        // Zero-copy view onto the read-only mapping; clone() before modifying it
+        frame = cv::Mat(header->height, header->width, CV_8UC(header->channels),
+                        const_cast<uint8_t*>(record.payload));
+        return true;
+    }
+    
+    if (header->codec == CODEC_QOI) {
+        frame.create(header->height, header->width, CV_8UC3);
+        return DecodeQoi(record.payload, header->payloadSize, frame);
+    }
+    
+    return false;
+}
+
+int InspectRecording(const std::string& directory) {
+    SessionReader reader;
+    if (!reader.Open(directory)) {
+        std::cerr << "No readable recording chunks in: " << directory << std::endl;
+        return 1;
+    }
+    
+    uint64_t records = 0;
+    uint64_t payloadBytes = 0;
+    uint64_t skippedFrames = 0;
+    int64_t firstCaptureUs = 0, lastCaptureUs = 0, largestGapUs = 0;
+    uint64_t lastSequence = 0;
+    std::unordered_map<int, uint64_t> actionCounts;
+    
+    auto scanStart = std::chrono::steady_clock::now();
+    
+    SessionReader::Record record;
+    while (reader.Next(record)) {
+        const RecordHeader& header = *record.header;
+        
+        if (records == 0) {
+            firstCaptureUs = header.captureTimeUs;
+        } else {
+            largestGapUs = std::max(largestGapUs, header.captureTimeUs - lastCaptureUs);
+            if (header.frameSequence > lastSequence + 1) {
+                skippedFrames += header.frameSequence - lastSequence - 1;
+            }
+        }
+        
+        lastCaptureUs = header.captureTimeUs;
+        lastSequence = header.frameSequence;
+        payloadBytes += header.payloadSize;
+        actionCounts[header.action]++;
+        records++;
+    }
+    
+    double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+    double spanSeconds = (lastCaptureUs - firstCaptureUs) / 1e6;
+    
+    static const char* actionNames[] = { "MINE_BLOCK", "MOVE_TO_POSITION", "LOOK_AROUND", "SWITCH_TOOL", "IDLE" };
+    
+    std::cout << "=== Recording " << directory << " ===" << std::endl;
+    std::cout << "Chunks: " << reader.GetChunkCount() << ", records: " << records
+             << ", payload: " << payloadBytes / (1024 * 1024) << " MiB" << std::endl;
+    std::cout << "Span: " << spanSeconds << " s, "
+             << (spanSeconds > 0 ? (records - 1) / spanSeconds : 0.0) << " processed frames/s" << std::endl;
+    std::cout << "Frames captured but not processed: " << skippedFrames
+             << ", largest gap between processed frames: " << largestGapUs / 1000.0 << " ms" << std::endl;
+    for (const auto& entry : actionCounts) {
+        const char* name = entry.first >= 0 && entry.first < 5 ? actionNames[entry.first] : "UNKNOWN";
+        std::cout << "  " << name << ": " << entry.second << std::endl;
+    }
+    std::cout << "Header scan took " << scanSeconds * 1000.0 << " ms" << std::endl;
+    
+    return 0;
+}
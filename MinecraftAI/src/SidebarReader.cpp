@@ -0,0 +1,215 @@
+#include "MinecraftAI.h"
+#include <climits>
+
+namespace {
+
+const int MIN_LINE_CHARACTERS = 2;
+const int ERROR_SHARE = 4;           // A line is read if at most 1/4 of its ink missed the glyphs
+const int MAX_GAP_LINES = 3;         // Lattice lines further apart than this are not one sidebar
+const int MAX_NUMBER_DIGITS = 9;
+
+// Areas the sidebar names (after a location symbol the font atlas lacks);
+// names that contain others come first
+const char* const AREAS[] = {
+    "Glacite Mineshafts", "Glacite Tunnels", "Great Glacite Lake", "Dwarven Base Camp",
+    "Dwarven Mines", "Crystal Hollows", "Royal Mines", "Cliffside Veins", "Lava Springs",
+    "Rampart's Quarry", "Upper Mines", "The Forge", "Forge Basin", "Far Reserve", "Divan's Gateway",
+    "Mines of Divan", "Goblin Holdout", "Jungle", "Mithril Deposits", "Precursor Remnants",
+    "Magma Fields", "Deep Caverns", "Gunpowder Mines", "Lapis Quarry", "Pigmen's Den", "Slimehill",
+    "Diamond Reserve", "Obsidian Sanctuary", "Gold Mine", "Coal Mine", "Dragon's Nest", "The End",
+    "Spider's Den", "Crimson Isle", "Private Island", "Hub"
+};
+
+// Digits of a number shown with thousands separators, -1 if there are none
+int ParseNumber(const std::string& text) {
+    std::string digits;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') digits += c;
+    }
+    if (digits.empty() || digits.size() > MAX_NUMBER_DIGITS) return -1;
+    return std::stoi(digits);
+}
+
+bool IsReadable(const FontOCR::Line& line) {
+    return static_cast<int>(line.characters.size()) >= MIN_LINE_CHARACTERS && line.errors * ERROR_SHARE <= line.pixels;
+}
+
+} // namespace
+
+// SidebarReader Implementation
+bool SidebarReader::Update(const cv::Mat& frame, int scale, Clock::time_point frameTime) {
+    if (!ocr.HasFont() || scale < 1 || frame.empty()) return false;
+    
+    if (frame.size() != frameSize || scale != guiScale) {
+        Reset();
+        frameSize = frame.size();
+        guiScale = scale;
+        
+        // Right third, without the top and bottom eighths; on the GUI grid
+        // so every slot rectangle starts on a GUI pixel
+        int left = frame.cols * 2 / 3 / scale * scale;
+        int top = frame.rows / 8 / scale * scale;
+        searchArea = cv::Rect(left, top, frame.cols - left, frame.rows * 7 / 8 - top);
+    }
+    if (slots.empty()) {
+        // Without a sidebar on screen a search finds nothing again, however
+        // much the world behind the search area moved
+        if (searched && frameTime - lastSearch < std::chrono::milliseconds(SEARCH_INTERVAL_MS)) return false;
+        return ReadAll(frame, frameTime);
+    }
+    
+    int changedSlots = 0;
+    for (auto& slot : slots) {
+        uint64_t hash = HashSlot(frame, slot);
+        slot.changed = hash != slot.hash;
+        slot.hash = hash;
+        if (slot.changed) changedSlots++;
+    }
+    if (changedSlots == 0) return false;
+    if (changedSlots * 2 > static_cast<int>(slots.size())) return ReadAll(frame, frameTime);
+    
+    bool textChanged = false;
+    for (size_t i = 0; i < slots.size(); i++) {
+        Slot& slot = slots[i];
+        if (!slot.changed) continue;
+        
+        linesRead++;
+        ocr.ReadLine(frame, cv::Point(lineArea.x, slot.y), lineArea.width, guiScale, line);
+        
+        // Ink in the margin, or glyphs cut off at the left edge, belong to a
+        // line wider than the area read
+        if (!line.characters.empty() && (line.bounds.x < lineArea.x + MARGIN * guiScale || !IsReadable(line))) {
+            return ReadAll(frame, frameTime);
+        }
+        
+        if (line.text != slot.text) {
+            slot.text = line.text;
+            lines[i] = line.text;
+            textChanged = true;
+        }
+    }
+    
+    if (textChanged) values = Parse(lines);
+    return textChanged;
+}
+
+void SidebarReader::Reset() {
+    frameSize = cv::Size();
+    guiScale = 0;
+    searchArea = cv::Rect();
+    lineArea = cv::Rect();
+    slots.clear();
+    lines.clear();
+    values = Values();
+    searched = false;
+}
+
+bool SidebarReader::ReadAll(const cv::Mat& frame, Clock::time_point frameTime) {
+    fullReads++;
+    searched = true;
+    lastSearch = frameTime;
+    std::vector<std::string> previous;
+    previous.swap(lines);
+    slots.clear();
+    
+    const std::vector<FontOCR::Line>& found = ocr.ReadLines(frame, searchArea, guiScale);
+    
+    // Sidebar lines lie on one lattice of LINE_HEIGHT GUI pixels; the phase
+    // most lines agree on is the sidebar's
+    int votes[FontOCR::LINE_HEIGHT] = {};
+    for (const auto& read : found) {
+        if (IsReadable(read)) votes[(read.bounds.y / guiScale) % FontOCR::LINE_HEIGHT]++;
+    }
+    int phase = static_cast<int>(std::max_element(votes, votes + FontOCR::LINE_HEIGHT) - votes);
+    
+    // Of the lines on it, the largest run without long gaps; other text in
+    // the right third is not part of it
+    const int pitch = FontOCR::LINE_HEIGHT * guiScale;
+    int first = -1;
+    int last = -1;
+    int bestCount = 0;
+    int runFirst = -1;
+    int runLast = -1;
+    int runCount = 0;
+    for (const auto& read : found) {
+        if (!IsReadable(read) || (read.bounds.y / guiScale) % FontOCR::LINE_HEIGHT != phase) continue;
+        
+        if (runCount > 0 && read.bounds.y - runLast > MAX_GAP_LINES * pitch) runCount = 0;
+        if (runCount == 0) runFirst = read.bounds.y;
+        runLast = read.bounds.y;
+        runCount++;
+        
+        if (runCount > bestCount) {
+            bestCount = runCount;
+            first = runFirst;
+            last = runLast;
+        }
+    }
+    
+    if (bestCount == 0) {
+        values = Values();
+        return !previous.empty();
+    }
+    
+    int left = INT_MAX;
+    for (const auto& read : found) {
+        if (IsReadable(read) && read.bounds.y >= first && read.bounds.y <= last) left = std::min(left, read.bounds.x);
+    }
+    // Minecraft fills the background from MARGIN left of the widest line to
+    // one GUI pixel short of the right edge; nothing of the world beside it
+    left = std::max(searchArea.x, (left / guiScale - MARGIN) * guiScale);
+    int right = std::max(left, (frameSize.width / guiScale - 1) * guiScale);
+    lineArea = cv::Rect(left, first, right - left, last - first + FontOCR::GLYPH_SIZE * guiScale);
+    
+    // A slot for every line position, blank lines included, since any of
+    // them may get text later
+    for (int y = first; y <= last; y += pitch) {
+        Slot slot;
+        slot.y = y;
+        slot.hash = HashSlot(frame, slot);
+        for (const auto& read : found) {
+            if (read.bounds.y == y && IsReadable(read)) slot.text = read.text;
+        }
+        lines.push_back(slot.text);
+        slots.push_back(std::move(slot));
+    }
+    
+    values = Parse(lines);
+    return lines != previous;
+}
+
+uint64_t SidebarReader::HashSlot(const cv::Mat& frame, const Slot& slot) {
+    // The ink only: the background is translucent and the world behind it
+    // changes with every turn of the camera
+    return ocr.HashLineInk(frame, cv::Point(lineArea.x, slot.y), lineArea.width, guiScale);
+}
+
+SidebarReader::Values SidebarReader::Parse(const std::vector<std::string>& lines) {
+    static const std::regex speedPattern(R"(Mining Speed:?\s*\+?([\d,]+))");
+    static const std::regex buffPattern(R"(\+([\d,]+)%\s*Mining Speed)");
+    static const std::regex activePattern(R"(\bactive\b)", std::regex::icase);
+    
+    Values parsed;
+    std::smatch match;
+    for (const auto& text : lines) {
+        if (parsed.area.empty()) {
+            for (const char* area : AREAS) {
+                if (text.find(area) != std::string::npos) {
+                    parsed.area = area;
+                    break;
+                }
+            }
+        }
+        
+        if (std::regex_search(text, match, buffPattern)) {
+            parsed.miningSpeedBuff += std::max(0, ParseNumber(match[1].str()));
+        } else if (std::regex_search(text, match, speedPattern)) {
+            parsed.miningSpeed = ParseNumber(match[1].str());
+        }
+        
+        if (text.find("Mining Speed Boost") != std::string::npos && std::regex_search(text, activePattern)) {
+            parsed.speedBoostActive = true;
+        }
+    }
+    return parsed;
+}
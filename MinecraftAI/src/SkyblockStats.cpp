@@ -24,6 +24,7 @@ void SkyblockStats::LoadStatsFromConfig(const std::string& configFile) {
         defaultConfig["strength"] = 0;
         defaultConfig["crit_chance"] = 5.0;
         defaultConfig["crit_damage"] = 50.0;
+        defaultConfig["mining_speed_boost"] = 200;
         
         // Add tool multipliers
         Json::Value tools;
@@ -77,6 +78,7 @@ void SkyblockStats::LoadStatsFromConfig(const std::string& configFile) {
     currentStats.strength = config.get("strength", 0).asInt();
     currentStats.critChance = config.get("crit_chance", 5.0).asDouble();
     currentStats.critDamage = config.get("crit_damage", 50.0).asDouble();
+    speedBoostPercent = config.get("mining_speed_boost", 200).asInt();
     
     // Load tool multipliers if available
     if (config.isMember("tools") && config["tools"].isObject()) {
@@ -94,7 +96,9 @@ void SkyblockStats::SetMiningSpeedMultiplier(double multiplier) {
 }
 
 double SkyblockStats::GetMiningSpeed(const std::string& tool, const std::string& block) {
-    double baseSpeed = currentStats.miningSpeed / 100.0;
+    ApplySidebar();
+    
+    double baseSpeed = currentStats.miningSpeed * (100 + currentStats.miningSpeedBuff) / 10000.0;
     double toolMultiplier = toolMultipliers.count(tool) ? toolMultipliers[tool] : 1.0;
     
     double blockMultiplier = 1.0;
@@ -104,14 +108,41 @@ double SkyblockStats::GetMiningSpeed(const std::string& tool, const std::string&
     else if (block == "end_stone") blockMultiplier = 3.0;
     else if (block == "netherrack") blockMultiplier = 0.4;
     else if (block == "bedrock") blockMultiplier = 1000.0; // Essentially unmining-able
+    else if (block.size() > 4 && block.compare(block.size() - 4, 4, "_ore") == 0) {
+        // Texture atlas names; deepslate ores are harder than the stone ones
+        blockMultiplier = block.compare(0, 10, "deepslate_") == 0 ? 4.5 : 3.0;
+    }
     
     return baseSpeed * toolMultiplier / blockMultiplier;
 }
 
+double SkyblockStats::GetToolMultiplier(const std::string& tool) const {
+    auto it = toolMultipliers.find(tool);
+    return it != toolMultipliers.end() ? it->second : 0.0;
+}
+
 double SkyblockStats::GetMovementSpeed() {
     return currentStats.walkingSpeed / 100.0;
 }
 
 void SkyblockStats::UpdateStats(const Stats& newStats) {
     currentStats = newStats;
+}
+
+void SkyblockStats::PublishSidebar(const SidebarReader::Values& values) {
+    sidebarValues.WriteSlot() = values;
+    sidebarValues.Publish();
+}
+
+void SkyblockStats::ApplySidebar() {
+    if (!sidebarValues.Update()) return;
+    
+    // The sidebar overrides what it shows; the configured mining speed stays
+    // until it shows one
+    const SidebarReader::Values& values = sidebarValues.ReadSlot();
+    Stats updated = currentStats;
+    if (values.miningSpeed > 0) updated.miningSpeed = values.miningSpeed;
+    updated.miningSpeedBuff = values.miningSpeedBuff + (values.speedBoostActive ? speedBoostPercent : 0);
+    updated.area = values.area;
+    UpdateStats(updated);
 }
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "MinecraftAI.h"
+#include <filesystem>
+
+namespace {
+
+const size_t COARSE_CANDIDATES = 8;  // Textures kept after the 4x4 level
+const size_t FINE_CANDIDATES = 3;    // Textures kept after the 8x8 level
+const int MAX_SHIFT = 2;             // Texels of the 16x16 level
+const float MIN_DEVIATION = 2.0f;    // RMS below which a face is flat and has no texture to match
+const float KEY_STEP = 0.5f;         // Cache key: ternary step of the 4x4 level, in RMS deviations
+const float SPOT_DEVIATION = 2.5f;   // Cache key: 16x16 texel deviation, in RMS deviations, of an ore spot
+const int KEY_BYTES = 4 * 4 * 3 + 4; // 4x4 level, spot count and spot color lean
+
+float Dot(const float* a, const float* b, int length) {
+    float sum = 0.0f;
+    for (int i = 0; i < length; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Zero mean and unit length over all channels together; lighting that
+// scales a face cancels out, its hue does not
+void Normalize(float* values, int length) {
+    float mean = 0.0f;
+    for (int i = 0; i < length; i++) mean += values[i];
+    mean /= length;
+    
+    float norm = 0.0f;
+    for (int i = 0; i < length; i++) {
+        values[i] -= mean;
+        norm += values[i] * values[i];
+    }
+    norm = std::sqrt(norm);
+    
+    float scale = norm >= MIN_DEVIATION * std::sqrt(static_cast<float>(length)) ? 1.0f / norm : 0.0f;
+    for (int i = 0; i < length; i++) values[i] *= scale;
+}
+
+int LevelLength(int level) {
+    int size = TextureClassifier::LevelSize(level);
+    return size * size * 3;
+}
+
+} // namespace
+
+// TextureClassifier Implementation
+bool TextureClassifier::LoadAtlas(const std::string& directory) {
+    std::error_code error;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (!entry.is_regular_file()) continue;
+        
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp") files.push_back(entry.path());
+    }
+    if (error || files.empty()) return false;
+    std::sort(files.begin(), files.end());
+    
+    std::vector<std::string> loadedNames;
+    std::vector<float> loaded[LEVELS];
+    float levels[LEVELS][FACE_VALUES];
+    cv::Mat resized;
+    
+    for (const auto& file : files) {
+        cv::Mat texture = cv::imread(file.string(), cv::IMREAD_COLOR);
+        if (texture.empty()) continue;
+        
+        // Animated textures are vertical strips of square frames
+        if (texture.rows > texture.cols) texture = texture(cv::Rect(0, 0, texture.cols, texture.cols));
+        cv::resize(texture, resized, cv::Size(FACE_SIZE, FACE_SIZE), 0, 0,
+                   texture.cols > FACE_SIZE ? cv::INTER_AREA : cv::INTER_NEAREST);
+        
+        Describe(resized, levels);
+        for (int level = 0; level < LEVELS; level++) {
+            loaded[level].insert(loaded[level].end(), levels[level], levels[level] + LevelLength(level));
+        }
+        loadedNames.push_back(file.stem().string());
+    }
+    
+    if (loadedNames.empty()) {
+        std::cerr << "No readable block textures in " << directory << std::endl;
+        return false;
+    }
+    
+    for (int level = 0; level < LEVELS; level++) {
+        descriptors[level].swap(loaded[level]);
+    }
+    names.swap(loadedNames);
+    cache.clear();
+    return true;
+}
+
+TextureClassifier::Match TextureClassifier::Classify(const cv::Mat& image, const cv::Rect& region, bool useCache) {
+    Match result;
+    
+    cv::Rect clipped = region & cv::Rect(0, 0, image.cols, image.rows);
+    if (!HasAtlas() || clipped.empty() || image.depth() != CV_8U || (image.channels() != 3 && image.channels() != 4)) {
+        return result;
+    }
+    
+    cv::resize(image(clipped), face, cv::Size(FACE_SIZE, FACE_SIZE), 0, 0, cv::INTER_AREA);
+    Describe(face, faceDescriptors);
+    
+    uint64_t key = CacheKey(faceDescriptors);
+    if (useCache) {
+        auto cached = cache.find(key);
+        if (cached != cache.end()) {
+            cacheHits++;
+            return cached->second;
+        }
+        cacheMisses++;
+    }
+    
+    // Coarse to fine: every texture at 4x4, the closest few at 8x8, the
+    // closest of those at 16x16 where ore spots are resolved
+    const int coarseLength = LevelLength(0);
+    ranked.clear();
+    for (size_t t = 0; t < names.size(); t++) {
+        ranked.push_back({ Dot(faceDescriptors[0], &descriptors[0][t * coarseLength], coarseLength), static_cast<int>(t) });
+    }
+    
+    auto byScore = [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; };
+    size_t keep = std::min(ranked.size(), COARSE_CANDIDATES);
+    std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(), byScore);
+    ranked.resize(keep);
+    
+    const int fineLength = LevelLength(1);
+    for (auto& entry : ranked) {
+        entry.first = Dot(faceDescriptors[1], &descriptors[1][static_cast<size_t>(entry.second) * fineLength], fineLength);
+    }
+    keep = std::min(ranked.size(), FINE_CANDIDATES);
+    std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(), byScore);
+    ranked.resize(keep);
+    
+    for (const auto& entry : ranked) {
+        float score = CorrelateShifted(faceDescriptors[LEVELS - 1], entry.second);
+        if (score > result.score) {
+            result.score = score;
+            result.texture = entry.second;
+        }
+    }
+    if (result.score < minScore) result.texture = UNKNOWN;
+    
+    if (useCache) {
+        if (cache.size() >= static_cast<size_t>(MAX_CACHE_ENTRIES)) cache.clear();
+        cache[key] = result;
+    }
+    return result;
+}
+
+void TextureClassifier::Describe(const cv::Mat& face, float (*levels)[FACE_VALUES]) {
+    const int channels = face.channels();
+    float* finest = levels[LEVELS - 1];
+    for (int y = 0; y < FACE_SIZE; y++) {
+        const uint8_t* row = face.ptr<uint8_t>(y);
+        for (int x = 0; x < FACE_SIZE; x++) {
+            for (int c = 0; c < 3; c++) {
+                finest[(y * FACE_SIZE + x) * 3 + c] = row[x * channels + c];
+            }
+        }
+    }
+    
+    // Each coarser level averages 2x2 texels of the next finer one
+    for (int level = LEVELS - 2; level >= 0; level--) {
+        const float* fine = levels[level + 1];
+        float* coarse = levels[level];
+        const int size = LevelSize(level);
+        const int fineRow = LevelSize(level + 1) * 3;
+        for (int y = 0; y < size; y++) {
+            const float* top = fine + 2 * y * fineRow;
+            const float* bottom = top + fineRow;
+            for (int x = 0; x < size; x++) {
+                for (int c = 0; c < 3; c++) {
+                    int i = 2 * x * 3 + c;
+                    coarse[(y * size + x) * 3 + c] = 0.25f * (top[i] + top[i + 3] + bottom[i] + bottom[i + 3]);
+                }
+            }
+        }
+    }
+    
+    for (int level = 0; level < LEVELS; level++) {
+        Normalize(levels[level], LevelLength(level));
+    }
+}
+
+uint64_t TextureClassifier::CacheKey(const float (*levels)[FACE_VALUES]) {
+    uint8_t key[KEY_BYTES];
+    
+    // The normalized 4x4 level as a ternary pattern; lighting is already
+    // divided out, and a box a pixel off moves no 4x4 cell across a step
+    const int coarseLength = LevelLength(0);
+    const float step = KEY_STEP / std::sqrt(static_cast<float>(coarseLength));
+    for (int i = 0; i < coarseLength; i++) {
+        float value = levels[0][i];
+        key[i] = value > step ? 2 : (value < -step ? 0 : 1);
+    }
+    
+    // Ore spots are averaged away at 4x4, so how many 16x16 texels stand out
+    // and which way their color leans keeps an ore apart from its stone
+    const float* finest = levels[LEVELS - 1];
+    const float spotLimit = SPOT_DEVIATION / std::sqrt(static_cast<float>(FACE_VALUES));
+    int spots = 0;
+    float lean[3] = {};
+    for (int t = 0; t < FACE_SIZE * FACE_SIZE; t++) {
+        const float* texel = finest + t * 3;
+        if (std::max({ std::fabs(texel[0]), std::fabs(texel[1]), std::fabs(texel[2]) }) <= spotLimit) continue;
+        spots++;
+        for (int c = 0; c < 3; c++) lean[c] += texel[c];
+    }
+    key[coarseLength] = static_cast<uint8_t>(spots == 0 ? 0 : (spots <= 4 ? 1 : (spots <= 16 ? 2 : 3)));
+    for (int c = 0; c < 3; c++) {
+        float mean = spots > 0 ? lean[c] / spots : 0.0f;
+        key[coarseLength + 1 + c] = mean > spotLimit ? 2 : (mean < -spotLimit ? 0 : 1);
+    }
+    
+    return TileChangeMap::HashImage(cv::Mat(1, KEY_BYTES, CV_8U, key));
+}
+
+float TextureClassifier::CorrelateShifted(const float* region, int texture) const {
+    const float* values = &descriptors[LEVELS - 1][static_cast<size_t>(texture) * FACE_VALUES];
+    const int rowLength = FACE_SIZE * 3;
+    
+    float best = -1.0f;
+    for (int dy = -MAX_SHIFT; dy <= MAX_SHIFT; dy++) {
+        for (int dx = -MAX_SHIFT; dx <= MAX_SHIFT; dx++) {
+            float sum = 0.0f;
+            for (int y = 0; y < FACE_SIZE; y++) {
+                const float* regionRow = region + y * rowLength;
+                const float* textureRow = values + ((y + dy + FACE_SIZE) % FACE_SIZE) * rowLength;
+                for (int x = 0; x < FACE_SIZE; x++) {
+                    const float* a = regionRow + x * 3;
+                    const float* b = textureRow + ((x + dx + FACE_SIZE) % FACE_SIZE) * 3;
+                    sum += a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+                }
+            }
+            best = std::max(best, sum);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,579 @@
+#include "MinecraftAI.h"
+#include <numeric>
+
+namespace {
+
+const int SPIN_ROUNDS = 32;              // Yields before an idle worker goes to sleep
+const int BATCH_SIZE = 256;              // Benchmark tasks submitted before waiting for them
+const size_t SUM_SIZE = size_t(1) << 22;
+const int SUM_REPEATS = 20;
+const int SUM_CHUNKS_PER_THREAD = 8;
+
+thread_local ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+// The pool ThreadPool replaced, kept as the benchmark baseline: one
+// std::function queue behind one mutex
+class QueueThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable condition;
+    bool stop = false;
+
+public:
+    explicit QueueThreadPool(size_t numThreads) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    std::function<void()> task;
+                    
+                    {
+                        std::unique_lock<std::mutex> lock(queueMutex);
+                        condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                        
+                        if (stop && tasks.empty()) return;
+                        
+                        task = std::move(tasks.front());
+                        tasks.pop();
+                    }
+                    
+                    task();
+                }
+            });
+        }
+    }
+    
+    ~QueueThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            stop = true;
+        }
+        
+        condition.notify_all();
+        
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    template<typename F>
+    auto enqueue(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using return_type = std::invoke_result_t<std::decay_t<F>&>;
+        
+        auto task = std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(f));
+        std::future<return_type> result = task->get_future();
+        
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            tasks.emplace([task]() { (*task)(); });
+        }
+        
+        condition.notify_one();
+        return result;
+    }
+};
+
+struct SubmitRun {
+    double seconds = 0.0;
+    std::vector<int64_t> latencies; // Nanoseconds per submission
+    uint64_t allocations = 0;
+    bool allocationsCounted = false;
+};
+
+// Submits taskCount tasks in batches of BATCH_SIZE and waits for each batch;
+// submit() queues one task, wait() returns once the batch has run
+template<typename Submit, typename Wait>
+SubmitRun MeasureSubmission(int taskCount, Submit&& submit, Wait&& wait) {
+    SubmitRun run;
+    run.latencies.reserve(taskCount);
+    run.allocationsCounted = AllocationCounter::IsAvailable();
+    if (run.allocationsCounted) AllocationCounter::Start();
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int done = 0; done < taskCount; done += BATCH_SIZE) {
+        int batch = std::min(BATCH_SIZE, taskCount - done);
+        for (int i = 0; i < batch; i++) {
+            auto before = std::chrono::steady_clock::now();
+            submit();
+            run.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - before).count());
+        }
+        wait();
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (run.allocationsCounted) run.allocations = AllocationCounter::Stop();
+    return run;
+}
+
+void PrintSubmitRun(const char* name, SubmitRun& run, int taskCount) {
+    std::sort(run.latencies.begin(), run.latencies.end());
+    double mean = std::accumulate(run.latencies.begin(), run.latencies.end(), 0.0) / run.latencies.size();
+    int64_t p50 = run.latencies[run.latencies.size() / 2];
+    int64_t p99 = run.latencies[run.latencies.size() * 99 / 100];
+    
+    std::cout << name << ": " << static_cast<int64_t>(taskCount / run.seconds) << " tasks/s, submit mean "
+             << static_cast<int64_t>(mean) << " ns, p50 " << p50 << " ns, p99 " << p99 << " ns";
+    if (run.allocationsCounted) {
+        std::cout << ", " << static_cast<double>(run.allocations) / taskCount << " allocations/task";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+// Fixed-capacity Chase-Lev deque. The owner pushes and pops at the bottom,
+// thieves take the top with a compare-and-swap. Tasks are not atomic, so each
+// slot carries a sequence number: index + 1 once its task is stored, and the
+// next index that may use it once the task has been moved out again.
+struct ThreadPool::WorkerQueue {
+    struct Slot {
+        std::atomic<int64_t> sequence{0};
+        PoolTask task;
+    };
+    
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    alignas(64) Slot slots[DEQUE_CAPACITY];
+    
+    WorkerQueue() {
+        for (int64_t i = 0; i < DEQUE_CAPACITY; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    // Owner only; false if full or a thief is still moving out the slot's task
+    bool Push(PoolTask& task) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= DEQUE_CAPACITY) return false;
+        
+        Slot& slot = slots[b & (DEQUE_CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != b) return false;
+        
+        slot.task = std::move(task);
+        slot.sequence.store(b + 1, std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Owner only
+    bool Pop(PoolTask& task) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        Slot& slot = slots[b & (DEQUE_CAPACITY - 1)];
+        int64_t release = b; // Bottom moved back, the owner pushes b again
+        if (t == b) {
+            // The last task, thieves may race for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won) return false;
+            release = b + DEQUE_CAPACITY;
+        }
+        
+        task = std::move(slot.task);
+        slot.sequence.store(release, std::memory_order_release);
+        return true;
+    }
+    
+    // Any thread
+    bool Steal(PoolTask& task) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        
+        // Index t is ours now; its task is stored, if not yet visible here
+        Slot& slot = slots[t & (DEQUE_CAPACITY - 1)];
+        while (slot.sequence.load(std::memory_order_acquire) != t + 1) {
+            std::this_thread::yield();
+        }
+        
+        task = std::move(slot.task);
+        slot.sequence.store(t + DEQUE_CAPACITY, std::memory_order_release);
+        return true;
+    }
+};
+
+// Bounded multi-producer/multi-consumer queue with the same slot sequence
+// numbers as WorkerQueue
+struct ThreadPool::InjectQueue {
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        PoolTask task;
+    };
+    
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+    alignas(64) Cell cells[INJECT_CAPACITY];
+    
+    InjectQueue() {
+        for (size_t i = 0; i < INJECT_CAPACITY; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    bool Push(PoolTask& task) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & (INJECT_CAPACITY - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            
+            if (difference < 0) return false;
+            if (difference > 0) {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            } else if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.task = std::move(task);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    
+    bool Pop(PoolTask& task) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & (INJECT_CAPACITY - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            
+            if (difference < 0) return false;
+            if (difference > 0) {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            } else if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                task = std::move(cell.task);
+                cell.sequence.store(position + INJECT_CAPACITY, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+};
+
+// PoolTask Implementation
+PoolTask::PoolTask(PoolTask&& other) noexcept : ops(other.ops) {
+    if (ops) ops->move(other.storage, storage);
+    other.ops = nullptr;
+}
+
+PoolTask& PoolTask::operator=(PoolTask&& other) noexcept {
+    if (this != &other) {
+        Reset();
+        ops = other.ops;
+        if (ops) ops->move(other.storage, storage);
+        other.ops = nullptr;
+    }
+    return *this;
+}
+
+void PoolTask::Reset() {
+    if (ops) ops->destroy(storage);
+    ops = nullptr;
+}
+
+// ThreadPool Implementation
+ThreadPool::ThreadPool(size_t numThreads) : injected(std::make_unique<InjectQueue>()) {
+    // All deques exist before the first worker starts stealing from them
+    for (size_t i = 0; i < numThreads; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop.store(true, std::memory_order_release);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+    
+    wake.notify_all();
+    
+    // Workers run every queued task before they exit
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(PoolTask task) {
+    if (stop.load(std::memory_order_acquire)) {
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    }
+    
+    if (workers.empty()) {
+        task();
+        return;
+    }
+    
+    bool queued = (currentPool == this && queues[currentWorker]->Push(task)) || injected->Push(task);
+    if (!queued) {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        overflow.push_back(std::move(task));
+        overflowSize.fetch_add(1, std::memory_order_release);
+    }
+    
+    Notify();
+}
+
+bool ThreadPool::RunPendingTask(bool ownQueueOnly) {
+    PoolTask task;
+    if (!TakeTask(task, ownQueueOnly)) return false;
+    
+    task();
+    return true;
+}
+
+bool ThreadPool::IsWorkerThread() const {
+    return currentPool == this;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    
+    PoolTask task;
+    int idleRounds = 0;
+    while (true) {
+        if (TakeTask(task, false)) {
+            task();
+            task.Reset();
+            idleRounds = 0;
+            continue;
+        }
+        
+        if (++idleRounds <= SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        // A submission after the epoch is read changes it, one before it is
+        // found by the second look
+        uint64_t seen = epoch.load(std::memory_order_seq_cst);
+        if (TakeTask(task, false)) {
+            task();
+            task.Reset();
+            idleRounds = 0;
+            continue;
+        }
+        if (stop.load(std::memory_order_acquire)) return;
+        
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [this, seen] {
+            return epoch.load(std::memory_order_seq_cst) != seen || stop.load(std::memory_order_acquire);
+        });
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+        idleRounds = 0;
+    }
+}
+
+bool ThreadPool::TakeTask(PoolTask& task, bool ownQueueOnly) {
+    bool isWorker = currentPool == this;
+    if (isWorker && queues[currentWorker]->Pop(task)) return true;
+    if (ownQueueOnly) return false;
+    
+    if (injected->Pop(task)) return true;
+    
+    if (overflowSize.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        if (!overflow.empty()) {
+            task = std::move(overflow.front());
+            overflow.pop_front();
+            overflowSize.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    
+    // Victims in turn from the next worker on, so thieves spread out
+    size_t start = isWorker ? currentWorker + 1 : 0;
+    for (size_t i = 0; i < queues.size(); i++) {
+        size_t victim = (start + i) % queues.size();
+        if (isWorker && victim == currentWorker) continue;
+        
+        if (queues[victim]->Steal(task)) {
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Notify() {
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+// TaskGroup Implementation
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::wait() {
+    // Such as a pipeline stage splitting its frame: the workers run the group
+    if (!pool.IsWorkerThread()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+    }
+    
+    while (pending.load(std::memory_order_acquire) > 0) {
+        // The group's tasks are on top of a worker's own deque
+        if (pool.RunPendingTask(true)) continue;
+        
+        int before = pending.load(std::memory_order_acquire);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (finished.wait_for(lock, WAIT_SLICE, [this] { return pending.load(std::memory_order_acquire) == 0; })) {
+                break;
+            }
+        }
+        
+        // No task finished for a whole slice: the group's tasks may be queued
+        // behind others, so help with whatever is queued
+        if (pending.load(std::memory_order_acquire) == before) pool.RunPendingTask();
+    }
+    
+    // The last task unlocks the mutex as the final step of Finish, so once it
+    // is ours again nothing touches the group any more
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error) {
+        std::exception_ptr taskError = error;
+        error = nullptr;
+        std::rethrow_exception(taskError);
+    }
+}
+
+void TaskGroup::Finish(std::exception_ptr taskError) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taskError && !error) error = taskError;
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) finished.notify_all();
+}
+
+int RunThreadPoolBenchmark(int taskCount) {
+    const size_t threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    std::atomic<int> executed{0};
+    auto work = [&executed] { executed.fetch_add(1, std::memory_order_relaxed); };
+    
+    std::cout << "=== ThreadPool (" << taskCount << " tasks in batches of " << BATCH_SIZE << ", "
+             << threads << " workers) ===" << std::endl;
+    bool passed = true;
+    
+    {
+        QueueThreadPool pool(threads);
+        std::vector<std::future<void>> futures;
+        futures.reserve(BATCH_SIZE);
+        
+        SubmitRun run = MeasureSubmission(taskCount, [&] { futures.push_back(pool.enqueue(work)); }, [&] {
+            for (auto& future : futures) future.get();
+            futures.clear();
+        });
+        PrintSubmitRun("single queue, enqueue + future", run, taskCount);
+    }
+    
+    {
+        ThreadPool pool(threads);
+        std::vector<std::future<void>> futures;
+        futures.reserve(BATCH_SIZE);
+        
+        SubmitRun run = MeasureSubmission(taskCount, [&] { futures.push_back(pool.enqueue(work)); }, [&] {
+            for (auto& future : futures) future.get();
+            futures.clear();
+        });
+        PrintSubmitRun("work stealing, enqueue + future", run, taskCount);
+        
+        TaskGroup group(pool);
+        run = MeasureSubmission(taskCount, [&] { group.run(work); }, [&] { group.wait(); });
+        PrintSubmitRun("work stealing, TaskGroup from outside", run, taskCount);
+        
+        // Submitted from a worker, the tasks go to its own deque and the
+        // other workers steal them
+        uint64_t steals = pool.GetStealCount();
+        pool.enqueue([&] {
+            TaskGroup inner(pool);
+            run = MeasureSubmission(taskCount, [&] { inner.run(work); }, [&] { inner.wait(); });
+        }).get();
+        PrintSubmitRun("work stealing, TaskGroup from a worker", run, taskCount);
+        std::cout << "  " << pool.GetStealCount() - steals << " tasks stolen" << std::endl;
+    }
+    
+    if (executed != taskCount * 4) {
+        std::cout << "FAILED: " << executed << " of " << taskCount * 4 << " tasks ran" << std::endl;
+        passed = false;
+    }
+    
+    // Fork-join: a sum in chunks, once with a future per chunk, once with parallel_for
+    std::vector<uint32_t> values(SUM_SIZE);
+    for (size_t i = 0; i < SUM_SIZE; i++) {
+        values[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    const uint64_t expected = std::accumulate(values.begin(), values.end(), uint64_t(0));
+    const size_t grain = SUM_SIZE / ((threads + 1) * SUM_CHUNKS_PER_THREAD);
+    auto sumRange = [&values](size_t first, size_t last) {
+        return std::accumulate(values.begin() + first, values.begin() + last, uint64_t(0));
+    };
+    
+    uint64_t futureSum = 0;
+    double futureSeconds = 0.0;
+    {
+        QueueThreadPool pool(threads);
+        std::vector<std::future<uint64_t>> futures;
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < SUM_REPEATS; repeat++) {
+            futures.clear();
+            for (size_t first = 0; first < SUM_SIZE; first += grain) {
+                size_t last = std::min(SUM_SIZE, first + grain);
+                futures.push_back(pool.enqueue([&sumRange, first, last] { return sumRange(first, last); }));
+            }
+            futureSum = 0;
+            for (auto& future : futures) futureSum += future.get();
+        }
+        futureSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    uint64_t parallelSum = 0;
+    double parallelSeconds = 0.0;
+    {
+        ThreadPool pool(threads);
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < SUM_REPEATS; repeat++) {
+            std::atomic<uint64_t> total{0};
+            pool.parallel_for(0, SUM_SIZE, grain, [&](size_t first, size_t last) {
+                total.fetch_add(sumRange(first, last), std::memory_order_relaxed);
+            });
+            parallelSum = total;
+        }
+        parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    std::cout << "chunked sum of " << SUM_SIZE << " values, " << (SUM_SIZE + grain - 1) / grain
+             << " chunks: futures " << futureSeconds * 1000.0 / SUM_REPEATS << " ms, parallel_for "
+             << parallelSeconds * 1000.0 / SUM_REPEATS << " ms" << std::endl;
+    if (futureSum != expected || parallelSum != expected) {
+        std::cout << "FAILED: sums differ (" << futureSum << ", " << parallelSum << ", expected " << expected
+                 << ")" << std::endl;
+        passed = false;
+    }
+    
+    return passed ? 0 : 1;
+}
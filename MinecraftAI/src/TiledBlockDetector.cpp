@@ -0,0 +1,187 @@
+#include "MinecraftAI.h"
+#include <limits>
+
+namespace {
+
+const int BENCH_THREADS[] = { 1, 2, 4, 8 };
+
+// Blocks reaching into the margin of a cut may be clipped contours; cuts are
+// the tile sides that are not sides of the roi
+bool NearSeam(const cv::Rect& block, const cv::Rect& area, const cv::Rect& roi) {
+    const int margin = TiledBlockDetector::SEAM_MARGIN;
+    return (area.x > roi.x && block.x < area.x + margin) ||
+           (area.y > roi.y && block.y < area.y + margin) ||
+           (area.br().x < roi.br().x && block.br().x > area.br().x - margin) ||
+           (area.br().y < roi.br().y && block.br().y > area.br().y - margin);
+}
+
+} // namespace
+
+const std::vector<cv::Rect>& TiledBlockDetector::Detect(const FrameContext& context, const cv::Rect& roi,
+                                                        cv::Point2f center, ThreadPool* pool, int maxTiles) {
+    // Converted before the tiles start, so no worker waits on another for it
+    const cv::Mat& gray = context.GetGray();
+    cv::Rect area = roi & cv::Rect(0, 0, gray.cols, gray.rows);
+    Layout(area, pool ? maxTiles : 1);
+    
+    if (tiles.size() == 1) {
+        return tiles[0].detector.Detect(context, area, center);
+    }
+    
+    // The calling thread takes tiles as well, so workers busy with other
+    // stages only slow the pass down instead of blocking it
+    pool->parallel_for(0, tiles.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            DetectTile(tiles[i], context, area, center);
+        }
+    });
+    
+    merged.clear();
+    for (const auto& tile : tiles) {
+        merged.insert(merged.end(), tile.owned.begin(), tile.owned.end());
+    }
+    
+    size_t count = std::min(merged.size(), static_cast<size_t>(ContourBlockDetector::MAX_BLOCKS));
+    std::partial_sort(merged.begin(), merged.begin() + count, merged.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    blocks.clear();
+    for (size_t i = 0; i < count; i++) {
+        blocks.push_back(merged[i].second);
+    }
+    return blocks;
+}
+
+void TiledBlockDetector::Layout(const cv::Rect& roi, int maxTiles) {
+    maxTiles = std::max(1, std::min(maxTiles, static_cast<int>(MAX_TILES)));
+    if (roi == layoutRoi && maxTiles == layoutTiles && !tiles.empty()) return;
+    layoutRoi = roi;
+    layoutTiles = maxTiles;
+    
+    // As many tiles as allowed while cores keep MIN_TILE_SIZE, then the grid
+    // with the squarest cores, which has the least overlap
+    int bestCols = 1;
+    int bestRows = 1;
+    double bestShape = std::numeric_limits<double>::max();
+    for (int cols = 1; cols <= maxTiles && roi.width / cols >= MIN_TILE_SIZE; cols++) {
+        for (int rows = 1; cols * rows <= maxTiles && roi.height / rows >= MIN_TILE_SIZE; rows++) {
+            double shape = std::fabs(std::log((static_cast<double>(roi.width) / cols) / (static_cast<double>(roi.height) / rows)));
+            int count = cols * rows;
+            int bestCount = bestCols * bestRows;
+            if (count > bestCount || (count == bestCount && shape < bestShape)) {
+                bestCols = cols;
+                bestRows = rows;
+                bestShape = shape;
+            }
+        }
+    }
+    
+    tiles.resize(bestCols * bestRows);
+    for (int row = 0; row < bestRows; row++) {
+        int top = roi.y + roi.height * row / bestRows;
+        int bottom = roi.y + roi.height * (row + 1) / bestRows;
+        for (int col = 0; col < bestCols; col++) {
+            int left = roi.x + roi.width * col / bestCols;
+            int right = roi.x + roi.width * (col + 1) / bestCols;
+            
+            Tile& tile = tiles[row * bestCols + col];
+            tile.core = cv::Rect(left, top, right - left, bottom - top);
+            tile.area = cv::Rect(left - OVERLAP, top - OVERLAP, right - left + 2 * OVERLAP,
+                                 bottom - top + 2 * OVERLAP) & roi;
+        }
+    }
+}
+
+void TiledBlockDetector::DetectTile(Tile& tile, const FrameContext& context, const cv::Rect& roi,
+                                    cv::Point2f center) {
+    tile.owned.clear();
+    
+    // Every block of the tile, the ten closest of the roi may all be in it
+    const auto& found = tile.detector.Detect(context, tile.area, center, std::numeric_limits<size_t>::max());
+    for (const auto& block : found) {
+        cv::Point blockCenter(block.x + block.width / 2, block.y + block.height / 2);
+        if (!tile.core.contains(blockCenter) || NearSeam(block, tile.area, roi)) continue;
+        
+        cv::Point2f delta(block.x + block.width / 2.0f - center.x, block.y + block.height / 2.0f - center.y);
+        tile.owned.push_back({ delta.dot(delta), block });
+    }
+}
+
+int RunTiledDetectionBenchmark(const std::string& path, int maxFrames) {
+    FileFrameSource source(path, 0.0);
+    if (!source.Open()) {
+        std::cerr << "Could not open frames from " << path << std::endl;
+        return 1;
+    }
+    
+    struct ThreadRun {
+        int threads;
+        std::unique_ptr<ThreadPool> pool; // Workers besides the calling thread
+        TiledBlockDetector detector;
+        LatencyHistogram time;
+        int tiles = 0;
+        int matching = 0;  // Frames with the same blocks as the untiled detector
+    };
+    
+    const int runCount = sizeof(BENCH_THREADS) / sizeof(BENCH_THREADS[0]);
+    std::vector<ThreadRun> runs(runCount);
+    for (int r = 0; r < runCount; r++) {
+        runs[r].threads = BENCH_THREADS[r];
+        if (runs[r].threads > 1) runs[r].pool = std::make_unique<ThreadPool>(runs[r].threads - 1);
+    }
+    
+    ContourBlockDetector single;
+    LatencyHistogram singleTime;
+    
+    cv::Mat frame;
+    cv::Size frameSize;
+    int frames = 0;
+    
+    while ((maxFrames <= 0 || frames < maxFrames) && source.Grab(frame)) {
+        if (frame.empty()) continue;
+        frames++;
+        frameSize = frame.size();
+        
+        // Same mining ROI and crosshair as OptimizedMinecraftBot
+        cv::Rect roi(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+        cv::Point2f crosshair(frame.cols / 2.0f, frame.rows / 2.0f);
+        
+        FrameContext context(frame, frames);
+        context.GetGray();
+        
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<cv::Rect>& expected = single.Detect(context, roi, crosshair);
+        singleTime.Record(std::chrono::steady_clock::now() - start);
+        
+        for (auto& run : runs) {
+            start = std::chrono::steady_clock::now();
+            const std::vector<cv::Rect>& blocks = run.detector.Detect(context, roi, crosshair, run.pool.get(),
+                                                                      run.threads);
+            run.time.Record(std::chrono::steady_clock::now() - start);
+            
+            run.tiles = run.detector.GetTileCount();
+            if (blocks == expected) run.matching++;
+        }
+    }
+    
+    if (frames == 0) {
+        std::cout << "No frames read from " << path << std::endl;
+        return 1;
+    }
+    
+    double baseline = singleTime.GetMean();
+    std::cout << "=== Tiled block detection (" << frames << " frames, "
+             << frameSize.width << "x" << frameSize.height << ", "
+             << std::thread::hardware_concurrency() << " hardware threads) ===" << std::endl;
+    std::cout << "untiled: " << baseline << " ms/frame (p95 " << singleTime.GetPercentile(95.0) << " ms)" << std::endl;
+    
+    for (const auto& run : runs) {
+        double mean = run.time.GetMean();
+        double speedup = mean > 0.0 ? baseline / mean : 0.0;
+        std::cout << run.threads << " thread(s), " << run.tiles << " tile(s): " << mean << " ms/frame (p95 "
+                 << run.time.GetPercentile(95.0) << " ms), speedup " << speedup << "x, efficiency "
+                 << 100.0 * speedup / run.threads << "%, same blocks in "
+                 << 100.0 * run.matching / frames << "% of frames" << std::endl;
+    }
+    return 0;
+}
@@ -286,6 +286,9 @@ Json::Value WebGUI::ConfigToJson(const AIConfig& config) {
     json["detectionRadius"] = config.detectionRadius;
     json["botUsername"] = config.botUsername;
     json["miningMode"] = config.miningMode;
+    json["blockDetector"] = config.blockDetector;
+    json["pipelineBackpressure"] = config.pipelineBackpressure;
+    json["tiledDetection"] = config.tiledDetection;
     json["autoSwitchTools"] = config.autoSwitchTools;
     json["avoidBedrock"] = config.avoidBedrock;
     json["chatResponses"] = config.chatResponses;
@@ -311,6 +314,9 @@ AIConfig WebGUI::JsonToConfig(const Json::Value& json) {
     if (json.isMember("detectionRadius")) config.detectionRadius = json["detectionRadius"].asInt();
     if (json.isMember("botUsername")) config.botUsername = json["botUsername"].asString();
     if (json.isMember("miningMode")) config.miningMode = json["miningMode"].asString();
+    if (json.isMember("blockDetector")) config.blockDetector = json["blockDetector"].asString();
+    if (json.isMember("pipelineBackpressure")) config.pipelineBackpressure = json["pipelineBackpressure"].asString();
+    if (json.isMember("tiledDetection")) config.tiledDetection = json["tiledDetection"].asBool();
     if (json.isMember("autoSwitchTools")) config.autoSwitchTools = json["autoSwitchTools"].asBool();
     if (json.isMember("avoidBedrock")) config.avoidBedrock = json["avoidBedrock"].asBool();
     if (json.isMember("chatResponses")) config.chatResponses = json["chatResponses"].asBool();
@@ -0,0 +1,422 @@
+#include "MinecraftAI.h"
+
+#ifdef MINECRAFTAI_HAVE_XSHM
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+struct X11ShmFrameSource::X11State {
+    Display* display = nullptr;
+    Window window = 0;
+    Visual* visual = nullptr;
+    int depth = 0;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    
+    XImage* image = nullptr;
+    XShmSegmentInfo shmInfo = {};
+    bool attached = false;
+};
+
+namespace {
+    // Xlib reports protocol errors asynchronously through a process-wide
+    // handler whose default exits the process, so capture calls run under this one
+    bool captureErrorOccurred = false;
+    
+    int HandleCaptureError(Display*, XErrorEvent*) {
+        captureErrorOccurred = true;
+        return 0;
+    }
+    
+    std::string GetWindowTitle(Display* display, Window window) {
+        // Prefer the UTF-8 EWMH title, fall back to WM_NAME
+        Atom netWmName = XInternAtom(display, "_NET_WM_NAME", True);
+        Atom utf8String = XInternAtom(display, "UTF8_STRING", True);
+        
+        if (netWmName != None && utf8String != None) {
+            Atom actualType;
+            int actualFormat;
+            unsigned long itemCount, bytesAfter;
+            unsigned char* data = nullptr;
+            
+            if (XGetWindowProperty(display, window, netWmName, 0, 1024, False, utf8String,
+                                   &actualType, &actualFormat, &itemCount, &bytesAfter, &data) == Success && data) {
+                std::string title(reinterpret_cast<char*>(data), itemCount);
+                XFree(data);
+                if (!title.empty()) return title;
+            }
+        }
+        
+        char* name = nullptr;
+        if (XFetchName(display, window, &name) && name) {
+            std::string title(name);
+            XFree(name);
+            return title;
+        }
+        
+        return "";
+    }
+    
+    Window FindWindowByTitle(Display* display, const std::vector<std::string>& titles) {
+        std::vector<Window> pending = { DefaultRootWindow(display) };
+        
+        while (!pending.empty()) {
+            Window current = pending.back();
+            pending.pop_back();
+            
+            std::string title = GetWindowTitle(display, current);
+            for (const auto& candidate : titles) {
+                // Prefix match so "Minecraft 1.8.9" and similar versioned titles are found
+                if (!title.empty() && title.compare(0, candidate.size(), candidate) == 0) {
+                    return current;
+                }
+            }
+            
+            Window root, parent;
+            Window* children = nullptr;
+            unsigned int childCount = 0;
+            if (XQueryTree(display, current, &root, &parent, &children, &childCount)) {
+                for (unsigned int i = 0; i < childCount; i++) {
+                    pending.push_back(children[i]);
+                }
+                if (children) XFree(children);
+            }
+        }
+        
+        return 0;
+    }
+}
+
+// X11ShmFrameSource Implementation
+X11ShmFrameSource::X11ShmFrameSource(const std::string& title, const std::string& display)
+    : x11(std::make_unique<X11State>()), windowTitle(title), displayName(display) {}
+
+X11ShmFrameSource::X11ShmFrameSource(unsigned long window, const std::string& display)
+    : x11(std::make_unique<X11State>()), windowId(window), displayName(display) {}
+
+X11ShmFrameSource::~X11ShmFrameSource() {
+    ReleaseImage();
+    if (x11->display) {
+        XCloseDisplay(x11->display);
+        x11->display = nullptr;
+    }
+}
+
+bool X11ShmFrameSource::Open() {
+    if (x11->display) return true;
+    
+    x11->display = XOpenDisplay(displayName.empty() ? nullptr : displayName.c_str());
+    if (!x11->display) {
+        std::cerr << "Failed to open X display" << std::endl;
+        return false;
+    }
+    
+    if (!XShmQueryExtension(x11->display)) {
+        std::cerr << "X server does not support MIT-SHM" << std::endl;
+        XCloseDisplay(x11->display);
+        x11->display = nullptr;
+        return false;
+    }
+    
+    if (windowId != 0) {
+        x11->window = static_cast<Window>(windowId);
+    } else if (!windowTitle.empty()) {
+        x11->window = FindWindowByTitle(x11->display, { windowTitle });
+    } else {
+        x11->window = FindWindowByTitle(x11->display, { "Minecraft", "Lunar Client", "Badlion Client" });
+    }
+    
+    XWindowAttributes attributes;
+    if (!x11->window || !XGetWindowAttributes(x11->display, x11->window, &attributes)) {
+        XCloseDisplay(x11->display);
+        x11->display = nullptr;
+        return false;
+    }
+    
+    // Pixels are wrapped as BGRA, which needs a 24/32-bit little-endian TrueColor visual
+    if ((attributes.depth != 24 && attributes.depth != 32) ||
+        attributes.visual->red_mask != 0xFF0000 || attributes.visual->blue_mask != 0x0000FF ||
+        ImageByteOrder(x11->display) != LSBFirst) {
+        std::cerr << "Unsupported X11 visual for capture (depth " << attributes.depth << ")" << std::endl;
+        XCloseDisplay(x11->display);
+        x11->display = nullptr;
+        return false;
+    }
+    
+    x11->visual = attributes.visual;
+    x11->depth = attributes.depth;
+    x11->x = attributes.x;
+    x11->y = attributes.y;
+    x11->width = attributes.width;
+    x11->height = attributes.height;
+    
+    // Size changes arrive as ConfigureNotify, so Grab() never needs an extra round trip
+    XSelectInput(x11->display, x11->window, StructureNotifyMask);
+    
+    return EnsureImage(x11->width, x11->height);
+}
+
+bool X11ShmFrameSource::EnsureImage(int width, int height) {
+    ReleaseImage();
+    if (width <= 0 || height <= 0) return false;
+    
+    XShmSegmentInfo& shm = x11->shmInfo;
+    x11->image = XShmCreateImage(x11->display, x11->visual, x11->depth, ZPixmap, nullptr, &shm, width, height);
+    if (!x11->image) return false;
+    
+    if (x11->image->bits_per_pixel != 32) {
+        ReleaseImage();
+        return false;
+    }
+    
+    shm.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(x11->image->bytes_per_line) * height, IPC_CREAT | 0600);
+    if (shm.shmid < 0) {
+        ReleaseImage();
+        return false;
+    }
+    
+    shm.shmaddr = static_cast<char*>(shmat(shm.shmid, nullptr, 0));
+    if (shm.shmaddr == reinterpret_cast<char*>(-1)) {
+        shm.shmaddr = nullptr;
+        shmctl(shm.shmid, IPC_RMID, nullptr);
+        shm.shmid = -1;
+        ReleaseImage();
+        return false;
+    }
+    
+    x11->image->data = shm.shmaddr;
+    shm.readOnly = False;
+    
+    captureErrorOccurred = false;
+    XErrorHandler previousHandler = XSetErrorHandler(HandleCaptureError);
+    Bool attached = XShmAttach(x11->display, &shm);
+    XSync(x11->display, False);
+    XSetErrorHandler(previousHandler);
+    
+    // Mark the segment for removal now; it is freed once both sides detach
+    shmctl(shm.shmid, IPC_RMID, nullptr);
+    
+    if (!attached || captureErrorOccurred) {
+        std::cerr << "XShmAttach failed (remote display?)" << std::endl;
+        ReleaseImage();
+        return false;
+    }
+    
+    x11->attached = true;
+    x11->width = width;
+    x11->height = height;
+    frameView = cv::Mat(height, width, CV_8UC4, x11->image->data, static_cast<size_t>(x11->image->bytes_per_line));
+    return true;
+}
+
+void X11ShmFrameSource::ReleaseImage() {
+    frameView.release();
+    
+    XShmSegmentInfo& shm = x11->shmInfo;
+    if (x11->attached) {
+        XShmDetach(x11->display, &shm);
+        XSync(x11->display, False);
+        x11->attached = false;
+    }
+    
+    if (x11->image) {
+        x11->image->data = nullptr; // Shared memory is released below, not by Xlib
+        XDestroyImage(x11->image);
+        x11->image = nullptr;
+    }
+    
+    if (shm.shmaddr) {
+        shmdt(shm.shmaddr);
+        shm.shmaddr = nullptr;
+    }
+    shm.shmid = -1;
+}
+
+void X11ShmFrameSource::ProcessEvents() {
+    // Drain pending resizes; the shared image is only rebuilt when the size changed
+    XEvent event;
+    while (XCheckTypedWindowEvent(x11->display, x11->window, ConfigureNotify, &event)) {
+        x11->x = event.xconfigure.x;
+        x11->y = event.xconfigure.y;
+        x11->width = event.xconfigure.width;
+        x11->height = event.xconfigure.height;
+    }
+}
+
+bool X11ShmFrameSource::Grab(cv::Mat& frame) {
+    if (!x11->display || !x11->window) return false;
+    
+    ProcessEvents();
+    
+    if (!x11->image || x11->image->width != x11->width || x11->image->height != x11->height) {
+        if (!EnsureImage(x11->width, x11->height)) return false;
+    }
+    
+    // A window that is partly off-screen or unmapped yields BadMatch instead of pixels
+    captureErrorOccurred = false;
+    XErrorHandler previousHandler = XSetErrorHandler(HandleCaptureError);
+    Bool grabbed = XShmGetImage(x11->display, x11->window, x11->image, 0, 0, AllPlanes);
+    XSetErrorHandler(previousHandler);
+    
+    if (!grabbed || captureErrorOccurred) return false;
+    
+    frame = frameView;
+    lastCaptureRect = cv::Rect(x11->x, x11->y, x11->width, x11->height); // Relative to the parent window
+    return true;
+}
+
+bool X11ShmFrameSource::GrabRegions(const std::vector<cv::Rect>& regions, cv::Mat& frame, bool& fullRefresh) {
+    if (!x11->display || !x11->window) return false;
+    
+    ProcessEvents();
+    
+    fullRefresh = frame.cols != x11->width || frame.rows != x11->height || frame.type() != CV_8UC4;
+    if (fullRefresh) {
+        cv::Mat grabbed;
+        if (!Grab(grabbed)) return false;
+        
+        grabbed.copyTo(frame);
+        return true;
+    }
+    
+    if (!x11->image || x11->image->width != x11->width || x11->image->height != x11->height) {
+        if (!EnsureImage(x11->width, x11->height)) return false;
+    }
+    
+    cv::Rect bounds(0, 0, frame.cols, frame.rows);
+    bool grabbed = true;
+    
+    captureErrorOccurred = false;
+    XErrorHandler previousHandler = XSetErrorHandler(HandleCaptureError);
+    
+    for (const auto& region : regions) {
+        cv::Rect rect = region & bounds;
+        if (rect.empty()) continue;
+        
+        // Sub-image header over the start of the shared segment; the server
+        // writes just this rectangle there, packed at the sub-image's stride
+        XImage* subImage = XShmCreateImage(x11->display, x11->visual, x11->depth, ZPixmap, nullptr,
+                                           &x11->shmInfo, rect.width, rect.height);
+        if (!subImage) {
+            grabbed = false;
+            break;
+        }
+        
+        subImage->data = x11->shmInfo.shmaddr;
+        bool regionGrabbed = XShmGetImage(x11->display, x11->window, subImage, rect.x, rect.y, AllPlanes) &&
+                             !captureErrorOccurred;
+        
+        if (regionGrabbed) {
+            cv::Mat view(rect.height, rect.width, CV_8UC4, subImage->data, static_cast<size_t>(subImage->bytes_per_line));
+            view.copyTo(frame(rect));
+        }
+        
+        subImage->data = nullptr;
+        XDestroyImage(subImage);
+        
+        if (!regionGrabbed) {
+            grabbed = false;
+            break;
+        }
+    }
+    
+    XSetErrorHandler(previousHandler);
+    
+    lastCaptureRect = cv::Rect(x11->x, x11->y, x11->width, x11->height);
+    return grabbed;
+}
+
+int RunX11CaptureBenchmark(int frameCount) {
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        std::cerr << "No X display available, start Xvfb (e.g. Xvfb :99 -screen 0 2560x1440x24) and set DISPLAY" << std::endl;
+        return 1;
+    }
+    
+    int screen = DefaultScreen(display);
+    const cv::Size resolutions[] = { cv::Size(1920, 1080), cv::Size(2560, 1440) };
+    const unsigned long barColors[] = {
+        0xFFFFFF, 0xFFFF00, 0x00FFFF, 0x00FF00, 0xFF00FF, 0xFF0000, 0x0000FF, 0x202020
+    };
+    const int barCount = 8;
+    int failures = 0;
+    
+    std::cout << "=== X11 MIT-SHM capture benchmark (" << frameCount << " frames) ===" << std::endl;
+    
+    for (const auto& size : resolutions) {
+        if (DisplayWidth(display, screen) < size.width || DisplayHeight(display, screen) < size.height) {
+            std::cout << size.width << "x" << size.height << ": skipped, screen is only "
+                     << DisplayWidth(display, screen) << "x" << DisplayHeight(display, screen) << std::endl;
+            failures++;
+            continue;
+        }
+        
+        // Synthetic client window: undecorated, fully on screen, vertical color bars
+        XSetWindowAttributes windowAttributes = {};
+        windowAttributes.override_redirect = True;
+        windowAttributes.background_pixel = BlackPixel(display, screen);
+        windowAttributes.event_mask = StructureNotifyMask;
+        Window window = XCreateWindow(display, RootWindow(display, screen), 0, 0, size.width, size.height, 0,
+                                      CopyFromParent, InputOutput, CopyFromParent,
+                                      CWOverrideRedirect | CWBackPixel | CWEventMask, &windowAttributes);
+        XMapRaised(display, window);
+        
+        XEvent event;
+        do {
+            XWindowEvent(display, window, StructureNotifyMask, &event);
+        } while (event.type != MapNotify);
+        
+        GC gc = XCreateGC(display, window, 0, nullptr);
+        int barWidth = size.width / barCount;
+        for (int i = 0; i < barCount; i++) {
+            XSetForeground(display, gc, barColors[i]);
+            XFillRectangle(display, window, gc, i * barWidth, 0, barWidth, size.height);
+        }
+        XSync(display, False);
+        
+        X11ShmFrameSource source(static_cast<unsigned long>(window));
+        cv::Mat frame;
+        bool ok = source.Open() && source.Grab(frame) &&
+                  frame.cols == size.width && frame.rows == size.height;
+        
+        // Verify the bar colors landed in the Mat as BGRA
+        for (int i = 0; ok && i < barCount; i++) {
+            const cv::Vec4b& pixel = frame.at<cv::Vec4b>(size.height / 2, i * barWidth + barWidth / 2);
+            ok = pixel[0] == (barColors[i] & 0xFF) &&
+                 pixel[1] == ((barColors[i] >> 8) & 0xFF) &&
+                 pixel[2] == ((barColors[i] >> 16) & 0xFF);
+        }
+        
+        if (!ok) {
+            std::cout << size.width << "x" << size.height << ": FAILED, captured pixels do not match" << std::endl;
+            failures++;
+        } else {
+            const uchar* bufferBefore = frame.data;
+            auto start = std::chrono::steady_clock::now();
+            int grabbed = 0;
+            for (int i = 0; i < frameCount; i++) {
+                if (source.Grab(frame)) grabbed++;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::cout << size.width << "x" << size.height << ": "
+                     << (seconds > 0 ? grabbed / seconds : 0.0) << " frames/s, "
+                     << (grabbed > 0 ? seconds * 1e6 / grabbed : 0.0) << " us/frame"
+                     << (frame.data == bufferBefore ? " (buffer reused)" : " (buffer reallocated)") << std::endl;
+            
+            if (grabbed != frameCount) failures++;
+        }
+        
+        XFreeGC(display, gc);
+        XDestroyWindow(display, window);
+        XSync(display, False);
+    }
+    
+    XCloseDisplay(display);
+    return failures == 0 ? 0 : 1;
+}
+#endif
@@ -3,14 +3,48 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <cstdlib>
 
 void PrintUsage() {
     std::cout << "Minecraft AI Bot v2.0 - Usage:\n";
     std::cout << "  minecraft_ai.exe --run                 : Start the AI bot\n";
     std::cout << "  minecraft_ai.exe --gui                 : Start with GUI\n";
     std::cout << "  minecraft_ai.exe --train <video_dir>   : Train from videos\n";
+    std::cout << "  minecraft_ai.exe --replay <path> [fps] : Run headless on PNG frames or a video\n";
+    std::cout << "  minecraft_ai.exe --bench-capture [n]   : Benchmark X11 capture (Linux/Xvfb)\n";
+    std::cout << "  minecraft_ai.exe --inspect-recording <dir> : Summarize a recorded session\n";
+    std::cout << "  minecraft_ai.exe --bench-detect <path> [n] : Compare block detectors on frames\n";
+    std::cout << "  minecraft_ai.exe --bench-tiled <path> [n]  : Time tiled block detection with 1-8 threads\n";
+    std::cout << "  minecraft_ai.exe --bench-pool [n]      : Compare thread pools on n tiny tasks, stress the stage queues\n";
+    std::cout << "  minecraft_ai.exe --check-detect-alloc <path> [n] : Check block detection allocates nothing and matches OpenCV\n";
+    std::cout << "  minecraft_ai.exe --bench-ocr <ascii.png> [n] : Check and time font OCR on rendered lines\n";
+    std::cout << "  minecraft_ai.exe --build-block-lut <dir>   : Build block_colors.lut from <dir>/<block>/ samples\n";
     std::cout << "  minecraft_ai.exe --config              : Configure settings\n";
     std::cout << "  minecraft_ai.exe --help                : Show this help\n";
+    std::cout << "Options for --run and --replay:\n";
+    std::cout << "  --record <dir>                         : Record frames and decisions to <dir>\n";
+    std::cout << "  --record-raw                           : Store recorded frames uncompressed\n";
+}
+
+// Returns the index of an option after the command, or -1
+int FindOption(int argc, char* argv[], const std::string& option) {
+    for (int i = 2; i < argc; i++) {
+        if (option == argv[i]) return i;
+    }
+    return -1;
+}
+
+bool StartRecordingIfRequested(MinecraftAI& ai, int argc, char* argv[]) {
+    int recordIndex = FindOption(argc, argv, "--record");
+    if (recordIndex < 0) return true;
+    
+    if (recordIndex + 1 >= argc) {
+        std::cout << "Please specify an output directory for --record\n";
+        return false;
+    }
+    
+    bool compress = FindOption(argc, argv, "--record-raw") < 0;
+    return ai.StartRecording(argv[recordIndex + 1], compress);
 }
 
 std::vector<std::string> GetVideoFiles(const std::string& directory) {
@@ -77,9 +111,107 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    if (command == "--bench-capture") {
+#ifdef MINECRAFTAI_HAVE_XSHM
+        int frames = argc >= 3 ? std::atoi(argv[2]) : 500;
+        return RunX11CaptureBenchmark(frames > 0 ? frames : 500);
+#else
+        std::cout << "Capture benchmark requires a Linux build with MIT-SHM support\n";
+        return 1;
+#endif
+    }
+    
+    if (command == "--inspect-recording") {
+        if (argc < 3) {
+            std::cout << "Please specify a recording directory\n";
+            return 1;
+        }
+        return InspectRecording(argv[2]);
+    }
+    
+    if (command == "--bench-detect") {
+        if (argc < 3) {
+            std::cout << "Please specify a frame directory or video file\n";
+            return 1;
+        }
+        int frames = argc >= 4 ? std::atoi(argv[3]) : 0;
+        return RunDetectorBenchmark(argv[2], frames);
+    }
+    
+    if (command == "--bench-tiled") {
+        if (argc < 3) {
+            std::cout << "Please specify a frame directory or video file\n";
+            return 1;
+        }
+        int frames = argc >= 4 ? std::atoi(argv[3]) : 0;
+        return RunTiledDetectionBenchmark(argv[2], frames);
+    }
+    
+    if (command == "--bench-pool") {
+        int tasks = argc >= 3 ? std::atoi(argv[2]) : 0;
+        int poolResult = RunThreadPoolBenchmark(tasks > 0 ? tasks : 100000);
+        int queueResult = RunHandoffQueueStress(tasks > 0 ? tasks : 100000);
+        return poolResult != 0 ? poolResult : queueResult;
+    }
+    
+    if (command == "--check-detect-alloc") {
+        if (argc < 3) {
+            std::cout << "Please specify a frame directory or video file\n";
+            return 1;
+        }
+        int frames = argc >= 4 ? std::atoi(argv[3]) : 0;
+        return RunDetectorAllocationCheck(argv[2], frames);
+    }
+    
+    if (command == "--bench-ocr") {
+        if (argc < 3) {
+            std::cout << "Please specify a font atlas (textures/font/ascii.png)\n";
+            return 1;
+        }
+        int lines = argc >= 4 ? std::atoi(argv[3]) : 0;
+        return RunFontOCRBenchmark(argv[2], lines > 0 ? lines : 2000);
+    }
+    
+    if (command == "--build-block-lut") {
+        if (argc < 3) {
+            std::cout << "Please specify a directory with one sample folder per block type\n";
+            return 1;
+        }
+        return BuildBlockColorTable(argv[2], argc >= 4 ? argv[3] : "block_colors.lut");
+    }
+    
     // Initialize AI system
     MinecraftAI ai;
     
+    if (command == "--replay") {
+        if (argc < 3) {
+            std::cout << "Please specify a frame directory or video file to replay\n";
+            return 1;
+        }
+        
+        double fps = argc >= 4 && argv[3][0] != '-' ? std::atof(argv[3]) : 10.0;
+        auto source = std::make_unique<FileFrameSource>(argv[2], fps);
+        
+        if (!ai.Initialize(std::move(source))) {
+            std::cout << "Failed to initialize AI system from replay source!\n";
+            return 1;
+        }
+        
+        if (!StartRecordingIfRequested(ai, argc, argv)) {
+            return 1;
+        }
+        
+        std::cout << "Replaying " << argv[2] << " at " << (fps > 0 ? std::to_string(fps) : "max") << " FPS...\n";
+        ai.Start();
+        
+        while (ai.IsRunning()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        
+        ai.Stop();
+        return 0;
+    }
+    
     if (!ai.Initialize()) {
         std::cout << "Failed to initialize AI system!\n";
         std::cout << "Make sure Minecraft is running and try again.\n";
@@ -119,6 +251,10 @@ int main(int argc, char* argv[]) {
     if (command == "--run") {
         std::cout << "Starting Minecraft AI Bot...\n";
         
+        if (!StartRecordingIfRequested(ai, argc, argv)) {
+            return 1;
+        }
+        
         ai.Start();
         
         std::cout << "Bot is running! Press Enter to stop...\n";